@@ -7,19 +7,47 @@
 #define HWM_ARITHMETIC_HPP
 
 //! hwm.Arithmetic
-//! abs, sign, modulus, division
+//! abs, sign, modulus, division, saturating and overflow checked operations
 //! @file
 
 #include <cmath>
+#include <limits>
 #include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/integer_traits.hpp>
+#include <boost/integer/static_log2.hpp>
 #include <boost/mpl/and.hpp>
 #include <boost/static_assert.hpp>
 #include <boost/type_traits/is_floating_point.hpp>
 #include <boost/type_traits/is_integral.hpp>
 #include <boost/type_traits/is_signed.hpp>
 #include <boost/type_traits/is_unsigned.hpp>
+#include <boost/type_traits/make_unsigned.hpp>
 #include <boost/utility/enable_if.hpp>
 
+#if defined(_MSC_VER) && (_MSC_VER >= 1920) && defined(_M_X64)
+    #include <intrin.h>
+#endif
+
+//default
+//detect overflow by the compiler builtins (__builtin_add_overflow etc.) if they are available.
+
+//definition
+//HWM_ARITHMETIC_OVERFLOW_BUILTINS_DISABLED     //<= never use the builtins. always use the portable code.
+
+#if !defined HWM_ARITHMETIC_OVERFLOW_BUILTINS_DISABLED
+    #if defined(__clang__)
+        #if defined(__has_builtin)
+            #if __has_builtin(__builtin_add_overflow)
+                #define HWM_ARITHMETIC_OVERFLOW_BUILTINS
+            #endif
+        #endif
+    #elif defined(__GNUC__) && (__GNUC__ >= 5)
+        #define HWM_ARITHMETIC_OVERFLOW_BUILTINS
+    #endif
+#endif
+
 namespace hwm { namespace arithmetic {
 
     //! @cond DETAIL
@@ -34,7 +62,8 @@ namespace hwm { namespace arithmetic {
                     boost::is_integral<T>
                 > >::type* = 0 )
         {
-            return ::abs(t);
+            //::abs takes only int. it would truncate long long.
+            return (t < 0) ? static_cast<T>(-t) : t;
         }
 
         template<typename T>
@@ -102,6 +131,316 @@ namespace hwm { namespace arithmetic {
     template<typename T>
     T       abs                     (T const &t) { return detail::abs_switch(t); }
 
+    //! @cond DETAIL
+    namespace detail
+    {
+        //  C++03 leaves the rounding direction of the builtin division of negative operands to the implementation.
+        //  every supported compiler truncates it, as C99 and C++11 require.
+        BOOST_STATIC_ASSERT(-13 / 4 == -3 && -13 % 4 == -1);
+        //  right shift of negative value must be arithmetic.
+        BOOST_STATIC_ASSERT((-13 >> 1) == -7);
+
+        //  integral division without branches and without floating point.
+        //  the builtin operators give the truncated quotient and modulus (a compiler emits one division for both),
+        //  and the floored and Euclidean results are derived from them with sign masks.
+        template<typename T, bool IsSigned = boost::is_signed<T>::value>
+        struct integral_division
+        {
+            BOOST_STATIC_ASSERT(boost::is_integral<T>::value);
+
+            //floored and Euclidean division are equal to truncated division for unsigned value.
+            static T    mod_truncated   (T const x, T const y) { return static_cast<T>(x % y); }
+            static T    div_truncated   (T const x, T const y) { return static_cast<T>(x / y); }
+            static T    mod_floored     (T const x, T const y) { return static_cast<T>(x % y); }
+            static T    div_floored     (T const x, T const y) { return static_cast<T>(x / y); }
+            static T    mod_euclidean   (T const x, T const y) { return static_cast<T>(x % y); }
+            static T    div_euclidean   (T const x, T const y) { return static_cast<T>(x / y); }
+        };
+
+        template<typename T>
+        struct integral_division<T, true>
+        {
+            BOOST_STATIC_ASSERT(boost::is_integral<T>::value);
+
+            //  additions are done in unsigned type to make wrapping around well-defined.
+            typedef typename boost::make_unsigned<T>::type  unsigned_type;
+
+            //! @return -1 if `t' is negative, otherwise 0.
+            static T    sign_mask       (T const t)
+            {
+                return static_cast<T>(t >> std::numeric_limits<T>::digits);
+            }
+
+            //! @return -1 if the modulus `r' is not zero and its sign differs from the divisor `y', otherwise 0.
+            static T    floored_mask    (T const r, T const y)
+            {
+                return static_cast<T>(sign_mask(static_cast<T>(r ^ y)) & -static_cast<T>(r != 0));
+            }
+
+            static T    add             (T const x, T const y)
+            {
+                return static_cast<T>(static_cast<unsigned_type>(static_cast<unsigned_type>(x) + static_cast<unsigned_type>(y)));
+            }
+
+            static T    abs             (T const t)
+            {
+                unsigned_type const mask = static_cast<unsigned_type>(sign_mask(t));
+                return static_cast<T>(static_cast<unsigned_type>((static_cast<unsigned_type>(t) ^ mask) - mask));
+            }
+
+            //! @return 1 if `y' is -1, otherwise `y'.
+            //! the modulus by -1 is always 0, but the builtin operator traps on `min % -1'.
+            static T    safe_divisor    (T const y)
+            {
+                return static_cast<T>(y + (static_cast<T>(y == -1) << 1));
+            }
+
+            static T    mod_truncated   (T const x, T const y) { return static_cast<T>(x % safe_divisor(y)); }
+            static T    div_truncated   (T const x, T const y) { return static_cast<T>(x / y); }
+
+            static T    mod_floored     (T const x, T const y)
+            {
+                T const r = static_cast<T>(x % safe_divisor(y));
+                return add(r, static_cast<T>(floored_mask(r, y) & y));
+            }
+
+            static T    div_floored     (T const x, T const y)
+            {
+                T const r = static_cast<T>(x % y);
+                return add(static_cast<T>(x / y), floored_mask(r, y));
+            }
+
+            static T    mod_euclidean   (T const x, T const y)
+            {
+                T const r = static_cast<T>(x % safe_divisor(y));
+                return add(r, static_cast<T>(sign_mask(r) & abs(y)));
+            }
+
+            static T    div_euclidean   (T const x, T const y)
+            {
+                //(sign_mask(y) | 1) is the sign of y.
+                T const r = static_cast<T>(x % y);
+                return add(static_cast<T>(x / y), static_cast<T>(-(sign_mask(r) & (sign_mask(y) | 1))));
+            }
+        };
+
+        //! divide (hi * 2^64 + lo) by d. hi must be less than d.
+        inline
+        boost::uint64_t divide_wide (boost::uint64_t const hi, boost::uint64_t const lo, boost::uint64_t const d, boost::uint64_t &rem)
+        {
+            BOOST_ASSERT(hi < d);
+#if defined(__GNUC__) && defined(__x86_64__)
+            //hi < d, so the quotient fits in 64 bits and divq does not fault.
+            boost::uint64_t q, r;
+            __asm__("divq %4"
+                : "=a"(q), "=d"(r)
+                : "a"(lo), "d"(hi), "rm"(d) );
+            rem = r;
+            return q;
+#elif defined(_MSC_VER) && (_MSC_VER >= 1920) && defined(_M_X64)
+            return _udiv128(hi, lo, d, &rem);
+#elif defined(BOOST_HAS_INT128)
+            boost::uint128_type const n = (static_cast<boost::uint128_type>(hi) << 64) | lo;
+            rem = static_cast<boost::uint64_t>(n % d);
+            return static_cast<boost::uint64_t>(n / d);
+#else
+            //shift-subtract long division.
+            boost::uint64_t q = 0;
+            boost::uint64_t r = hi;
+            for(int i = 63; i >= 0; --i) {
+                bool const carry = (r >> 63) != 0;
+                r = (r << 1) | ((lo >> i) & 1);
+                q = q << 1;
+                if(carry || r >= d) {
+                    r = r - d;
+                    q = q | 1;
+                }
+            }
+            rem = r;
+            return q;
+#endif
+        }
+
+#if defined(BOOST_HAS_INT128)
+        //  128-bit division.
+        //  the builtin operators call a library routine (__udivti3 etc.) for any operands.
+        //  a divisor which fits in 64 bits takes one or two 128-by-64 divisions of divide_wide,
+        //  and a wider divisor takes one, for the estimate of the quotient which fits in 64 bits.
+        //  <a href="http://www.hackersdelight.org/">Hacker's Delight</a> 9-5
+        struct wide_division
+        {
+            typedef boost::uint128_type type;
+
+            static type divide  (type const x, type const y, type &rem)
+            {
+                boost::uint64_t const x_hi = static_cast<boost::uint64_t>(x >> 64);
+                boost::uint64_t const x_lo = static_cast<boost::uint64_t>(x);
+                boost::uint64_t const y_hi = static_cast<boost::uint64_t>(y >> 64);
+                boost::uint64_t const y_lo = static_cast<boost::uint64_t>(y);
+                boost::uint64_t r;
+
+                if(y_hi == 0) {
+                    if(x_hi < y_lo) {
+                        boost::uint64_t const q = divide_wide(x_hi, x_lo, y_lo, r);
+                        rem = r;
+                        return q;
+                    }
+                    //the upper half of the quotient, and then the lower half from the remainder.
+                    boost::uint64_t const q_hi = x_hi / y_lo;
+                    boost::uint64_t const q_lo = divide_wide(x_hi % y_lo, x_lo, y_lo, r);
+                    rem = r;
+                    return (static_cast<type>(q_hi) << 64) | q_lo;
+                }
+
+                //y >= 2^64, so the quotient is less than 2^64.
+                //the upper 64 bits of the normalized y divide x / 2, which gives the quotient or the quotient + 1.
+                //(BOOST_HAS_INT128 is defined only for the compilers which have __builtin_clzll.)
+                int const n = __builtin_clzll(y_hi);
+                boost::uint64_t const v = static_cast<boost::uint64_t>((y << n) >> 64);
+                type const u = x >> 1;
+                type q = divide_wide(static_cast<boost::uint64_t>(u >> 64), static_cast<boost::uint64_t>(u), v, r);
+                q = (q << n) >> 63;
+                q -= (q != 0);
+                rem = x - q * y;
+                if(rem >= y) {
+                    rem -= y;
+                    ++q;
+                }
+                return q;
+            }
+        };
+
+        template<>
+        struct integral_division<boost::uint128_type, false>
+        {
+            typedef boost::uint128_type T;
+
+            static T    mod_truncated   (T const x, T const y) { T r; wide_division::divide(x, y, r); return r; }
+            static T    div_truncated   (T const x, T const y) { T r; return wide_division::divide(x, y, r); }
+            static T    mod_floored     (T const x, T const y) { return mod_truncated(x, y); }
+            static T    div_floored     (T const x, T const y) { return div_truncated(x, y); }
+            static T    mod_euclidean   (T const x, T const y) { return mod_truncated(x, y); }
+            static T    div_euclidean   (T const x, T const y) { return div_truncated(x, y); }
+        };
+
+        //  the magnitudes are divided, and the signs are applied with masks.
+        //  the masks do not depend on std::numeric_limits, which is not specialized for __int128 by some libraries.
+        template<>
+        struct integral_division<boost::int128_type, true>
+        {
+            typedef boost::int128_type  T;
+            typedef boost::uint128_type unsigned_type;
+
+            static T    sign_mask       (T const t) { return static_cast<T>(t >> 127); }
+
+            static T    floored_mask    (T const r, T const y)
+            {
+                return static_cast<T>(sign_mask(static_cast<T>(r ^ y)) & -static_cast<T>(r != 0));
+            }
+
+            static T    add             (T const x, T const y)
+            {
+                return static_cast<T>(static_cast<unsigned_type>(x) + static_cast<unsigned_type>(y));
+            }
+
+            static T    abs             (T const t)
+            {
+                unsigned_type const mask = static_cast<unsigned_type>(sign_mask(t));
+                return static_cast<T>((static_cast<unsigned_type>(t) ^ mask) - mask);
+            }
+
+            //! @return the truncated quotient, and `rem' is the truncated modulus.
+            //! the modulus by -1 is 0, and the quotient of min / -1 wraps around to min.
+            static T    divide          (T const x, T const y, T &rem)
+            {
+                unsigned_type r;
+                unsigned_type const q = wide_division::divide(
+                    static_cast<unsigned_type>(abs(x)), static_cast<unsigned_type>(abs(y)), r );
+                unsigned_type const x_mask = static_cast<unsigned_type>(sign_mask(x));
+                unsigned_type const q_mask = static_cast<unsigned_type>(sign_mask(static_cast<T>(x ^ y)));
+                rem = static_cast<T>((r ^ x_mask) - x_mask);
+                return static_cast<T>((q ^ q_mask) - q_mask);
+            }
+
+            static T    mod_truncated   (T const x, T const y) { T r; divide(x, y, r); return r; }
+            static T    div_truncated   (T const x, T const y) { T r; return divide(x, y, r); }
+
+            static T    mod_floored     (T const x, T const y)
+            {
+                T r;
+                divide(x, y, r);
+                return add(r, static_cast<T>(floored_mask(r, y) & y));
+            }
+
+            static T    div_floored     (T const x, T const y)
+            {
+                T r;
+                T const q = divide(x, y, r);
+                return add(q, floored_mask(r, y));
+            }
+
+            static T    mod_euclidean   (T const x, T const y)
+            {
+                T r;
+                divide(x, y, r);
+                return add(r, static_cast<T>(sign_mask(r) & abs(y)));
+            }
+
+            static T    div_euclidean   (T const x, T const y)
+            {
+                T r;
+                T const q = divide(x, y, r);
+                return add(q, static_cast<T>(-(sign_mask(r) & (sign_mask(y) | 1))));
+            }
+        };
+#endif
+
+        //  floating point division of float and long double.
+        //  the moduli are based on fmod, which is exact, and the quotients are floor(x / y) with a correction.
+        //  the quotients need no branches and no multiplications by the signs, and T is never converted to double,
+        //  so that a compiler can vectorize a loop of float. (e.g. vroundps by GCC with -fno-trapping-math)
+        //  the double functions keep their own definitions, which adjust the quotients by the remainder of fmod,
+        //  so the quotients may differ by one where x / y rounds to an integer.
+        template<typename T>
+        struct floating_division
+        {
+            BOOST_STATIC_ASSERT(boost::is_floating_point<T>::value);
+
+            static T    mod_truncated   (T const x, T const y) { return std::fmod(x, y); }
+
+            static T    mod_floored     (T const x, T const y)
+            {
+                T const r = std::fmod(x, y);
+                return (r != 0 && ((r < 0) != (y < 0))) ? static_cast<T>(r + y) : r;
+            }
+
+            static T    mod_euclidean   (T const x, T const y)
+            {
+                T const r = std::fmod(x, y);
+                return (r < 0) ? static_cast<T>(r + std::fabs(y)) : r;
+            }
+
+            static T    div_truncated   (T const x, T const y)
+            {
+                //floor(q) + 1 if q is negative and not integral.
+                T const q = x / y;
+                T const f = std::floor(q);
+                return f + static_cast<T>((q < 0) & (f != q));
+            }
+
+            static T    div_floored     (T const x, T const y) { return std::floor(x / y); }
+
+            static T    div_euclidean   (T const x, T const y)
+            {
+                //floor(q) + 1 if y is negative and q is not integral.
+                T const q = x / y;
+                T const f = std::floor(q);
+                return f + static_cast<T>((y < 0) & (f != q));
+            }
+        };
+    }   //namespace detail
+    //! @endcond
+
     //============================================================================//
     //! @defgroup modulus Modulus Operations.
     //! <a href ="http://en.wikipedia.org/wiki/Modulo_operation">see also</a>
@@ -117,9 +456,7 @@ namespace hwm { namespace arithmetic {
     T       mod_truncated           (T const &dividend, T const &divisor)
     {
         BOOST_ASSERT(divisor != 0);
-        return
-            (detail::abs_switch(dividend) % detail::abs_switch(divisor)) *
-            sign(dividend);
+        return detail::integral_division<T>::mod_truncated(dividend, divisor);
     }
 
     //! @brief modulus operation for floating point value.
@@ -131,29 +468,30 @@ namespace hwm { namespace arithmetic {
         return fmod(dividend, divisor);
     }
 
+    //! @brief float and long double version of fmod_truncated.
+    //! the arguments and the result are not converted to double.
+    template<typename T>
+    typename boost::enable_if<boost::is_floating_point<T>, T>::type
+            fmod_truncated          (T const dividend, T const divisor)
+    {
+        BOOST_ASSERT(divisor != 0);
+        return detail::floating_division<T>::mod_truncated(dividend, divisor);
+    }
+
     //! @brief modulus operation for integral value.
     //! @return return modulo by floored division.
     template<typename T>
     T       mod_floored             (T const &dividend, T const &divisor)
     {
         BOOST_ASSERT(divisor != 0);
-
-        bool const is_dividend_negative = dividend < 0;
-        bool const is_divisor_negative  = divisor < 0;
-        bool const exclusive_sign       = is_dividend_negative ^ is_divisor_negative;
-        
-        T const mod_tr = mod_truncated(dividend, divisor);
-
-        return
-            mod_tr +
-            (exclusive_sign * (mod_tr != 0) * divisor);
+        return detail::integral_division<T>::mod_floored(dividend, divisor);
     }
 
     //! @brief modulus operation for floating point value.
     //! @return return modulo by floored division.
     inline
     double  fmod_floored            (double dividend, double divisor)
-    {   
+    {
         BOOST_ASSERT(divisor != 0);
 
         bool const is_dividend_negative = dividend < 0;
@@ -167,19 +505,23 @@ namespace hwm { namespace arithmetic {
             (exclusive_sign * (mod_tr != 0) * divisor);
     }
 
+    //! @brief float and long double version of fmod_floored.
+    //! the arguments and the result are not converted to double.
+    template<typename T>
+    typename boost::enable_if<boost::is_floating_point<T>, T>::type
+            fmod_floored            (T const dividend, T const divisor)
+    {
+        BOOST_ASSERT(divisor != 0);
+        return detail::floating_division<T>::mod_floored(dividend, divisor);
+    }
+
     //! @brief modulus operation for integral value.
     //! @return return modulo by Euclidean division.
     template<typename T>
     T       mod_euclidean           (T const &dividend, T const &divisor)
     {
         BOOST_ASSERT(divisor != 0);
-
-        bool const  is_dividend_negative    = dividend < 0;
-        T const mod_tr = mod_truncated(dividend, divisor);
-
-        return
-            mod_tr +
-            (is_dividend_negative * (mod_tr != 0) * detail::abs_switch(divisor));
+        return detail::integral_division<T>::mod_euclidean(dividend, divisor);
     }
 
     //! @brief modulus operation for floating point value.
@@ -197,6 +539,16 @@ namespace hwm { namespace arithmetic {
             (is_dividend_negative * (mod_tr != 0) * detail::abs_switch(divisor));
     }
 
+    //! @brief float and long double version of fmod_euclidean.
+    //! the arguments and the result are not converted to double.
+    template<typename T>
+    typename boost::enable_if<boost::is_floating_point<T>, T>::type
+            fmod_euclidean          (T const dividend, T const divisor)
+    {
+        BOOST_ASSERT(divisor != 0);
+        return detail::floating_division<T>::mod_euclidean(dividend, divisor);
+    }
+
     //============================================================================//
     //! @}
     //  enddef of modulus
@@ -214,10 +566,7 @@ namespace hwm { namespace arithmetic {
     T       div_truncated           (T const &dividend, T const &divisor)
     {
         BOOST_ASSERT(divisor != 0);
-        return
-            (detail::abs_switch(dividend) / detail::abs_switch(divisor)) *
-            sign(dividend) *
-            sign(divisor);
+        return detail::integral_division<T>::div_truncated(dividend, divisor);
     }
 
     //! @brief division operation for floating point value.
@@ -233,20 +582,25 @@ namespace hwm { namespace arithmetic {
             sign(divisor);
     }
 
+    //! @brief float and long double version of fdiv_truncated.
+    //! the arguments and the result are not converted to double.
+    //! @note the quotient is computed from the rounded x / y, so it may differ by one from the double version
+    //! where x / y rounds to an integer, and the remainder of fmod does not.
+    template<typename T>
+    typename boost::enable_if<boost::is_floating_point<T>, T>::type
+            fdiv_truncated          (T const dividend, T const divisor)
+    {
+        BOOST_ASSERT(divisor != 0);
+        return detail::floating_division<T>::div_truncated(dividend, divisor);
+    }
+
     //! @brief division operation for integral value.
     //! @return return quatient by floored division.
     template<typename T>
     T       div_floored             (T const &dividend, T const &divisor)
     {
         BOOST_ASSERT(divisor != 0);
-        bool const is_dividend_negative = dividend < 0;
-        bool const is_divisor_negative  = divisor < 0;
-        bool const exclusive_sign       = is_dividend_negative ^ is_divisor_negative;
-
-        double const mod_tr = fmod_truncated(dividend, divisor);
-        return
-            div_truncated(dividend, divisor) +
-            ((int)exclusive_sign * (int)(mod_tr != 0) * (-1));
+        return detail::integral_division<T>::div_floored(dividend, divisor);
     }
 
     //! @brief division operation for floating point value.
@@ -265,18 +619,25 @@ namespace hwm { namespace arithmetic {
             ((int)exclusive_sign * (int)(mod_tr != 0) * (-1));
     }
 
+    //! @brief float and long double version of fdiv_floored.
+    //! the arguments and the result are not converted to double.
+    //! @note the quotient is computed from the rounded x / y, so it may differ by one from the double version
+    //! where x / y rounds to an integer, and the remainder of fmod does not.
+    template<typename T>
+    typename boost::enable_if<boost::is_floating_point<T>, T>::type
+            fdiv_floored            (T const dividend, T const divisor)
+    {
+        BOOST_ASSERT(divisor != 0);
+        return detail::floating_division<T>::div_floored(dividend, divisor);
+    }
+
     //! @brief division operation for integral value.
     //! @return return quatient by Euclidean division.
     template<typename T>
     T       div_euclidean           (T const &dividend, T const &divisor)
     {
         BOOST_ASSERT(divisor != 0);
-        bool const is_divisor_negative  = divisor < 0;
-
-        double const mod_tr = fmod_truncated(dividend, divisor);
-        return 
-            div_floored(dividend, divisor) +
-            ((int)is_divisor_negative * (int)(mod_tr != 0) * 1);
+        return detail::integral_division<T>::div_euclidean(dividend, divisor);
     }
 
     //! @brief division operation for floating point value.
@@ -292,11 +653,399 @@ namespace hwm { namespace arithmetic {
             fdiv_floored(dividend, divisor) +
             ((int)is_divisor_negative * (int)(mod_tr != 0) * 1);
     }
+
+    //! @brief float and long double version of fdiv_euclidean.
+    //! the arguments and the result are not converted to double.
+    //! @note the quotient is computed from the rounded x / y, so it may differ by one from the double version
+    //! where x / y rounds to an integer, and the remainder of fmod does not.
+    template<typename T>
+    typename boost::enable_if<boost::is_floating_point<T>, T>::type
+            fdiv_euclidean          (T const dividend, T const divisor)
+    {
+        BOOST_ASSERT(divisor != 0);
+        return detail::floating_division<T>::div_euclidean(dividend, divisor);
+    }
     //============================================================================//
     //! @}
     // enddef of division
     //============================================================================//
 
+    //! @cond DETAIL
+    namespace detail
+    {
+        //  division by a compile-time constant.
+        //  a power of two divisor uses masks and shifts,
+        //  and the other divisors use the builtin operators, which a compiler reduces to a multiply-shift sequence.
+        template<
+            typename T,
+            boost::intmax_t N,
+            bool PowerOfTwo = (N > 0 && (N & (N - 1)) == 0),
+            bool IsSigned   = boost::is_signed<T>::value >
+        struct constant_division;
+
+        template<typename T, boost::intmax_t N, bool PowerOfTwo, bool IsSigned>
+        struct constant_division_base
+        {
+            BOOST_STATIC_ASSERT(boost::is_integral<T>::value);
+            BOOST_STATIC_ASSERT(N != 0);
+            BOOST_STATIC_ASSERT(N >= boost::intmax_t(boost::integer_traits<T>::const_min));
+            BOOST_STATIC_ASSERT(N < 0 || boost::uintmax_t(N) <= boost::uintmax_t(boost::integer_traits<T>::const_max));
+
+            static T const d = static_cast<T>(N);
+        };
+
+        //signed, general divisor.
+        template<typename T, boost::intmax_t N>
+        struct constant_division<T, N, false, true>
+            :   constant_division_base<T, N, false, true>
+        {
+            using constant_division_base<T, N, false, true>::d;
+
+            //! 1 if the modulus `r' is not zero and its sign differs from the divisor, otherwise 0.
+            static BOOST_CONSTEXPR T    floored_adjustment  (T const r) { return static_cast<T>((N > 0) ? (r < 0) : (r > 0)); }
+
+            static BOOST_CONSTEXPR T    mod_truncated   (T const x) { return static_cast<T>((N == -1) ? 0 : x % d); }
+            static BOOST_CONSTEXPR T    div_truncated   (T const x) { return static_cast<T>(x / d); }
+            static BOOST_CONSTEXPR T    mod_floored     (T const x) { return static_cast<T>(mod_truncated(x) + floored_adjustment(mod_truncated(x)) * d); }
+            static BOOST_CONSTEXPR T    div_floored     (T const x) { return static_cast<T>(x / d - floored_adjustment(mod_truncated(x))); }
+            static BOOST_CONSTEXPR T    mod_euclidean   (T const x)
+            {
+                return static_cast<T>(mod_truncated(x) + (mod_truncated(x) < 0) * ((N < 0) ? -N : N));
+            }
+            static BOOST_CONSTEXPR T    div_euclidean   (T const x)
+            {
+                return static_cast<T>(x / d - (mod_truncated(x) < 0) * ((N < 0) ? -1 : 1));
+            }
+        };
+
+        //unsigned, general divisor.
+        //floored and Euclidean division are equal to truncated division for unsigned value.
+        template<typename T, boost::intmax_t N>
+        struct constant_division<T, N, false, false>
+            :   constant_division_base<T, N, false, false>
+        {
+            using constant_division_base<T, N, false, false>::d;
+            BOOST_STATIC_ASSERT(N > 0);
+
+            static BOOST_CONSTEXPR T    mod_truncated   (T const x) { return static_cast<T>(x % d); }
+            static BOOST_CONSTEXPR T    div_truncated   (T const x) { return static_cast<T>(x / d); }
+            static BOOST_CONSTEXPR T    mod_floored     (T const x) { return static_cast<T>(x % d); }
+            static BOOST_CONSTEXPR T    div_floored     (T const x) { return static_cast<T>(x / d); }
+            static BOOST_CONSTEXPR T    mod_euclidean   (T const x) { return static_cast<T>(x % d); }
+            static BOOST_CONSTEXPR T    div_euclidean   (T const x) { return static_cast<T>(x / d); }
+        };
+
+        //signed, positive power of two.
+        //the floored and Euclidean results are the mask and the arithmetic shift of two's complement.
+        //the truncated results add a bias of N - 1 to a negative dividend.
+        template<typename T, boost::intmax_t N>
+        struct constant_division<T, N, true, true>
+            :   constant_division_base<T, N, true, true>
+        {
+            static int const    shift   = boost::static_log2<static_cast<boost::static_log2_argument_type>(N)>::value;
+            static T const      mask    = static_cast<T>(N - 1);
+
+            //! N - 1 if `x' is negative, otherwise 0.
+            static BOOST_CONSTEXPR T    bias            (T const x) { return static_cast<T>((x >> std::numeric_limits<T>::digits) & mask); }
+
+            static BOOST_CONSTEXPR T    mod_truncated   (T const x) { return static_cast<T>(((x + bias(x)) & mask) - bias(x)); }
+            static BOOST_CONSTEXPR T    div_truncated   (T const x) { return static_cast<T>((x + bias(x)) >> shift); }
+            static BOOST_CONSTEXPR T    mod_floored     (T const x) { return static_cast<T>(x & mask); }
+            static BOOST_CONSTEXPR T    div_floored     (T const x) { return static_cast<T>(x >> shift); }
+            static BOOST_CONSTEXPR T    mod_euclidean   (T const x) { return static_cast<T>(x & mask); }
+            static BOOST_CONSTEXPR T    div_euclidean   (T const x) { return static_cast<T>(x >> shift); }
+        };
+
+        //unsigned, power of two.
+        template<typename T, boost::intmax_t N>
+        struct constant_division<T, N, true, false>
+            :   constant_division_base<T, N, true, false>
+        {
+            static int const    shift   = boost::static_log2<static_cast<boost::static_log2_argument_type>(N)>::value;
+            static T const      mask    = static_cast<T>(N - 1);
+
+            static BOOST_CONSTEXPR T    mod_truncated   (T const x) { return static_cast<T>(x & mask); }
+            static BOOST_CONSTEXPR T    div_truncated   (T const x) { return static_cast<T>(x >> shift); }
+            static BOOST_CONSTEXPR T    mod_floored     (T const x) { return static_cast<T>(x & mask); }
+            static BOOST_CONSTEXPR T    div_floored     (T const x) { return static_cast<T>(x >> shift); }
+            static BOOST_CONSTEXPR T    mod_euclidean   (T const x) { return static_cast<T>(x & mask); }
+            static BOOST_CONSTEXPR T    div_euclidean   (T const x) { return static_cast<T>(x >> shift); }
+        };
+    }   //namespace detail
+    //! @endcond
+
+    //============================================================================//
+    //! @defgroup constant_division Modulus and Division by Constant.
+    //! the divisor is given as a template argument. e.g. mod_floored<8>(x).
+    //! the results are the same as the functions with a runtime divisor.
+    //! power of two divisors are reduced to masks and shifts, and the others to multiply-shift sequences.
+    //! these are constexpr if the compiler supports it.
+    //! @tparam N the divisor. must not be zero, and must be representable in T.
+    //! @{
+    //============================================================================//
+
+    //! @brief modulus operation by constant.
+    //! @return return modulo by truncated division.
+    template<boost::intmax_t N, typename T>
+    BOOST_CONSTEXPR
+    T       mod_truncated           (T const &dividend) { return detail::constant_division<T, N>::mod_truncated(dividend); }
+
+    //! @brief modulus operation by constant.
+    //! @return return modulo by floored division.
+    template<boost::intmax_t N, typename T>
+    BOOST_CONSTEXPR
+    T       mod_floored             (T const &dividend) { return detail::constant_division<T, N>::mod_floored(dividend); }
+
+    //! @brief modulus operation by constant.
+    //! @return return modulo by Euclidean division.
+    template<boost::intmax_t N, typename T>
+    BOOST_CONSTEXPR
+    T       mod_euclidean           (T const &dividend) { return detail::constant_division<T, N>::mod_euclidean(dividend); }
+
+    //! @brief division operation by constant.
+    //! @return return quatient by truncated division.
+    template<boost::intmax_t N, typename T>
+    BOOST_CONSTEXPR
+    T       div_truncated           (T const &dividend) { return detail::constant_division<T, N>::div_truncated(dividend); }
+
+    //! @brief division operation by constant.
+    //! @return return quatient by floored division.
+    template<boost::intmax_t N, typename T>
+    BOOST_CONSTEXPR
+    T       div_floored             (T const &dividend) { return detail::constant_division<T, N>::div_floored(dividend); }
+
+    //! @brief division operation by constant.
+    //! @return return quatient by Euclidean division.
+    template<boost::intmax_t N, typename T>
+    BOOST_CONSTEXPR
+    T       div_euclidean           (T const &dividend) { return detail::constant_division<T, N>::div_euclidean(dividend); }
+
+    //============================================================================//
+    //! @}
+    // enddef of constant_division
+    //============================================================================//
+
+    //! @cond DETAIL
+    namespace detail
+    {
+        //  overflow detection.
+        //  each function stores the wrapped result to `r', and returns true if the exact result is not representable.
+        //  the compiler builtins compile to the flags of the arithmetic instruction.
+        template<typename T, bool IsSigned = boost::is_signed<T>::value>
+        struct overflow;
+
+        template<typename T>
+        struct overflow<T, true>
+        {
+            BOOST_STATIC_ASSERT(boost::is_integral<T>::value);
+            typedef typename boost::make_unsigned<T>::type  unsigned_type;
+
+            static bool add     (T const x, T const y, T &r)
+            {
+#if defined HWM_ARITHMETIC_OVERFLOW_BUILTINS
+                return __builtin_add_overflow(x, y, &r);
+#else
+                r = static_cast<T>(static_cast<unsigned_type>(static_cast<unsigned_type>(x) + static_cast<unsigned_type>(y)));
+                //the operands have the same sign, and the result has the other one.
+                return ((x ^ r) & (y ^ r)) < 0;
+#endif
+            }
+
+            static bool sub     (T const x, T const y, T &r)
+            {
+#if defined HWM_ARITHMETIC_OVERFLOW_BUILTINS
+                return __builtin_sub_overflow(x, y, &r);
+#else
+                r = static_cast<T>(static_cast<unsigned_type>(static_cast<unsigned_type>(x) - static_cast<unsigned_type>(y)));
+                return ((x ^ y) & (x ^ r)) < 0;
+#endif
+            }
+
+            static bool mul     (T const x, T const y, T &r)
+            {
+#if defined HWM_ARITHMETIC_OVERFLOW_BUILTINS
+                return __builtin_mul_overflow(x, y, &r);
+#else
+                unsigned_type const ux = (x < 0) ? static_cast<unsigned_type>(0 - static_cast<unsigned_type>(x)) : static_cast<unsigned_type>(x);
+                unsigned_type const uy = (y < 0) ? static_cast<unsigned_type>(0 - static_cast<unsigned_type>(y)) : static_cast<unsigned_type>(y);
+                bool const negative = (x < 0) != (y < 0);
+                //the magnitude of min is max + 1.
+                unsigned_type const limit = static_cast<unsigned_type>(static_cast<unsigned_type>((std::numeric_limits<T>::max)()) + negative);
+                boost::uintmax_t const p = static_cast<boost::uintmax_t>(ux) * static_cast<boost::uintmax_t>(uy);
+                r = static_cast<T>(negative ? static_cast<unsigned_type>(0 - p) : static_cast<unsigned_type>(p));
+                return ux != 0 && uy > limit / ux;
+#endif
+            }
+
+            //! max if `x' is not negative, otherwise min.
+            static T    saturate    (T const x)
+            {
+                return static_cast<T>(static_cast<unsigned_type>(
+                    static_cast<unsigned_type>((std::numeric_limits<T>::max)()) +
+                    static_cast<unsigned_type>(static_cast<unsigned_type>(x) >> std::numeric_limits<T>::digits) ));
+            }
+
+            static T    add_sat (T const x, T const y) { T r; return add(x, y, r) ? saturate(x) : r; }
+            static T    sub_sat (T const x, T const y) { T r; return sub(x, y, r) ? saturate(x) : r; }
+            static T    mul_sat (T const x, T const y) { T r; return mul(x, y, r) ? saturate(static_cast<T>(x ^ y)) : r; }
+
+            static T    abs_sat (T const x)
+            {
+                return (x == (std::numeric_limits<T>::min)()) ? (std::numeric_limits<T>::max)() : integral_division<T>::abs(x);
+            }
+
+            static bool is_abs_overflow (T const x) { return x == (std::numeric_limits<T>::min)(); }
+            static bool is_div_overflow (T const x, T const y) { return y == -1 && x == (std::numeric_limits<T>::min)(); }
+        };
+
+        template<typename T>
+        struct overflow<T, false>
+        {
+            BOOST_STATIC_ASSERT(boost::is_integral<T>::value);
+
+            static bool add     (T const x, T const y, T &r)
+            {
+#if defined HWM_ARITHMETIC_OVERFLOW_BUILTINS
+                return __builtin_add_overflow(x, y, &r);
+#else
+                r = static_cast<T>(x + y);
+                return r < x;
+#endif
+            }
+
+            static bool sub     (T const x, T const y, T &r)
+            {
+#if defined HWM_ARITHMETIC_OVERFLOW_BUILTINS
+                return __builtin_sub_overflow(x, y, &r);
+#else
+                r = static_cast<T>(x - y);
+                return x < y;
+#endif
+            }
+
+            static bool mul     (T const x, T const y, T &r)
+            {
+#if defined HWM_ARITHMETIC_OVERFLOW_BUILTINS
+                return __builtin_mul_overflow(x, y, &r);
+#else
+                //unsigned types smaller than int would be promoted to int, and the product could overflow.
+                r = static_cast<T>(static_cast<boost::uintmax_t>(x) * static_cast<boost::uintmax_t>(y));
+                return x != 0 && y > (std::numeric_limits<T>::max)() / x;
+#endif
+            }
+
+            static T    add_sat (T const x, T const y) { T r; return add(x, y, r) ? (std::numeric_limits<T>::max)() : r; }
+            static T    sub_sat (T const x, T const y) { T r; return sub(x, y, r) ? static_cast<T>(0) : r; }
+            static T    mul_sat (T const x, T const y) { T r; return mul(x, y, r) ? (std::numeric_limits<T>::max)() : r; }
+            static T    abs_sat (T const x) { return x; }
+
+            static bool is_abs_overflow (T const) { return false; }
+            static bool is_div_overflow (T const, T const) { return false; }
+        };
+    }   //namespace detail
+    //! @endcond
+
+    //============================================================================//
+    //! @defgroup saturation Saturating Operations.
+    //! the result is clamped to the range of T instead of overflowing.
+    //! T must be an integral type.
+    //! @{
+    //============================================================================//
+
+    //! @return x + y, clamped to [min, max].
+    template<typename T>
+    T       add_sat                 (T const &x, T const &y) { return detail::overflow<T>::add_sat(x, y); }
+
+    //! @return x - y, clamped to [min, max].
+    template<typename T>
+    T       sub_sat                 (T const &x, T const &y) { return detail::overflow<T>::sub_sat(x, y); }
+
+    //! @return x * y, clamped to [min, max].
+    template<typename T>
+    T       mul_sat                 (T const &x, T const &y) { return detail::overflow<T>::mul_sat(x, y); }
+
+    //! @return abs(x). abs_sat(min) is max.
+    template<typename T>
+    T       abs_sat                 (T const &x) { return detail::overflow<T>::abs_sat(x); }
+
+    //! @return quotient by truncated division. div_sat(min, -1) is max.
+    //! divisor must not be zero.
+    template<typename T>
+    T       div_sat                 (T const &dividend, T const &divisor)
+    {
+        BOOST_ASSERT(divisor != 0);
+        return detail::overflow<T>::is_div_overflow(dividend, divisor)
+            ?   (std::numeric_limits<T>::max)()
+            :   static_cast<T>(dividend / divisor);
+    }
+
+    //============================================================================//
+    //! @}
+    // enddef of saturation
+    //============================================================================//
+
+    //============================================================================//
+    //! @defgroup checked Overflow Checked Operations.
+    //! each function stores the exact result to `result' and returns true if it is representable in T.
+    //! otherwise it returns false, and `result' is not modified.
+    //! T must be an integral type.
+    //! @{
+    //============================================================================//
+
+    //! @brief checked x + y.
+    template<typename T>
+    bool    checked_add             (T const &x, T const &y, T &result)
+    {
+        T r;
+        if(detail::overflow<T>::add(x, y, r)) { return false; }
+        result = r;
+        return true;
+    }
+
+    //! @brief checked x - y.
+    template<typename T>
+    bool    checked_sub             (T const &x, T const &y, T &result)
+    {
+        T r;
+        if(detail::overflow<T>::sub(x, y, r)) { return false; }
+        result = r;
+        return true;
+    }
+
+    //! @brief checked x * y.
+    template<typename T>
+    bool    checked_mul             (T const &x, T const &y, T &result)
+    {
+        T r;
+        if(detail::overflow<T>::mul(x, y, r)) { return false; }
+        result = r;
+        return true;
+    }
+
+    //! @brief checked abs(x).
+    template<typename T>
+    bool    checked_abs             (T const &x, T &result)
+    {
+        if(detail::overflow<T>::is_abs_overflow(x)) { return false; }
+        result = abs(x);
+        return true;
+    }
+
+    //! @brief checked truncated division.
+    //! returns false also if `divisor' is zero.
+    template<typename T>
+    bool    checked_div             (T const &dividend, T const &divisor, T &result)
+    {
+        if(divisor == 0 || detail::overflow<T>::is_div_overflow(dividend, divisor)) { return false; }
+        result = static_cast<T>(dividend / divisor);
+        return true;
+    }
+
+    //============================================================================//
+    //! @}
+    // enddef of checked
+    //============================================================================//
+
 }}  //namespace hwm::arithmetic
 
 #endif  //HWM_ARITHMETIC_HPP
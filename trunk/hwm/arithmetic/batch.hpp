@@ -0,0 +1,906 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef HWM_ARITHMETIC_BATCH_HPP
+#define HWM_ARITHMETIC_BATCH_HPP
+
+//! hwm.Arithmetic
+//! bulk operations over arrays.
+//! each function returns exactly the same results as the scalar function of the same name.
+//! SSE4.1 / AVX2 kernels are selected at runtime. (see cpu.hpp)
+//! @file
+
+#include <cstddef>
+#include <boost/assert.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/utility/enable_if.hpp>
+
+#include "../arithmetic.hpp"
+#include "./cpu.hpp"
+#include "./divisor.hpp"
+
+namespace hwm { namespace arithmetic {
+
+    //! @cond DETAIL
+    namespace detail
+    {
+        enum division_kind
+        {
+            truncated_division,
+            floored_division,
+            euclidean_division
+        };
+
+        //! a division operation applied by the bulk functions.
+        //! returns quotient if `Quotient' is true, otherwise returns modulus.
+        //! the divisor is either a value or a precomputed divisor.
+        template<division_kind Kind, bool Quotient>
+        struct divmod_op;
+
+        template<> struct divmod_op<truncated_division, true> {
+            template<typename T, typename D> static T apply(T const &x, D const &y) { return div_truncated(x, y); }
+        };
+        template<> struct divmod_op<truncated_division, false> {
+            template<typename T, typename D> static T apply(T const &x, D const &y) { return mod_truncated(x, y); }
+        };
+        template<> struct divmod_op<floored_division, true> {
+            template<typename T, typename D> static T apply(T const &x, D const &y) { return div_floored(x, y); }
+        };
+        template<> struct divmod_op<floored_division, false> {
+            template<typename T, typename D> static T apply(T const &x, D const &y) { return mod_floored(x, y); }
+        };
+        template<> struct divmod_op<euclidean_division, true> {
+            template<typename T, typename D> static T apply(T const &x, D const &y) { return div_euclidean(x, y); }
+        };
+        template<> struct divmod_op<euclidean_division, false> {
+            template<typename T, typename D> static T apply(T const &x, D const &y) { return mod_euclidean(x, y); }
+        };
+
+        template<division_kind Kind, bool Quotient, typename T>
+        T * divmod_scalar   (T const *first, T const *last, T const &divisor, T *out)
+        {
+            for( ; first != last; ++first, ++out) {
+                *out = divmod_op<Kind, Quotient>::apply(*first, divisor);
+            }
+            return out;
+        }
+
+#if defined HWM_ARITHMETIC_SIMD_X86
+        //  int32 kernels.
+        //  the truncated quotient is computed by double precision division.
+        //  it is exact because every int32 value is representable as double and
+        //  the distance between a non-integral quotient and an integer is at least 1/|divisor|.
+        //  the modulus and the adjustment for floored / Euclidean division are done in integer.
+
+        template<division_kind Kind, bool Quotient>
+        HWM_ARITHMETIC_TARGET_SSE41
+        boost::int32_t *
+                divmod_sse41    (
+                    boost::int32_t const *first, boost::int32_t const *last,
+                    boost::int32_t divisor, boost::int32_t *out )
+        {
+            __m128i const   zero    = _mm_setzero_si128();
+            __m128i const   vd      = _mm_set1_epi32(divisor);
+            __m128d const   vdd     = _mm_set1_pd(divisor);
+            __m128i const   abs_d   = _mm_abs_epi32(vd);
+            __m128i const   sign_d  = _mm_set1_epi32(divisor < 0 ? -1 : 1);
+
+            for( ; last - first >= 4; first += 4, out += 4) {
+                __m128i const x     = _mm_loadu_si128(reinterpret_cast<__m128i const *>(first));
+                __m128i const q_lo  = _mm_cvttpd_epi32(_mm_div_pd(_mm_cvtepi32_pd(x), vdd));
+                __m128i const q_hi  = _mm_cvttpd_epi32(_mm_div_pd(_mm_cvtepi32_pd(_mm_unpackhi_epi64(x, x)), vdd));
+                __m128i q           = _mm_unpacklo_epi64(q_lo, q_hi);
+                __m128i r           = _mm_sub_epi32(x, _mm_mullo_epi32(q, vd));
+
+                if(Kind == floored_division) {
+                    //-1 where the signs of the modulus and the divisor differ.
+                    __m128i const adjust =
+                        _mm_andnot_si128(
+                            _mm_cmpeq_epi32(r, zero),
+                            _mm_srai_epi32(_mm_xor_si128(r, vd), 31) );
+                    q = _mm_add_epi32(q, adjust);
+                    r = _mm_add_epi32(r, _mm_and_si128(adjust, vd));
+                } else if(Kind == euclidean_division) {
+                    //-1 where the modulus is negative.
+                    __m128i const adjust = _mm_srai_epi32(r, 31);
+                    q = _mm_sub_epi32(q, _mm_and_si128(adjust, sign_d));
+                    r = _mm_add_epi32(r, _mm_and_si128(adjust, abs_d));
+                }
+
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out), Quotient ? q : r);
+            }
+            return divmod_scalar<Kind, Quotient>(first, last, divisor, out);
+        }
+
+        template<division_kind Kind, bool Quotient>
+        HWM_ARITHMETIC_TARGET_AVX2
+        boost::int32_t *
+                divmod_avx2     (
+                    boost::int32_t const *first, boost::int32_t const *last,
+                    boost::int32_t divisor, boost::int32_t *out )
+        {
+            __m256i const   zero    = _mm256_setzero_si256();
+            __m256i const   vd      = _mm256_set1_epi32(divisor);
+            __m256d const   vdd     = _mm256_set1_pd(divisor);
+            __m256i const   abs_d   = _mm256_abs_epi32(vd);
+            __m256i const   sign_d  = _mm256_set1_epi32(divisor < 0 ? -1 : 1);
+
+            for( ; last - first >= 8; first += 8, out += 8) {
+                __m256i const x     = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(first));
+                __m128i const q_lo  = _mm256_cvttpd_epi32(_mm256_div_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(x)), vdd));
+                __m128i const q_hi  = _mm256_cvttpd_epi32(_mm256_div_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(x, 1)), vdd));
+                __m256i q           = _mm256_inserti128_si256(_mm256_castsi128_si256(q_lo), q_hi, 1);
+                __m256i r           = _mm256_sub_epi32(x, _mm256_mullo_epi32(q, vd));
+
+                if(Kind == floored_division) {
+                    __m256i const adjust =
+                        _mm256_andnot_si256(
+                            _mm256_cmpeq_epi32(r, zero),
+                            _mm256_srai_epi32(_mm256_xor_si256(r, vd), 31) );
+                    q = _mm256_add_epi32(q, adjust);
+                    r = _mm256_add_epi32(r, _mm256_and_si256(adjust, vd));
+                } else if(Kind == euclidean_division) {
+                    __m256i const adjust = _mm256_srai_epi32(r, 31);
+                    q = _mm256_sub_epi32(q, _mm256_and_si256(adjust, sign_d));
+                    r = _mm256_add_epi32(r, _mm256_and_si256(adjust, abs_d));
+                }
+
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), Quotient ? q : r);
+            }
+            return divmod_scalar<Kind, Quotient>(first, last, divisor, out);
+        }
+#endif  //HWM_ARITHMETIC_SIMD_X86
+
+        //  other integral types divide by multiplication with a precomputed divisor.
+        //  (SSE4.1 / AVX2 have no 64-bit multiply-high, so that is also the fastest way for int64.)
+        template<division_kind Kind, bool Quotient, typename T>
+        T * divmod_batch    (T const *first, T const *last, divisor<T> const &d, T *out)
+        {
+            for( ; first != last; ++first, ++out) {
+                *out = divmod_op<Kind, Quotient>::apply(*first, d);
+            }
+            return out;
+        }
+
+        template<division_kind Kind, bool Quotient, typename T>
+        T * divmod_batch    (T const *first, T const *last, T const &divisor, T *out)
+        {
+            return divmod_batch<Kind, Quotient>(first, last, hwm::arithmetic::divisor<T>(divisor), out);
+        }
+
+        template<division_kind Kind, bool Quotient>
+        boost::int32_t *
+                divmod_batch    (
+                    boost::int32_t const *first, boost::int32_t const *last,
+                    boost::int32_t const &divisor, boost::int32_t *out )
+        {
+#if defined HWM_ARITHMETIC_SIMD_X86
+            switch(current_simd_level()) {
+            case simd_avx2:     return divmod_avx2<Kind, Quotient>(first, last, divisor, out);
+            case simd_sse41:    return divmod_sse41<Kind, Quotient>(first, last, divisor, out);
+            default:            break;
+            }
+#endif
+            return divmod_batch<Kind, Quotient>(first, last, hwm::arithmetic::divisor<boost::int32_t>(divisor), out);
+        }
+
+        //! the SIMD kernels are faster than the precomputed divisor for int32.
+        template<division_kind Kind, bool Quotient>
+        boost::int32_t *
+                divmod_batch    (
+                    boost::int32_t const *first, boost::int32_t const *last,
+                    divisor<boost::int32_t> const &d, boost::int32_t *out )
+        {
+#if defined HWM_ARITHMETIC_SIMD_X86
+            switch(current_simd_level()) {
+            case simd_avx2:     return divmod_avx2<Kind, Quotient>(first, last, d.value(), out);
+            case simd_sse41:    return divmod_sse41<Kind, Quotient>(first, last, d.value(), out);
+            default:            break;
+            }
+#endif
+            for( ; first != last; ++first, ++out) {
+                *out = divmod_op<Kind, Quotient>::apply(*first, d);
+            }
+            return out;
+        }
+    }   //namespace detail
+    //! @endcond
+
+    //============================================================================//
+    //! @defgroup batch_division Bulk Modulus and Division Operations.
+    //! apply a modulus or division operation with the same divisor to [first, last),
+    //! and write the results to the range beginning at `out'.
+    //! `out' may be equal to `first'.
+    //! the preconditions are the same as the scalar function of the same name.
+    //! @return the end of the output range.
+    //! @{
+    //============================================================================//
+
+    //! @brief bulk version of mod_truncated.
+    template<typename T>
+    T *     mod_truncated           (T const *first, T const *last, T const &divisor, T *out)
+    {
+        BOOST_ASSERT(divisor != 0);
+        return detail::divmod_batch<detail::truncated_division, false>(first, last, divisor, out);
+    }
+
+    //! @brief bulk version of mod_truncated by a precomputed divisor.
+    template<typename T>
+    T *     mod_truncated           (T const *first, T const *last, divisor<T> const &d, T *out)
+    {
+        return detail::divmod_batch<detail::truncated_division, false>(first, last, d, out);
+    }
+
+    //! @brief bulk version of mod_floored.
+    template<typename T>
+    T *     mod_floored             (T const *first, T const *last, T const &divisor, T *out)
+    {
+        BOOST_ASSERT(divisor != 0);
+        return detail::divmod_batch<detail::floored_division, false>(first, last, divisor, out);
+    }
+
+    //! @brief bulk version of mod_floored by a precomputed divisor.
+    template<typename T>
+    T *     mod_floored             (T const *first, T const *last, divisor<T> const &d, T *out)
+    {
+        return detail::divmod_batch<detail::floored_division, false>(first, last, d, out);
+    }
+
+    //! @brief bulk version of mod_euclidean.
+    template<typename T>
+    T *     mod_euclidean           (T const *first, T const *last, T const &divisor, T *out)
+    {
+        BOOST_ASSERT(divisor != 0);
+        return detail::divmod_batch<detail::euclidean_division, false>(first, last, divisor, out);
+    }
+
+    //! @brief bulk version of mod_euclidean by a precomputed divisor.
+    template<typename T>
+    T *     mod_euclidean           (T const *first, T const *last, divisor<T> const &d, T *out)
+    {
+        return detail::divmod_batch<detail::euclidean_division, false>(first, last, d, out);
+    }
+
+    //! @brief bulk version of div_truncated.
+    template<typename T>
+    T *     div_truncated           (T const *first, T const *last, T const &divisor, T *out)
+    {
+        BOOST_ASSERT(divisor != 0);
+        return detail::divmod_batch<detail::truncated_division, true>(first, last, divisor, out);
+    }
+
+    //! @brief bulk version of div_truncated by a precomputed divisor.
+    template<typename T>
+    T *     div_truncated           (T const *first, T const *last, divisor<T> const &d, T *out)
+    {
+        return detail::divmod_batch<detail::truncated_division, true>(first, last, d, out);
+    }
+
+    //! @brief bulk version of div_floored.
+    template<typename T>
+    T *     div_floored             (T const *first, T const *last, T const &divisor, T *out)
+    {
+        BOOST_ASSERT(divisor != 0);
+        return detail::divmod_batch<detail::floored_division, true>(first, last, divisor, out);
+    }
+
+    //! @brief bulk version of div_floored by a precomputed divisor.
+    template<typename T>
+    T *     div_floored             (T const *first, T const *last, divisor<T> const &d, T *out)
+    {
+        return detail::divmod_batch<detail::floored_division, true>(first, last, d, out);
+    }
+
+    //! @brief bulk version of div_euclidean.
+    template<typename T>
+    T *     div_euclidean           (T const *first, T const *last, T const &divisor, T *out)
+    {
+        BOOST_ASSERT(divisor != 0);
+        return detail::divmod_batch<detail::euclidean_division, true>(first, last, divisor, out);
+    }
+
+    //! @brief bulk version of div_euclidean by a precomputed divisor.
+    template<typename T>
+    T *     div_euclidean           (T const *first, T const *last, divisor<T> const &d, T *out)
+    {
+        return detail::divmod_batch<detail::euclidean_division, true>(first, last, d, out);
+    }
+
+    //! @brief bulk version of mod_truncated for arrays.
+    template<typename T, std::size_t N>
+    T *     mod_truncated           (T const (&in)[N], T const &divisor, T (&out)[N])
+    {
+        return mod_truncated(in, in + N, divisor, out);
+    }
+
+    //! @brief bulk version of mod_floored for arrays.
+    template<typename T, std::size_t N>
+    T *     mod_floored             (T const (&in)[N], T const &divisor, T (&out)[N])
+    {
+        return mod_floored(in, in + N, divisor, out);
+    }
+
+    //! @brief bulk version of mod_euclidean for arrays.
+    template<typename T, std::size_t N>
+    T *     mod_euclidean           (T const (&in)[N], T const &divisor, T (&out)[N])
+    {
+        return mod_euclidean(in, in + N, divisor, out);
+    }
+
+    //! @brief bulk version of div_truncated for arrays.
+    template<typename T, std::size_t N>
+    T *     div_truncated           (T const (&in)[N], T const &divisor, T (&out)[N])
+    {
+        return div_truncated(in, in + N, divisor, out);
+    }
+
+    //! @brief bulk version of div_floored for arrays.
+    template<typename T, std::size_t N>
+    T *     div_floored             (T const (&in)[N], T const &divisor, T (&out)[N])
+    {
+        return div_floored(in, in + N, divisor, out);
+    }
+
+    //! @brief bulk version of div_euclidean for arrays.
+    template<typename T, std::size_t N>
+    T *     div_euclidean           (T const (&in)[N], T const &divisor, T (&out)[N])
+    {
+        return div_euclidean(in, in + N, divisor, out);
+    }
+
+    //============================================================================//
+    //! @}
+    //  enddef of batch_division
+    //============================================================================//
+
+    //! @cond DETAIL
+    namespace detail
+    {
+        struct round_simple_op
+        {
+            template<typename T>
+            static T    apply   (T const &x) { return round_simple(x); }
+
+#if defined HWM_ARITHMETIC_SIMD_X86
+            //floor(x + 0.5)
+            HWM_ARITHMETIC_TARGET_SSE41
+            static __m128d  sse41   (__m128d const x)
+            {
+                return _mm_round_pd(_mm_add_pd(x, _mm_set1_pd(0.5)), _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+            }
+
+            HWM_ARITHMETIC_TARGET_AVX2
+            static __m256d  avx2    (__m256d const x)
+            {
+                return _mm256_round_pd(_mm256_add_pd(x, _mm256_set1_pd(0.5)), _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+            }
+#endif
+        };
+
+        struct round_to_nearest_even_op
+        {
+            template<typename T>
+            static T    apply   (T const &x) { return round_to_nearest_even(x); }
+
+#if defined HWM_ARITHMETIC_SIMD_X86
+            //  same steps as the scalar version.
+            //  int_part is modf's integral part, and frac_part is exactly x - int_part.
+            //  fmod(int_part, 2.0) is needed only if frac_part is 0.5, where int_part is not negative.
+            HWM_ARITHMETIC_TARGET_SSE41
+            static __m128d  sse41   (__m128d const x)
+            {
+                __m128d const half      = _mm_set1_pd(0.5);
+                __m128d const int_part  = _mm_round_pd(x, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+                __m128d const frac_part = _mm_sub_pd(x, int_part);
+                __m128d const half_int  = _mm_round_pd(_mm_mul_pd(int_part, half), _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+                __m128d const parity    = _mm_sub_pd(int_part, _mm_add_pd(half_int, half_int));
+
+                __m128d const up        = _mm_add_pd(int_part, _mm_set1_pd(1.0));
+                __m128d const to_even   = _mm_add_pd(int_part, parity);
+                __m128d const result    = _mm_blendv_pd(up, to_even, _mm_cmpeq_pd(frac_part, half));
+                return _mm_blendv_pd(result, int_part, _mm_cmplt_pd(frac_part, half));
+            }
+
+            HWM_ARITHMETIC_TARGET_AVX2
+            static __m256d  avx2    (__m256d const x)
+            {
+                __m256d const half      = _mm256_set1_pd(0.5);
+                __m256d const int_part  = _mm256_round_pd(x, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+                __m256d const frac_part = _mm256_sub_pd(x, int_part);
+                __m256d const half_int  = _mm256_round_pd(_mm256_mul_pd(int_part, half), _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+                __m256d const parity    = _mm256_sub_pd(int_part, _mm256_add_pd(half_int, half_int));
+
+                __m256d const up        = _mm256_add_pd(int_part, _mm256_set1_pd(1.0));
+                __m256d const to_even   = _mm256_add_pd(int_part, parity);
+                __m256d const result    = _mm256_blendv_pd(up, to_even, _mm256_cmp_pd(frac_part, half, _CMP_EQ_OQ));
+                return _mm256_blendv_pd(result, int_part, _mm256_cmp_pd(frac_part, half, _CMP_LT_OQ));
+            }
+#endif
+        };
+
+        //! the results of a bulk rounding are the scalar results converted to the output type.
+        template<typename Op, typename T, typename U>
+        U * round_scalar    (T const *first, T const *last, U *out)
+        {
+            for( ; first != last; ++first, ++out) {
+                *out = static_cast<U>(Op::apply(*first));
+            }
+            return out;
+        }
+
+        //! the combinations of the input and output types that have SIMD kernels.
+        template<typename T, typename U> struct is_simd_rounding                    { static bool const value = false; };
+        template<> struct is_simd_rounding<float, float>                            { static bool const value = true; };
+        template<> struct is_simd_rounding<float, boost::int32_t>                   { static bool const value = true; };
+        template<> struct is_simd_rounding<float, boost::int64_t>                   { static bool const value = true; };
+        template<> struct is_simd_rounding<double, double>                          { static bool const value = true; };
+        template<> struct is_simd_rounding<double, boost::int32_t>                  { static bool const value = true; };
+        template<> struct is_simd_rounding<double, boost::int64_t>                  { static bool const value = true; };
+
+#if defined HWM_ARITHMETIC_SIMD_X86
+        //  the kernels compute in double even for float, as the scalar functions do.
+        //  every float is exactly representable as double, so the results are equal.
+
+        //  int64 conversion: adding 1.5 * 2^52 places an integral value |v| < 2^51
+        //  in the low bits of the mantissa. the other values are converted by the scalar code.
+        double const int64_conversion_magic = 6755399441055744.0;
+        double const int64_conversion_limit = 2251799813685248.0;
+
+        HWM_ARITHMETIC_TARGET_SSE41
+        inline __m128d  load_sse41     (double const *p) { return _mm_loadu_pd(p); }
+        HWM_ARITHMETIC_TARGET_SSE41
+        inline __m128d  load_sse41     (float const *p)
+        {
+            return _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<__m128i const *>(p))));
+        }
+
+        HWM_ARITHMETIC_TARGET_SSE41
+        inline void     store_sse41     (double *p, __m128d const v) { _mm_storeu_pd(p, v); }
+        HWM_ARITHMETIC_TARGET_SSE41
+        inline void     store_sse41     (float *p, __m128d const v)
+        {
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(p), _mm_castps_si128(_mm_cvtpd_ps(v)));
+        }
+        HWM_ARITHMETIC_TARGET_SSE41
+        inline void     store_sse41     (boost::int32_t *p, __m128d const v)
+        {
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(p), _mm_cvttpd_epi32(v));
+        }
+        HWM_ARITHMETIC_TARGET_SSE41
+        inline void     store_sse41     (boost::int64_t *p, __m128d const v)
+        {
+            __m128d const abs_v     = _mm_andnot_pd(_mm_set1_pd(-0.0), v);
+            __m128d const in_range  = _mm_cmplt_pd(abs_v, _mm_set1_pd(int64_conversion_limit));
+            if(_mm_movemask_pd(in_range) == 0x3) {
+                __m128d const magic = _mm_set1_pd(int64_conversion_magic);
+                _mm_storeu_si128(
+                    reinterpret_cast<__m128i *>(p),
+                    _mm_sub_epi64(_mm_castpd_si128(_mm_add_pd(v, magic)), _mm_castpd_si128(magic)) );
+            } else {
+                double tmp[2];
+                _mm_storeu_pd(tmp, v);
+                p[0] = static_cast<boost::int64_t>(tmp[0]);
+                p[1] = static_cast<boost::int64_t>(tmp[1]);
+            }
+        }
+
+        template<typename Op, typename T, typename U>
+        HWM_ARITHMETIC_TARGET_SSE41
+        U * round_sse41     (T const *first, T const *last, U *out)
+        {
+            for( ; last - first >= 2; first += 2, out += 2) {
+                store_sse41(out, Op::sse41(load_sse41(first)));
+            }
+            return round_scalar<Op>(first, last, out);
+        }
+
+        HWM_ARITHMETIC_TARGET_AVX2
+        inline __m256d  load_avx2       (double const *p) { return _mm256_loadu_pd(p); }
+        HWM_ARITHMETIC_TARGET_AVX2
+        inline __m256d  load_avx2       (float const *p) { return _mm256_cvtps_pd(_mm_loadu_ps(p)); }
+
+        HWM_ARITHMETIC_TARGET_AVX2
+        inline void     store_avx2      (double *p, __m256d const v) { _mm256_storeu_pd(p, v); }
+        HWM_ARITHMETIC_TARGET_AVX2
+        inline void     store_avx2      (float *p, __m256d const v) { _mm_storeu_ps(p, _mm256_cvtpd_ps(v)); }
+        HWM_ARITHMETIC_TARGET_AVX2
+        inline void     store_avx2      (boost::int32_t *p, __m256d const v)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(p), _mm256_cvttpd_epi32(v));
+        }
+        HWM_ARITHMETIC_TARGET_AVX2
+        inline void     store_avx2      (boost::int64_t *p, __m256d const v)
+        {
+            __m256d const abs_v     = _mm256_andnot_pd(_mm256_set1_pd(-0.0), v);
+            __m256d const in_range  = _mm256_cmp_pd(abs_v, _mm256_set1_pd(int64_conversion_limit), _CMP_LT_OQ);
+            if(_mm256_movemask_pd(in_range) == 0xF) {
+                __m256d const magic = _mm256_set1_pd(int64_conversion_magic);
+                _mm256_storeu_si256(
+                    reinterpret_cast<__m256i *>(p),
+                    _mm256_sub_epi64(_mm256_castpd_si256(_mm256_add_pd(v, magic)), _mm256_castpd_si256(magic)) );
+            } else {
+                double tmp[4];
+                _mm256_storeu_pd(tmp, v);
+                for(int i = 0; i < 4; ++i) { p[i] = static_cast<boost::int64_t>(tmp[i]); }
+            }
+        }
+
+        template<typename Op, typename T, typename U>
+        HWM_ARITHMETIC_TARGET_AVX2
+        U * round_avx2      (T const *first, T const *last, U *out)
+        {
+            for( ; last - first >= 4; first += 4, out += 4) {
+                store_avx2(out, Op::avx2(load_avx2(first)));
+            }
+            return round_scalar<Op>(first, last, out);
+        }
+#endif  //HWM_ARITHMETIC_SIMD_X86
+
+        template<typename Op, typename T, typename U>
+        U * round_batch     (
+                T const *first, T const *last, U *out,
+                typename boost::disable_if_c<is_simd_rounding<T, U>::value>::type* = 0 )
+        {
+            return round_scalar<Op>(first, last, out);
+        }
+
+        template<typename Op, typename T, typename U>
+        U * round_batch     (
+                T const *first, T const *last, U *out,
+                typename boost::enable_if_c<is_simd_rounding<T, U>::value>::type* = 0 )
+        {
+#if defined HWM_ARITHMETIC_SIMD_X86
+            switch(current_simd_level()) {
+            case simd_avx2:     return round_avx2<Op>(first, last, out);
+            case simd_sse41:    return round_sse41<Op>(first, last, out);
+            default:            break;
+            }
+#endif
+            return round_scalar<Op>(first, last, out);
+        }
+    }   //namespace detail
+    //! @endcond
+
+    //============================================================================//
+    //! @defgroup batch_rounding Bulk Rounding Operations.
+    //! round each value in [first, last), and write the results to the range beginning at `out'.
+    //! each result is the result of the scalar function converted to U. i.e. static_cast<U>(round_simple(x)).
+    //! float and double arrays rounded to the same type, int32 or int64 use SSE4.1 / AVX2 kernels,
+    //! which give the same results as the scalar functions bit for bit.
+    //! `out' may be equal to `first' if T and U are the same type.
+    //! @return the end of the output range.
+    //! @{
+    //============================================================================//
+
+    //! @brief bulk version of round_simple.
+    template<typename T, typename U>
+    U *     round_simple            (T const *first, T const *last, U *out)
+    {
+        return detail::round_batch<detail::round_simple_op>(first, last, out);
+    }
+
+    //! @brief bulk version of round_to_nearest_even.
+    template<typename T, typename U>
+    U *     round_to_nearest_even   (T const *first, T const *last, U *out)
+    {
+        return detail::round_batch<detail::round_to_nearest_even_op>(first, last, out);
+    }
+
+    //! @brief bulk version of round_simple for arrays.
+    template<typename T, typename U, std::size_t N>
+    U *     round_simple            (T const (&in)[N], U (&out)[N])
+    {
+        return round_simple(in, in + N, out);
+    }
+
+    //! @brief bulk version of round_to_nearest_even for arrays.
+    template<typename T, typename U, std::size_t N>
+    U *     round_to_nearest_even   (T const (&in)[N], U (&out)[N])
+    {
+        return round_to_nearest_even(in, in + N, out);
+    }
+
+    //============================================================================//
+    //! @}
+    //  enddef of batch_rounding
+    //============================================================================//
+
+    //! @cond DETAIL
+    namespace detail
+    {
+        //  saturating operations.
+        //  each op has the scalar function and, for the types listed in has_simd, the SSE4.1 / AVX2 instructions.
+        //  the last parameter of the SIMD functions selects the element type.
+
+        struct add_sat_op
+        {
+            template<typename T>
+            static T    apply   (T const &x, T const &y) { return add_sat(x, y); }
+
+            template<typename T> struct has_simd { static bool const value = false; };
+
+#if defined HWM_ARITHMETIC_SIMD_X86
+            HWM_ARITHMETIC_TARGET_SSE41 static __m128i  sse41   (__m128i x, __m128i y, boost::int8_t)   { return _mm_adds_epi8(x, y); }
+            HWM_ARITHMETIC_TARGET_SSE41 static __m128i  sse41   (__m128i x, __m128i y, boost::int16_t)  { return _mm_adds_epi16(x, y); }
+            HWM_ARITHMETIC_TARGET_SSE41 static __m128i  sse41   (__m128i x, __m128i y, boost::uint8_t)  { return _mm_adds_epu8(x, y); }
+            HWM_ARITHMETIC_TARGET_SSE41 static __m128i  sse41   (__m128i x, __m128i y, boost::uint16_t) { return _mm_adds_epu16(x, y); }
+            HWM_ARITHMETIC_TARGET_AVX2  static __m256i  avx2    (__m256i x, __m256i y, boost::int8_t)   { return _mm256_adds_epi8(x, y); }
+            HWM_ARITHMETIC_TARGET_AVX2  static __m256i  avx2    (__m256i x, __m256i y, boost::int16_t)  { return _mm256_adds_epi16(x, y); }
+            HWM_ARITHMETIC_TARGET_AVX2  static __m256i  avx2    (__m256i x, __m256i y, boost::uint8_t)  { return _mm256_adds_epu8(x, y); }
+            HWM_ARITHMETIC_TARGET_AVX2  static __m256i  avx2    (__m256i x, __m256i y, boost::uint16_t) { return _mm256_adds_epu16(x, y); }
+#endif
+        };
+        template<> struct add_sat_op::has_simd<boost::int8_t>       { static bool const value = true; };
+        template<> struct add_sat_op::has_simd<boost::int16_t>      { static bool const value = true; };
+        template<> struct add_sat_op::has_simd<boost::uint8_t>      { static bool const value = true; };
+        template<> struct add_sat_op::has_simd<boost::uint16_t>     { static bool const value = true; };
+
+        struct sub_sat_op
+        {
+            template<typename T>
+            static T    apply   (T const &x, T const &y) { return sub_sat(x, y); }
+
+            template<typename T> struct has_simd { static bool const value = false; };
+
+#if defined HWM_ARITHMETIC_SIMD_X86
+            HWM_ARITHMETIC_TARGET_SSE41 static __m128i  sse41   (__m128i x, __m128i y, boost::int8_t)   { return _mm_subs_epi8(x, y); }
+            HWM_ARITHMETIC_TARGET_SSE41 static __m128i  sse41   (__m128i x, __m128i y, boost::int16_t)  { return _mm_subs_epi16(x, y); }
+            HWM_ARITHMETIC_TARGET_SSE41 static __m128i  sse41   (__m128i x, __m128i y, boost::uint8_t)  { return _mm_subs_epu8(x, y); }
+            HWM_ARITHMETIC_TARGET_SSE41 static __m128i  sse41   (__m128i x, __m128i y, boost::uint16_t) { return _mm_subs_epu16(x, y); }
+            HWM_ARITHMETIC_TARGET_AVX2  static __m256i  avx2    (__m256i x, __m256i y, boost::int8_t)   { return _mm256_subs_epi8(x, y); }
+            HWM_ARITHMETIC_TARGET_AVX2  static __m256i  avx2    (__m256i x, __m256i y, boost::int16_t)  { return _mm256_subs_epi16(x, y); }
+            HWM_ARITHMETIC_TARGET_AVX2  static __m256i  avx2    (__m256i x, __m256i y, boost::uint8_t)  { return _mm256_subs_epu8(x, y); }
+            HWM_ARITHMETIC_TARGET_AVX2  static __m256i  avx2    (__m256i x, __m256i y, boost::uint16_t) { return _mm256_subs_epu16(x, y); }
+#endif
+        };
+        template<> struct sub_sat_op::has_simd<boost::int8_t>       { static bool const value = true; };
+        template<> struct sub_sat_op::has_simd<boost::int16_t>      { static bool const value = true; };
+        template<> struct sub_sat_op::has_simd<boost::uint8_t>      { static bool const value = true; };
+        template<> struct sub_sat_op::has_simd<boost::uint16_t>     { static bool const value = true; };
+
+        struct mul_sat_op
+        {
+            template<typename T>
+            static T    apply   (T const &x, T const &y) { return mul_sat(x, y); }
+
+            template<typename T> struct has_simd { static bool const value = false; };
+
+#if defined HWM_ARITHMETIC_SIMD_X86
+            //the 32-bit products are packed back to 16 bits with signed saturation.
+            HWM_ARITHMETIC_TARGET_SSE41
+            static __m128i  sse41   (__m128i x, __m128i y, boost::int16_t)
+            {
+                __m128i const lo = _mm_mullo_epi16(x, y);
+                __m128i const hi = _mm_mulhi_epi16(x, y);
+                return _mm_packs_epi32(_mm_unpacklo_epi16(lo, hi), _mm_unpackhi_epi16(lo, hi));
+            }
+
+            //unpack and pack work within each 128-bit lane, so the order is kept.
+            HWM_ARITHMETIC_TARGET_AVX2
+            static __m256i  avx2    (__m256i x, __m256i y, boost::int16_t)
+            {
+                __m256i const lo = _mm256_mullo_epi16(x, y);
+                __m256i const hi = _mm256_mulhi_epi16(x, y);
+                return _mm256_packs_epi32(_mm256_unpacklo_epi16(lo, hi), _mm256_unpackhi_epi16(lo, hi));
+            }
+#endif
+        };
+        template<> struct mul_sat_op::has_simd<boost::int16_t>      { static bool const value = true; };
+
+        struct abs_sat_op
+        {
+            template<typename T>
+            static T    apply   (T const &x) { return abs_sat(x); }
+
+            template<typename T> struct has_simd { static bool const value = false; };
+
+#if defined HWM_ARITHMETIC_SIMD_X86
+            //pabs leaves min as it is. it is 2^(bits-1) as unsigned, so the unsigned minimum with max clamps it.
+            HWM_ARITHMETIC_TARGET_SSE41 static __m128i  sse41   (__m128i x, boost::int8_t)  { return _mm_min_epu8(_mm_abs_epi8(x), _mm_set1_epi8(0x7F)); }
+            HWM_ARITHMETIC_TARGET_SSE41 static __m128i  sse41   (__m128i x, boost::int16_t) { return _mm_min_epu16(_mm_abs_epi16(x), _mm_set1_epi16(0x7FFF)); }
+            HWM_ARITHMETIC_TARGET_SSE41 static __m128i  sse41   (__m128i x, boost::int32_t) { return _mm_min_epu32(_mm_abs_epi32(x), _mm_set1_epi32(0x7FFFFFFF)); }
+            HWM_ARITHMETIC_TARGET_AVX2  static __m256i  avx2    (__m256i x, boost::int8_t)  { return _mm256_min_epu8(_mm256_abs_epi8(x), _mm256_set1_epi8(0x7F)); }
+            HWM_ARITHMETIC_TARGET_AVX2  static __m256i  avx2    (__m256i x, boost::int16_t) { return _mm256_min_epu16(_mm256_abs_epi16(x), _mm256_set1_epi16(0x7FFF)); }
+            HWM_ARITHMETIC_TARGET_AVX2  static __m256i  avx2    (__m256i x, boost::int32_t) { return _mm256_min_epu32(_mm256_abs_epi32(x), _mm256_set1_epi32(0x7FFFFFFF)); }
+#endif
+        };
+        template<> struct abs_sat_op::has_simd<boost::int8_t>       { static bool const value = true; };
+        template<> struct abs_sat_op::has_simd<boost::int16_t>      { static bool const value = true; };
+        template<> struct abs_sat_op::has_simd<boost::int32_t>      { static bool const value = true; };
+
+        template<typename Op, typename T>
+        T * saturate_scalar (T const *first1, T const *last1, T const *first2, T *out)
+        {
+            for( ; first1 != last1; ++first1, ++first2, ++out) {
+                *out = Op::apply(*first1, *first2);
+            }
+            return out;
+        }
+
+        template<typename Op, typename T>
+        T * saturate_scalar (T const *first, T const *last, T *out)
+        {
+            for( ; first != last; ++first, ++out) {
+                *out = Op::apply(*first);
+            }
+            return out;
+        }
+
+#if defined HWM_ARITHMETIC_SIMD_X86
+        template<typename Op, typename T>
+        HWM_ARITHMETIC_TARGET_SSE41
+        T * saturate_sse41  (T const *first1, T const *last1, T const *first2, T *out)
+        {
+            std::ptrdiff_t const lanes = 16 / sizeof(T);
+            for( ; last1 - first1 >= lanes; first1 += lanes, first2 += lanes, out += lanes) {
+                __m128i const x = _mm_loadu_si128(reinterpret_cast<__m128i const *>(first1));
+                __m128i const y = _mm_loadu_si128(reinterpret_cast<__m128i const *>(first2));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out), Op::sse41(x, y, T()));
+            }
+            return saturate_scalar<Op>(first1, last1, first2, out);
+        }
+
+        template<typename Op, typename T>
+        HWM_ARITHMETIC_TARGET_SSE41
+        T * saturate_sse41  (T const *first, T const *last, T *out)
+        {
+            std::ptrdiff_t const lanes = 16 / sizeof(T);
+            for( ; last - first >= lanes; first += lanes, out += lanes) {
+                __m128i const x = _mm_loadu_si128(reinterpret_cast<__m128i const *>(first));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out), Op::sse41(x, T()));
+            }
+            return saturate_scalar<Op>(first, last, out);
+        }
+
+        template<typename Op, typename T>
+        HWM_ARITHMETIC_TARGET_AVX2
+        T * saturate_avx2   (T const *first1, T const *last1, T const *first2, T *out)
+        {
+            std::ptrdiff_t const lanes = 32 / sizeof(T);
+            for( ; last1 - first1 >= lanes; first1 += lanes, first2 += lanes, out += lanes) {
+                __m256i const x = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(first1));
+                __m256i const y = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(first2));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), Op::avx2(x, y, T()));
+            }
+            return saturate_scalar<Op>(first1, last1, first2, out);
+        }
+
+        template<typename Op, typename T>
+        HWM_ARITHMETIC_TARGET_AVX2
+        T * saturate_avx2   (T const *first, T const *last, T *out)
+        {
+            std::ptrdiff_t const lanes = 32 / sizeof(T);
+            for( ; last - first >= lanes; first += lanes, out += lanes) {
+                __m256i const x = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(first));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), Op::avx2(x, T()));
+            }
+            return saturate_scalar<Op>(first, last, out);
+        }
+#endif  //HWM_ARITHMETIC_SIMD_X86
+
+        template<typename Op, typename T>
+        T * saturate_batch  (
+                T const *first1, T const *last1, T const *first2, T *out,
+                typename boost::disable_if_c<Op::template has_simd<T>::value>::type* = 0 )
+        {
+            return saturate_scalar<Op>(first1, last1, first2, out);
+        }
+
+        template<typename Op, typename T>
+        T * saturate_batch  (
+                T const *first1, T const *last1, T const *first2, T *out,
+                typename boost::enable_if_c<Op::template has_simd<T>::value>::type* = 0 )
+        {
+#if defined HWM_ARITHMETIC_SIMD_X86
+            switch(current_simd_level()) {
+            case simd_avx2:     return saturate_avx2<Op>(first1, last1, first2, out);
+            case simd_sse41:    return saturate_sse41<Op>(first1, last1, first2, out);
+            default:            break;
+            }
+#endif
+            return saturate_scalar<Op>(first1, last1, first2, out);
+        }
+
+        template<typename Op, typename T>
+        T * saturate_batch  (
+                T const *first, T const *last, T *out,
+                typename boost::disable_if_c<Op::template has_simd<T>::value>::type* = 0 )
+        {
+            return saturate_scalar<Op>(first, last, out);
+        }
+
+        template<typename Op, typename T>
+        T * saturate_batch  (
+                T const *first, T const *last, T *out,
+                typename boost::enable_if_c<Op::template has_simd<T>::value>::type* = 0 )
+        {
+#if defined HWM_ARITHMETIC_SIMD_X86
+            switch(current_simd_level()) {
+            case simd_avx2:     return saturate_avx2<Op>(first, last, out);
+            case simd_sse41:    return saturate_sse41<Op>(first, last, out);
+            default:            break;
+            }
+#endif
+            return saturate_scalar<Op>(first, last, out);
+        }
+    }   //namespace detail
+    //! @endcond
+
+    //============================================================================//
+    //! @defgroup batch_saturation Bulk Saturating Operations.
+    //! apply a saturating operation to each element of [first1, last1) and the corresponding element
+    //! of the range beginning at `first2', and write the results to the range beginning at `out'.
+    //! the results are the same as the scalar function of the same name.
+    //! add_sat / sub_sat of int8, int16, uint8 and uint16, mul_sat of int16, and abs_sat of int8, int16 and int32
+    //! use SSE4.1 / AVX2 kernels.
+    //! `out' may be equal to `first1' or `first2'.
+    //! @return the end of the output range.
+    //! @{
+    //============================================================================//
+
+    //! @brief bulk version of add_sat.
+    template<typename T>
+    T *     add_sat                 (T const *first1, T const *last1, T const *first2, T *out)
+    {
+        return detail::saturate_batch<detail::add_sat_op>(first1, last1, first2, out);
+    }
+
+    //! @brief bulk version of sub_sat.
+    template<typename T>
+    T *     sub_sat                 (T const *first1, T const *last1, T const *first2, T *out)
+    {
+        return detail::saturate_batch<detail::sub_sat_op>(first1, last1, first2, out);
+    }
+
+    //! @brief bulk version of mul_sat.
+    template<typename T>
+    T *     mul_sat                 (T const *first1, T const *last1, T const *first2, T *out)
+    {
+        return detail::saturate_batch<detail::mul_sat_op>(first1, last1, first2, out);
+    }
+
+    //! @brief bulk version of abs_sat.
+    template<typename T>
+    T *     abs_sat                 (T const *first, T const *last, T *out)
+    {
+        return detail::saturate_batch<detail::abs_sat_op>(first, last, out);
+    }
+
+    //! @brief bulk version of add_sat for arrays.
+    template<typename T, std::size_t N>
+    T *     add_sat                 (T const (&x)[N], T const (&y)[N], T (&out)[N])
+    {
+        return add_sat(x, x + N, y, out);
+    }
+
+    //! @brief bulk version of sub_sat for arrays.
+    template<typename T, std::size_t N>
+    T *     sub_sat                 (T const (&x)[N], T const (&y)[N], T (&out)[N])
+    {
+        return sub_sat(x, x + N, y, out);
+    }
+
+    //! @brief bulk version of mul_sat for arrays.
+    template<typename T, std::size_t N>
+    T *     mul_sat                 (T const (&x)[N], T const (&y)[N], T (&out)[N])
+    {
+        return mul_sat(x, x + N, y, out);
+    }
+
+    //! @brief bulk version of abs_sat for arrays.
+    template<typename T, std::size_t N>
+    T *     abs_sat                 (T const (&in)[N], T (&out)[N])
+    {
+        return abs_sat(in, in + N, out);
+    }
+
+    //============================================================================//
+    //! @}
+    //  enddef of batch_saturation
+    //============================================================================//
+
+}}  //namespace hwm::arithmetic
+
+#endif  //HWM_ARITHMETIC_BATCH_HPP
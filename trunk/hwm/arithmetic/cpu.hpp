@@ -0,0 +1,128 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef HWM_ARITHMETIC_CPU_HPP
+#define HWM_ARITHMETIC_CPU_HPP
+
+//! hwm.Arithmetic
+//! runtime detection of the instruction sets used by the bulk operations.
+//! @file
+
+#include <boost/config.hpp>
+
+//default
+//use SSE4.1 / AVX2 kernels on x86 and x64 if the running cpu supports them.
+
+//definition
+//HWM_ARITHMETIC_SIMD_DISABLED      //<= never use SIMD kernels. always use the scalar code.
+
+#if !defined HWM_ARITHMETIC_SIMD_DISABLED
+    #if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+        #define HWM_ARITHMETIC_SIMD_X86
+    #endif
+#endif
+
+#if defined HWM_ARITHMETIC_SIMD_X86
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+        #define HWM_ARITHMETIC_TARGET_SSE41
+        #define HWM_ARITHMETIC_TARGET_AVX2
+        #define HWM_ARITHMETIC_TARGET_POPCNT
+    #else
+        #define HWM_ARITHMETIC_TARGET_SSE41 __attribute__((target("sse4.1")))
+        #define HWM_ARITHMETIC_TARGET_AVX2  __attribute__((target("avx2")))
+        //every cpu with AVX2 has POPCNT, so the code for simd_avx2 may use it.
+        #define HWM_ARITHMETIC_TARGET_POPCNT __attribute__((target("popcnt")))
+    #endif
+    #include <immintrin.h>
+#endif
+
+namespace hwm { namespace arithmetic {
+
+    //! @brief instruction set levels that the bulk operations can use.
+    //! a level implies all the levels less than it.
+    enum simd_level
+    {
+        simd_none,
+        simd_sse41,
+        simd_avx2
+    };
+
+    //! @cond DETAIL
+    namespace detail
+    {
+        inline
+        simd_level  query_simd_level    ()
+        {
+#if defined HWM_ARITHMETIC_SIMD_X86
+    #if defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 0);
+            int const max_leaf = info[0];
+            if(max_leaf < 1) { return simd_none; }
+
+            __cpuid(info, 1);
+            bool const has_sse41    = (info[2] & (1 << 19)) != 0;
+            bool const has_osxsave  = (info[2] & (1 << 27)) != 0;
+            bool const has_avx      = (info[2] & (1 << 28)) != 0;
+            if(!has_sse41) { return simd_none; }
+            if(!has_osxsave || !has_avx || max_leaf < 7) { return simd_sse41; }
+
+            //OS must save the ymm registers.
+            if((_xgetbv(0) & 0x6) != 0x6) { return simd_sse41; }
+
+            __cpuidex(info, 7, 0);
+            bool const has_avx2     = (info[1] & (1 << 5)) != 0;
+            return has_avx2 ? simd_avx2 : simd_sse41;
+    #else
+            __builtin_cpu_init();
+            if(__builtin_cpu_supports("avx2"))      { return simd_avx2; }
+            if(__builtin_cpu_supports("sse4.1"))    { return simd_sse41; }
+            return simd_none;
+    #endif
+#else
+            return simd_none;
+#endif
+        }
+
+        inline
+        simd_level &    simd_level_limit    ()
+        {
+            static simd_level limit = simd_avx2;
+            return limit;
+        }
+    }   //namespace detail
+    //! @endcond
+
+    //! @return the highest instruction set level that the running cpu supports.
+    //! the cpu is queried only once.
+    inline
+    simd_level  detected_simd_level     ()
+    {
+        static simd_level const level = detail::query_simd_level();
+        return level;
+    }
+
+    //! @return the instruction set level that the bulk operations use.
+    inline
+    simd_level  current_simd_level      ()
+    {
+        simd_level const detected   = detected_simd_level();
+        simd_level const limit      = detail::simd_level_limit();
+        return (limit < detected) ? limit : detected;
+    }
+
+    //! @brief restrict the instruction set level that the bulk operations use.
+    //! this is intended for testing and benchmarking each kernel.
+    //! @note not thread safe. call it while no bulk operation is running.
+    inline
+    void        limit_simd_level        (simd_level level)
+    {
+        detail::simd_level_limit() = level;
+    }
+
+}}  //namespace hwm::arithmetic
+
+#endif  //HWM_ARITHMETIC_CPU_HPP
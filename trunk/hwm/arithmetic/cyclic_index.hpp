@@ -0,0 +1,171 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef HWM_ARITHMETIC_CYCLIC_INDEX_HPP
+#define HWM_ARITHMETIC_CYCLIC_INDEX_HPP
+
+//! hwm.Arithmetic
+//! an index that wraps around a modulus, stepped without division.
+//! e.g. the walk of a ring buffer
+//!     for(i = start; ; i += step) { buffer[mod_floored(i, n)]; }
+//! is
+//!     cyclic_index<int> c(n, start, step);
+//!     for( ; ; ++c) { buffer[c.value()]; }
+//! where each step is an addition and a compare-and-subtract.
+//! @file
+
+#include <boost/assert.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/is_integral.hpp>
+#include <boost/type_traits/is_signed.hpp>
+#include <boost/type_traits/make_unsigned.hpp>
+
+#include "../arithmetic.hpp"
+#include "./divisor.hpp"
+
+namespace hwm { namespace arithmetic {
+
+    //! @brief the remainder of a position that moves by a fixed step, divided by a fixed modulus.
+    //! the position is i + k * step after k increments from the start i,
+    //! and value() is always equal to mod_floored(position, modulus), and euclidean_value() to mod_euclidean.
+    //! (the position is the exact value, which may be out of the range of T.)
+    //! advance() and seek() do one division, and the constructor does three. the other operations do none.
+    //! @tparam T must be an integral type.
+    template<typename T>
+    class cyclic_index
+    {
+        BOOST_STATIC_ASSERT(boost::is_integral<T>::value);
+        typedef typename boost::make_unsigned<T>::type  unsigned_type;
+
+    public:
+        typedef T   value_type;
+
+        //! @brief start at `start', and move by `step'.
+        //! n must not be zero.
+        explicit
+        cyclic_index    (T const &n, T const &start = 0, T const &step = 1)
+            :   n_          (n)
+            ,   m_          (magnitude(n))
+            ,   r_          (reduce(start, n))
+            ,   s_          (reduce(step, n))
+            ,   back_       (static_cast<unsigned_type>(m_ - s_))
+            ,   step_       (step)
+            ,   q_          (floor_quotient(step, m_, s_))
+        {
+            BOOST_ASSERT(n != 0);
+        }
+
+        //! @return the modulus.
+        T       modulus         () const { return n_; }
+
+        //! @return the step.
+        T       step            () const { return step_; }
+
+        //! @return mod_floored(position, modulus). the sign is the sign of the modulus.
+        T       value           () const
+        {
+            //the negative modulus has the results in (n, 0].
+            unsigned_type const shift = static_cast<unsigned_type>(-static_cast<unsigned_type>((n_ < 0) & (r_ != 0)) & m_);
+            return static_cast<T>(r_ - shift);
+        }
+
+        //! @return mod_euclidean(position, modulus). never negative.
+        T       euclidean_value () const { return static_cast<T>(r_); }
+
+        //! @brief move forward by the step.
+        //! @return the number of times the index wrapped around,
+        //! i.e. div_floored(position, |modulus|) after the step minus the one before.
+        //! an index of an outer dimension may be advanced by it.
+        T       increment       ()
+        {
+            bool const wrap = r_ >= back_;
+            r_ = static_cast<unsigned_type>(wrap ? r_ - back_ : r_ + s_);
+            return static_cast<T>(static_cast<unsigned_type>(q_) + static_cast<unsigned_type>(wrap));
+        }
+
+        //! @brief move backward by the step.
+        //! @return the number of times the index wrapped around backward,
+        //! i.e. div_floored(position, |modulus|) before the step minus the one after.
+        T       decrement       ()
+        {
+            bool const wrap = r_ < s_;
+            r_ = static_cast<unsigned_type>(wrap ? r_ + back_ : r_ - s_);
+            return static_cast<T>(static_cast<unsigned_type>(q_) + static_cast<unsigned_type>(wrap));
+        }
+
+        cyclic_index &  operator++  ()      { increment(); return *this; }
+        cyclic_index &  operator--  ()      { decrement(); return *this; }
+        cyclic_index    operator++  (int)   { cyclic_index tmp(*this); increment(); return tmp; }
+        cyclic_index    operator--  (int)   { cyclic_index tmp(*this); decrement(); return tmp; }
+
+        //! @brief move by `count' steps, with one division.
+        //! `count' may be negative for a signed T.
+        cyclic_index &  advance     (T const &count)
+        {
+            unsigned_type const k = magnitude(count);
+            //k * s_ < 2^bits * m_, so the upper half is less than m_.
+            unsigned_type const hi = detail::mulhi(k, s_);
+            unsigned_type const lo = static_cast<unsigned_type>(k * s_);
+            unsigned_type d;
+            detail::wide_multiply<sizeof(T)>::divide(hi, lo, m_, d);
+            if(count < 0) {
+                r_ = static_cast<unsigned_type>((r_ < d) ? r_ + (m_ - d) : r_ - d);
+            } else {
+                r_ = static_cast<unsigned_type>((r_ >= m_ - d) ? r_ - (m_ - d) : r_ + d);
+            }
+            return *this;
+        }
+
+        cyclic_index &  operator+=  (T const &count) { return advance(count); }
+
+        //! @brief move to the position `i', with one division. the step is unchanged.
+        cyclic_index &  seek        (T const &i)
+        {
+            r_ = reduce(i, n_);
+            return *this;
+        }
+
+        friend bool operator==  (cyclic_index const &x, cyclic_index const &y)
+        {
+            return x.n_ == y.n_ && x.r_ == y.r_;
+        }
+
+        friend bool operator!=  (cyclic_index const &x, cyclic_index const &y) { return !(x == y); }
+
+    private:
+        //! |x|. also correct for the minimum value of a signed type.
+        static unsigned_type    magnitude       (T const x)
+        {
+            return (x < 0) ? static_cast<unsigned_type>(0 - static_cast<unsigned_type>(x)) : static_cast<unsigned_type>(x);
+        }
+
+        //! floor(x / m) from the remainder r, without the overflow of div_floored(min, -1).
+        //! x - r is a multiple of m, and |x| + r does not overflow, because r < m <= 2^(bits - 1) for a negative x.
+        static T                floor_quotient  (T const x, unsigned_type const m, unsigned_type const r)
+        {
+            return (x < 0)
+                ?   static_cast<T>(0 - static_cast<unsigned_type>((magnitude(x) + r) / m))
+                :   static_cast<T>((static_cast<unsigned_type>(x) - r) / m);
+        }
+
+        //! mod_euclidean(x, n) in [0, |n|).
+        //! the result of the minimum value of a signed type as the modulus wraps around in T, but not in unsigned_type.
+        static unsigned_type    reduce          (T const x, T const n)
+        {
+            return static_cast<unsigned_type>(mod_euclidean(x, n));
+        }
+
+        T               n_;
+        unsigned_type   m_;     //|n|
+        unsigned_type   r_;     //mod_euclidean(position, n)
+        unsigned_type   s_;     //mod_euclidean(step, n)
+        unsigned_type   back_;  //m_ - s_
+        T               step_;
+        T               q_;     //div_floored(step, |n|)
+    };
+
+}}  //namespace hwm::arithmetic
+
+#endif  //HWM_ARITHMETIC_CYCLIC_INDEX_HPP
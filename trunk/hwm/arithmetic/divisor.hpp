@@ -0,0 +1,369 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef HWM_ARITHMETIC_DIVISOR_HPP
+#define HWM_ARITHMETIC_DIVISOR_HPP
+
+//! hwm.Arithmetic
+//! division by an invariant integer using multiplication.
+//! <a href="http://gmplib.org/~tege/divcnst-pldi94.pdf">see also</a>
+//! @file
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/is_integral.hpp>
+#include <boost/type_traits/is_signed.hpp>
+#include <boost/type_traits/make_unsigned.hpp>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    #include <intrin.h>
+#endif
+
+#include "../arithmetic.hpp"
+
+namespace hwm { namespace arithmetic {
+
+    //! @cond DETAIL
+    namespace detail
+    {
+        //! the upper half of the product of two unsigned integers.
+        template<std::size_t Size>
+        struct wide_multiply
+        {
+            BOOST_STATIC_ASSERT(Size <= 4);
+
+            template<typename U>
+            static U    mulhi   (U const x, U const y)
+            {
+                return static_cast<U>(
+                    (static_cast<boost::uint64_t>(x) * static_cast<boost::uint64_t>(y)) >> (Size * 8) );
+            }
+
+            //! divide (hi * 2^bits + lo) by d. hi must be less than d.
+            template<typename U>
+            static U    divide  (U const hi, U const lo, U const d, U &rem)
+            {
+                BOOST_ASSERT(hi < d);
+                boost::uint64_t const n =
+                    (static_cast<boost::uint64_t>(hi) << (Size * 8)) | static_cast<boost::uint64_t>(lo);
+                rem = static_cast<U>(n % d);
+                return static_cast<U>(n / d);
+            }
+        };
+
+        template<>
+        struct wide_multiply<8>
+        {
+            template<typename U>
+            static U    mulhi   (U const x, U const y)
+            {
+#if defined(BOOST_HAS_INT128)
+                return static_cast<U>(
+                    (static_cast<boost::uint128_type>(x) * static_cast<boost::uint128_type>(y)) >> 64 );
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+                return static_cast<U>(__umulh(x, y));
+#else
+                boost::uint64_t const mask  = 0xFFFFFFFFu;
+                boost::uint64_t const x_lo  = x & mask;
+                boost::uint64_t const x_hi  = x >> 32;
+                boost::uint64_t const y_lo  = y & mask;
+                boost::uint64_t const y_hi  = y >> 32;
+
+                boost::uint64_t const lo_lo = x_lo * y_lo;
+                boost::uint64_t const hi_lo = x_hi * y_lo;
+                boost::uint64_t const lo_hi = x_lo * y_hi;
+                boost::uint64_t const hi_hi = x_hi * y_hi;
+
+                boost::uint64_t const cross = (lo_lo >> 32) + (hi_lo & mask) + lo_hi;
+                return static_cast<U>(hi_hi + (hi_lo >> 32) + (cross >> 32));
+#endif
+            }
+
+            template<typename U>
+            static U    divide  (U const hi, U const lo, U const d, U &rem)
+            {
+                boost::uint64_t r;
+                U const q = static_cast<U>(divide_wide(hi, lo, d, r));
+                rem = static_cast<U>(r);
+                return q;
+            }
+        };
+
+        template<typename U>
+        U       mulhi           (U const x, U const y)
+        {
+            return wide_multiply<sizeof(U)>::mulhi(x, y);
+        }
+
+        //! signed version of mulhi, computed from the unsigned one.
+        template<typename S>
+        S       mulhi_signed    (S const x, S const y)
+        {
+            typedef typename boost::make_unsigned<S>::type U;
+            U const x_mask = static_cast<U>(0) - static_cast<U>(x < 0);
+            U const y_mask = static_cast<U>(0) - static_cast<U>(y < 0);
+            U const hi = mulhi(static_cast<U>(x), static_cast<U>(y));
+            return static_cast<S>(hi - (x_mask & static_cast<U>(y)) - (y_mask & static_cast<U>(x)));
+        }
+
+        //! multiplication modulo 2^bits.
+        //! (unsigned types smaller than int are promoted to int, and the product could overflow.)
+        template<typename U>
+        U       mul_wrap        (U const x, U const y)
+        {
+            return static_cast<U>((x + 0u) * (y + 0u));
+        }
+
+        template<typename U>
+        int     floor_log2      (U x)
+        {
+            int n = -1;
+            for( ; x != 0; x = static_cast<U>(x >> 1)) { ++n; }
+            return n;
+        }
+
+        template<typename T, bool IsSigned = boost::is_signed<T>::value>
+        class divisor_impl;
+
+        //  unsigned division.
+        //  q = (t + ((n - t) >> shift1)) >> shift2, where t = mulhi(magic, n).
+        //  magic and the shifts are chosen so that it is equal to floor(n / d) for every n.
+        template<typename T>
+        class divisor_impl<T, false>
+        {
+        public:
+            typedef T   value_type;
+
+            explicit
+            divisor_impl    (T const d)
+                :   d_      (d)
+                ,   magic_  (0)
+                ,   shift1_ (0)
+                ,   shift2_ (0)
+            {
+                BOOST_ASSERT(d != 0);
+                if(d == 1) { return; }
+
+                int const bits  = sizeof(T) * 8;
+                int const l     = floor_log2(static_cast<T>(d - 1)) + 1;    //ceil(log2(d))
+                T const hi      = (l == bits) ? static_cast<T>(0 - d) : static_cast<T>((static_cast<T>(1) << l) - d);
+                T rem;
+                magic_  = static_cast<T>(wide_multiply<sizeof(T)>::divide(hi, static_cast<T>(0), d, rem) + 1);
+                shift1_ = 1;
+                shift2_ = l - 1;
+            }
+
+            T   value           () const { return d_; }
+
+            T   div_truncated   (T const n) const
+            {
+                T const t = mulhi(magic_, n);
+                return static_cast<T>(static_cast<T>(t + static_cast<T>(static_cast<T>(n - t) >> shift1_)) >> shift2_);
+            }
+
+            T   mod_truncated   (T const n) const { return static_cast<T>(n - div_truncated(n) * d_); }
+
+            //! floored and Euclidean division are equal to truncated division for unsigned value.
+            T   div_floored     (T const n) const { return div_truncated(n); }
+            T   mod_floored     (T const n) const { return mod_truncated(n); }
+            T   div_euclidean   (T const n) const { return div_truncated(n); }
+            T   mod_euclidean   (T const n) const { return mod_truncated(n); }
+
+        private:
+            T   d_;
+            T   magic_;
+            int shift1_;
+            int shift2_;
+        };
+
+        //  signed division.
+        //  the magic number is computed for abs(d) with one extra bit, which is restored by adding n.
+        //  q = (mulhi(magic, n) + n + round) >> shift, where `round' is added only when the result is negative.
+        //  then the sign of d is applied.
+        template<typename T>
+        class divisor_impl<T, true>
+        {
+            typedef typename boost::make_unsigned<T>::type  unsigned_type;
+
+        public:
+            typedef T   value_type;
+
+            explicit
+            divisor_impl    (T const d)
+                :   d_      (d)
+                ,   magic_  (0)
+                ,   shift_  (0)
+                ,   round_  (0)
+                ,   negative_(static_cast<unsigned_type>(0) - static_cast<unsigned_type>(d < 0))
+                ,   sign_   (d < 0 ? -1 : 1)
+                ,   abs_    (static_cast<T>(d < 0 ? static_cast<unsigned_type>(0) - static_cast<unsigned_type>(d) : static_cast<unsigned_type>(d)))
+            {
+                BOOST_ASSERT(d != 0);
+                unsigned_type const abs_d = static_cast<unsigned_type>(abs_);
+                int const fl = floor_log2(abs_d);
+                shift_ = fl;
+
+                if((abs_d & (abs_d - 1)) == 0) {
+                    round_ = static_cast<unsigned_type>((static_cast<unsigned_type>(1) << fl) - 1);
+                    return;
+                }
+
+                unsigned_type rem;
+                unsigned_type m =
+                    wide_multiply<sizeof(T)>::divide(
+                        static_cast<unsigned_type>(static_cast<unsigned_type>(1) << (fl - 1)),
+                        static_cast<unsigned_type>(0), abs_d, rem );
+                unsigned_type const twice_rem = static_cast<unsigned_type>(rem + rem);
+                m = static_cast<unsigned_type>(m + m);
+                if(twice_rem >= abs_d || twice_rem < rem) { m = static_cast<unsigned_type>(m + 1); }
+                magic_ = static_cast<unsigned_type>(m + 1);
+                round_ = static_cast<unsigned_type>(static_cast<unsigned_type>(1) << fl);
+            }
+
+            T   value           () const { return d_; }
+
+            T   div_truncated   (T const n) const
+            {
+                unsigned_type q =
+                    static_cast<unsigned_type>(
+                        static_cast<unsigned_type>(mulhi_signed(static_cast<T>(magic_), n)) +
+                        static_cast<unsigned_type>(n) );
+                q = static_cast<unsigned_type>(q + (sign_mask(q) & round_));
+                q = static_cast<unsigned_type>(static_cast<T>(q) >> shift_);
+                return static_cast<T>(static_cast<unsigned_type>(q ^ negative_) - negative_);
+            }
+
+            T   mod_truncated   (T const n) const { return remainder(n, div_truncated(n)); }
+
+            T   div_floored     (T const n) const
+            {
+                T const q = div_truncated(n);
+                unsigned_type const adjust = floored_adjustment(n, q);
+                return static_cast<T>(static_cast<unsigned_type>(q) + adjust);
+            }
+
+            T   mod_floored     (T const n) const
+            {
+                T const q = div_truncated(n);
+                T const r = remainder(n, q);
+                unsigned_type const adjust = floored_adjustment(n, q);
+                return static_cast<T>(static_cast<unsigned_type>(r) + (adjust & static_cast<unsigned_type>(d_)));
+            }
+
+            T   div_euclidean   (T const n) const
+            {
+                T const q = div_truncated(n);
+                unsigned_type const adjust = sign_mask(static_cast<unsigned_type>(remainder(n, q)));
+                return static_cast<T>(static_cast<unsigned_type>(q) - (adjust & static_cast<unsigned_type>(sign_)));
+            }
+
+            T   mod_euclidean   (T const n) const
+            {
+                T const r = remainder(n, div_truncated(n));
+                unsigned_type const adjust = sign_mask(static_cast<unsigned_type>(r));
+                return static_cast<T>(static_cast<unsigned_type>(r) + (adjust & static_cast<unsigned_type>(abs_)));
+            }
+
+        private:
+            static
+            unsigned_type   sign_mask   (unsigned_type const x)
+            {
+                return static_cast<unsigned_type>(static_cast<T>(x) >> (sizeof(T) * 8 - 1));
+            }
+
+            T   remainder       (T const n, T const q) const
+            {
+                return static_cast<T>(
+                    static_cast<unsigned_type>(n) -
+                    mul_wrap(static_cast<unsigned_type>(q), static_cast<unsigned_type>(d_)) );
+            }
+
+            //! all bits set if the modulus is not zero and its sign differs from the divisor.
+            unsigned_type   floored_adjustment  (T const n, T const q) const
+            {
+                unsigned_type const r = static_cast<unsigned_type>(remainder(n, q));
+                return
+                    sign_mask(static_cast<unsigned_type>(r ^ static_cast<unsigned_type>(d_))) &
+                    (static_cast<unsigned_type>(0) - static_cast<unsigned_type>(r != 0));
+            }
+
+            T               d_;
+            unsigned_type   magic_;
+            int             shift_;
+            unsigned_type   round_;
+            unsigned_type   negative_;
+            T               sign_;
+            T               abs_;
+        };
+    }   //namespace detail
+    //! @endcond
+
+    //! @brief a precomputed divisor.
+    //! division by an invariant divisor is done with multiplication and shifts instead of the hardware division.
+    //! all operations return the same results as the free functions of the same name.
+    //! @tparam T must be an integral type.
+    template<typename T>
+    class divisor
+    {
+        BOOST_STATIC_ASSERT(boost::is_integral<T>::value);
+        typedef detail::divisor_impl<T> impl_type;
+
+    public:
+        typedef T   value_type;
+
+        //! @brief precompute the constants for `d'.
+        //! d must not be zero.
+        explicit
+        divisor                     (T const &d) : impl_(d) {}
+
+        //! @return the divisor.
+        T       value               () const { return impl_.value(); }
+
+        //! @return modulo by truncated division.
+        T       mod_truncated       (T const &dividend) const { return impl_.mod_truncated(dividend); }
+        //! @return modulo by floored division.
+        T       mod_floored         (T const &dividend) const { return impl_.mod_floored(dividend); }
+        //! @return modulo by Euclidean division.
+        T       mod_euclidean       (T const &dividend) const { return impl_.mod_euclidean(dividend); }
+        //! @return quotient by truncated division.
+        T       div_truncated       (T const &dividend) const { return impl_.div_truncated(dividend); }
+        //! @return quotient by floored division.
+        T       div_floored         (T const &dividend) const { return impl_.div_floored(dividend); }
+        //! @return quotient by Euclidean division.
+        T       div_euclidean       (T const &dividend) const { return impl_.div_euclidean(dividend); }
+
+    private:
+        impl_type   impl_;
+    };
+
+    //! @brief modulus operation by a precomputed divisor.
+    template<typename T>
+    T       mod_truncated           (T const &dividend, divisor<T> const &d) { return d.mod_truncated(dividend); }
+
+    //! @brief modulus operation by a precomputed divisor.
+    template<typename T>
+    T       mod_floored             (T const &dividend, divisor<T> const &d) { return d.mod_floored(dividend); }
+
+    //! @brief modulus operation by a precomputed divisor.
+    template<typename T>
+    T       mod_euclidean           (T const &dividend, divisor<T> const &d) { return d.mod_euclidean(dividend); }
+
+    //! @brief division operation by a precomputed divisor.
+    template<typename T>
+    T       div_truncated           (T const &dividend, divisor<T> const &d) { return d.div_truncated(dividend); }
+
+    //! @brief division operation by a precomputed divisor.
+    template<typename T>
+    T       div_floored             (T const &dividend, divisor<T> const &d) { return d.div_floored(dividend); }
+
+    //! @brief division operation by a precomputed divisor.
+    template<typename T>
+    T       div_euclidean           (T const &dividend, divisor<T> const &d) { return d.div_euclidean(dividend); }
+
+}}  //namespace hwm::arithmetic
+
+#endif  //HWM_ARITHMETIC_DIVISOR_HPP
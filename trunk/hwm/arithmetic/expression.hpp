@@ -0,0 +1,493 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef HWM_ARITHMETIC_EXPRESSION_HPP
+#define HWM_ARITHMETIC_EXPRESSION_HPP
+
+//! hwm.Arithmetic
+//! lazy expressions of the arithmetic functions, evaluated over an array in one pass.
+//! e.g.
+//!     namespace hae = hwm::arithmetic::expression;
+//!     hae::evaluate(first, last,
+//!         hae::mod_euclidean(hae::cast<int>(hae::round_to_nearest_even(hae::element * scale)) + offset, n),
+//!         out );
+//! the array is processed in blocks that fit in the L1 cache. each step of the expression runs over a whole block,
+//! by the bulk kernels of batch.hpp where there is one, so the intermediate values never leave the cache
+//! and no intermediate array is allocated.
+//! @file
+
+#include <cstddef>
+#include <boost/assert.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/is_arithmetic.hpp>
+#include <boost/type_traits/is_floating_point.hpp>
+#include <boost/type_traits/is_same.hpp>
+#include <boost/utility/enable_if.hpp>
+
+#include "../arithmetic.hpp"
+#include "./batch.hpp"
+#include "./divisor.hpp"
+
+namespace hwm { namespace arithmetic { namespace expression {
+
+    //! @cond DETAIL
+    namespace detail
+    {
+        namespace ad = hwm::arithmetic::detail;
+
+        //! the number of elements evaluated at a time.
+        //! each node of an expression has a buffer of this length on the stack.
+        enum { block_length = 256 };
+
+        struct plus_op          { template<typename T> static T apply(T const &x, T const &y) { return static_cast<T>(x + y); } };
+        struct minus_op         { template<typename T> static T apply(T const &x, T const &y) { return static_cast<T>(x - y); } };
+        struct multiplies_op    { template<typename T> static T apply(T const &x, T const &y) { return static_cast<T>(x * y); } };
+        struct divides_op       { template<typename T> static T apply(T const &x, T const &y) { return static_cast<T>(x / y); } };
+
+        //! unary operations. `block' applies the operation to a block, and `out' may be equal to `p'.
+        struct negate_op
+        {
+            template<typename T> static T apply(T const &x) { return static_cast<T>(-x); }
+
+            template<typename T>
+            static void block   (T const *p, std::size_t n, T *out)
+            {
+                for(std::size_t i = 0; i < n; ++i) { out[i] = static_cast<T>(-p[i]); }
+            }
+        };
+
+        struct abs_op
+        {
+            template<typename T> static T apply(T const &x) { return hwm::arithmetic::abs(x); }
+
+            template<typename T>
+            static void block   (T const *p, std::size_t n, T *out)
+            {
+                for(std::size_t i = 0; i < n; ++i) { out[i] = hwm::arithmetic::abs(p[i]); }
+            }
+        };
+
+        //! `Op' is round_simple_op or round_to_nearest_even_op of batch.hpp.
+        template<typename Op>
+        struct round_op
+        {
+            template<typename T> static T apply(T const &x) { return Op::apply(x); }
+
+            template<typename T>
+            static void block   (T const *p, std::size_t n, T *out)
+            {
+                ad::round_batch<Op>(p, p + n, out);
+            }
+        };
+
+        //! division of integral values by the bulk kernels of batch.hpp, and of floating point values by fmod_* / fdiv_*.
+        template<ad::division_kind Kind, bool Quotient, bool Floating>
+        struct divmod_element
+        {
+            template<typename T, typename D>
+            static T    apply   (T const &x, D const &d) { return ad::divmod_op<Kind, Quotient>::apply(x, d); }
+
+            template<typename T, typename D>
+            static void block   (T const *p, std::size_t n, D const &d, T *out)
+            {
+                ad::divmod_batch<Kind, Quotient>(p, p + n, d, out);
+            }
+        };
+
+        template<ad::division_kind Kind, bool Quotient>
+        struct divmod_element<Kind, Quotient, true>
+        {
+            template<typename T>
+            static T    apply   (T const &x, T const &d)
+            {
+                namespace har = hwm::arithmetic;
+                switch(Kind) {
+                case ad::truncated_division:    return Quotient ? har::fdiv_truncated(x, d) : har::fmod_truncated(x, d);
+                case ad::floored_division:      return Quotient ? har::fdiv_floored(x, d)   : har::fmod_floored(x, d);
+                default:                        return Quotient ? har::fdiv_euclidean(x, d) : har::fmod_euclidean(x, d);
+                }
+            }
+
+            template<typename T>
+            static void block   (T const *p, std::size_t n, T const &d, T *out)
+            {
+                for(std::size_t i = 0; i < n; ++i) { out[i] = apply(p[i], d); }
+            }
+        };
+
+        //! a divisor in an expression is either a value, converted to the type of the dividends, or a divisor<T>.
+        template<typename T, typename D>
+        typename boost::enable_if<boost::is_arithmetic<D>, T>::type
+                divisor_of  (D const &d) { return static_cast<T>(d); }
+
+        //! deduces the type of the divisor<>, so that divisor<T> is not instantiated for a floating point T.
+        template<typename T, typename U>
+        divisor<U> const &
+                divisor_of  (divisor<U> const &d)
+        {
+            BOOST_STATIC_ASSERT((boost::is_same<T, U>::value));
+            return d;
+        }
+    }   //namespace detail
+    //! @endcond
+
+    //============================================================================//
+    //! @defgroup expression_nodes Expressions.
+    //! an expression has
+    //!     result<T>::type                 the type of the value for an element of type T.
+    //!     operator()(x)                   the value for an element x.
+    //!     evaluate(x, n, buffer)          the values for n (<= block_length) elements at x,
+    //!                                     written to buffer or read from x. returns where the values are.
+    //! @{
+    //============================================================================//
+
+    //! @brief the base of the expressions.
+    template<typename Derived>
+    struct expression_base
+    {
+        Derived const & derived () const { return static_cast<Derived const &>(*this); }
+    };
+
+    //! @brief the element of the array.
+    struct placeholder
+        :   expression_base<placeholder>
+    {
+        template<typename T> struct result { typedef T type; };
+
+        template<typename T>
+        T           operator()  (T const &x) const { return x; }
+
+        template<typename T>
+        T const *   evaluate    (T const *x, std::size_t, T *) const { return x; }
+    };
+
+    //! @brief the element of the array. e.g. element * 2 + 1
+    placeholder const element = placeholder();
+
+    //! @brief an operation of two expressions of the same type.
+    template<typename Op, typename L, typename R>
+    struct binary
+        :   expression_base< binary<Op, L, R> >
+    {
+        template<typename T>
+        struct result
+        {
+            typedef typename L::template result<T>::type type;
+            BOOST_STATIC_ASSERT((boost::is_same<type, typename R::template result<T>::type>::value));
+        };
+
+        binary  (L const &l, R const &r) : left_(l), right_(r) {}
+
+        template<typename T>
+        typename result<T>::type
+                    operator()  (T const &x) const { return Op::apply(left_(x), right_(x)); }
+
+        template<typename T>
+        typename result<T>::type const *
+                    evaluate    (T const *x, std::size_t n, typename result<T>::type *buffer) const
+        {
+            typedef typename result<T>::type V;
+            V tmp[detail::block_length];
+            V const * const l = left_.evaluate(x, n, buffer);
+            V const * const r = right_.evaluate(x, n, tmp);
+            for(std::size_t i = 0; i < n; ++i) { buffer[i] = Op::apply(l[i], r[i]); }
+            return buffer;
+        }
+
+        L   left_;
+        R   right_;
+    };
+
+    //! @brief an operation of an expression and a value, which is converted to the type of the expression.
+    template<typename Op, typename E, typename C, bool ValueOnLeft>
+    struct binary_value
+        :   expression_base< binary_value<Op, E, C, ValueOnLeft> >
+    {
+        template<typename T> struct result { typedef typename E::template result<T>::type type; };
+
+        binary_value    (E const &e, C const &c) : e_(e), c_(c) {}
+
+        template<typename T>
+        typename result<T>::type
+                    operator()  (T const &x) const
+        {
+            typedef typename result<T>::type V;
+            return ValueOnLeft ? Op::apply(static_cast<V>(c_), e_(x)) : Op::apply(e_(x), static_cast<V>(c_));
+        }
+
+        template<typename T>
+        typename result<T>::type const *
+                    evaluate    (T const *x, std::size_t n, typename result<T>::type *buffer) const
+        {
+            typedef typename result<T>::type V;
+            V const c = static_cast<V>(c_);
+            V const * const p = e_.evaluate(x, n, buffer);
+            if(ValueOnLeft) {
+                for(std::size_t i = 0; i < n; ++i) { buffer[i] = Op::apply(c, p[i]); }
+            } else {
+                for(std::size_t i = 0; i < n; ++i) { buffer[i] = Op::apply(p[i], c); }
+            }
+            return buffer;
+        }
+
+        E   e_;
+        C   c_;
+    };
+
+    //! @brief an operation of an expression, whose type is the type of the expression.
+    template<typename Op, typename E>
+    struct unary
+        :   expression_base< unary<Op, E> >
+    {
+        template<typename T> struct result { typedef typename E::template result<T>::type type; };
+
+        explicit unary  (E const &e) : e_(e) {}
+
+        template<typename T>
+        typename result<T>::type
+                    operator()  (T const &x) const { return Op::apply(e_(x)); }
+
+        template<typename T>
+        typename result<T>::type const *
+                    evaluate    (T const *x, std::size_t n, typename result<T>::type *buffer) const
+        {
+            Op::block(e_.evaluate(x, n, buffer), n, buffer);
+            return buffer;
+        }
+
+        E   e_;
+    };
+
+    //! @brief modulus or division of an expression by a value or a divisor<T>.
+    template<detail::ad::division_kind Kind, bool Quotient, typename E, typename D>
+    struct divmod
+        :   expression_base< divmod<Kind, Quotient, E, D> >
+    {
+        template<typename T> struct result { typedef typename E::template result<T>::type type; };
+
+        divmod  (E const &e, D const &d) : e_(e), d_(d) {}
+
+        template<typename T>
+        typename result<T>::type
+                    operator()  (T const &x) const
+        {
+            typedef typename result<T>::type V;
+            return element_type<V>::apply(e_(x), detail::divisor_of<V>(d_));
+        }
+
+        template<typename T>
+        typename result<T>::type const *
+                    evaluate    (T const *x, std::size_t n, typename result<T>::type *buffer) const
+        {
+            typedef typename result<T>::type V;
+            element_type<V>::block(e_.evaluate(x, n, buffer), n, detail::divisor_of<V>(d_), buffer);
+            return buffer;
+        }
+
+    private:
+        template<typename V>
+        struct element_type
+            :   detail::divmod_element<Kind, Quotient, boost::is_floating_point<V>::value>
+        {};
+
+        E   e_;
+        D   d_;
+    };
+
+    //! @brief an expression converted to U.
+    template<typename U, typename E>
+    struct cast_expression
+        :   expression_base< cast_expression<U, E> >
+    {
+        template<typename T> struct result { typedef U type; };
+
+        explicit cast_expression    (E const &e) : e_(e) {}
+
+        template<typename T>
+        U           operator()  (T const &x) const { return static_cast<U>(e_(x)); }
+
+        template<typename T>
+        U const *   evaluate    (T const *x, std::size_t n, U *buffer) const
+        {
+            typedef typename E::template result<T>::type V;
+            V tmp[detail::block_length];
+            V const * const p = e_.evaluate(x, n, tmp);
+            for(std::size_t i = 0; i < n; ++i) { buffer[i] = static_cast<U>(p[i]); }
+            return buffer;
+        }
+
+        E   e_;
+    };
+
+    //! @brief a rounded expression converted to U, by the bulk rounding to U. (e.g. float to int32 by cvtps2dq)
+    template<typename U, typename Op, typename E>
+    struct cast_expression<U, unary<detail::round_op<Op>, E> >
+        :   expression_base< cast_expression<U, unary<detail::round_op<Op>, E> > >
+    {
+        template<typename T> struct result { typedef U type; };
+
+        explicit cast_expression    (unary<detail::round_op<Op>, E> const &e) : e_(e.e_) {}
+
+        template<typename T>
+        U           operator()  (T const &x) const { return static_cast<U>(detail::round_op<Op>::apply(e_(x))); }
+
+        template<typename T>
+        U const *   evaluate    (T const *x, std::size_t n, U *buffer) const
+        {
+            typedef typename E::template result<T>::type V;
+            V tmp[detail::block_length];
+            V const * const p = e_.evaluate(x, n, tmp);
+            detail::ad::round_batch<Op>(p, p + n, buffer);
+            return buffer;
+        }
+
+        E   e_;
+    };
+
+    //============================================================================//
+    //! @}
+    //  enddef of expression_nodes
+    //============================================================================//
+
+    //============================================================================//
+    //! @defgroup expression_operators Operators and Functions of Expressions.
+    //! build an expression. nothing is evaluated until evaluate() is called.
+    //! the operands of an operator must have the same type, and a value is converted to the type of the other operand.
+    //! @{
+    //============================================================================//
+
+#define HWM_ARITHMETIC_EXPRESSION_BINARY_OPERATOR(op, name)                                 \
+    template<typename L, typename R>                                                        \
+    binary<detail::name, L, R>                                                              \
+            operator op (expression_base<L> const &l, expression_base<R> const &r)          \
+    {                                                                                       \
+        return binary<detail::name, L, R>(l.derived(), r.derived());                        \
+    }                                                                                       \
+                                                                                            \
+    template<typename E, typename C>                                                        \
+    typename boost::enable_if<                                                              \
+        boost::is_arithmetic<C>, binary_value<detail::name, E, C, false>                    \
+    >::type operator op (expression_base<E> const &e, C const &c)                           \
+    {                                                                                       \
+        return binary_value<detail::name, E, C, false>(e.derived(), c);                     \
+    }                                                                                       \
+                                                                                            \
+    template<typename C, typename E>                                                        \
+    typename boost::enable_if<                                                              \
+        boost::is_arithmetic<C>, binary_value<detail::name, E, C, true>                     \
+    >::type operator op (C const &c, expression_base<E> const &e)                           \
+    {                                                                                       \
+        return binary_value<detail::name, E, C, true>(e.derived(), c);                      \
+    }
+
+    HWM_ARITHMETIC_EXPRESSION_BINARY_OPERATOR(+, plus_op)
+    HWM_ARITHMETIC_EXPRESSION_BINARY_OPERATOR(-, minus_op)
+    HWM_ARITHMETIC_EXPRESSION_BINARY_OPERATOR(*, multiplies_op)
+    HWM_ARITHMETIC_EXPRESSION_BINARY_OPERATOR(/, divides_op)
+
+#undef HWM_ARITHMETIC_EXPRESSION_BINARY_OPERATOR
+
+    //! @brief -e
+    template<typename E>
+    unary<detail::negate_op, E>
+            operator -              (expression_base<E> const &e) { return unary<detail::negate_op, E>(e.derived()); }
+
+    //! @brief abs(e)
+    template<typename E>
+    unary<detail::abs_op, E>
+            abs                     (expression_base<E> const &e) { return unary<detail::abs_op, E>(e.derived()); }
+
+    //! @brief round_simple(e)
+    template<typename E>
+    unary<detail::round_op<detail::ad::round_simple_op>, E>
+            round_simple            (expression_base<E> const &e)
+    {
+        return unary<detail::round_op<detail::ad::round_simple_op>, E>(e.derived());
+    }
+
+    //! @brief round_to_nearest_even(e)
+    template<typename E>
+    unary<detail::round_op<detail::ad::round_to_nearest_even_op>, E>
+            round_to_nearest_even   (expression_base<E> const &e)
+    {
+        return unary<detail::round_op<detail::ad::round_to_nearest_even_op>, E>(e.derived());
+    }
+
+    //! @brief static_cast<U>(e)
+    template<typename U, typename E>
+    cast_expression<U, E>
+            cast                    (expression_base<E> const &e) { return cast_expression<U, E>(e.derived()); }
+
+#define HWM_ARITHMETIC_EXPRESSION_DIVISION(name, kind, quotient)                            \
+    template<typename E, typename D>                                                        \
+    divmod<detail::ad::kind, quotient, E, D>                                                \
+            name    (expression_base<E> const &e, D const &d)                               \
+    {                                                                                       \
+        return divmod<detail::ad::kind, quotient, E, D>(e.derived(), d);                    \
+    }
+
+    //! @brief mod_truncated(e, d). d is a value or a divisor<T>. floating point values use fmod_truncated.
+    HWM_ARITHMETIC_EXPRESSION_DIVISION(mod_truncated, truncated_division, false)
+    //! @brief mod_floored(e, d). d is a value or a divisor<T>. floating point values use fmod_floored.
+    HWM_ARITHMETIC_EXPRESSION_DIVISION(mod_floored, floored_division, false)
+    //! @brief mod_euclidean(e, d). d is a value or a divisor<T>. floating point values use fmod_euclidean.
+    HWM_ARITHMETIC_EXPRESSION_DIVISION(mod_euclidean, euclidean_division, false)
+    //! @brief div_truncated(e, d). d is a value or a divisor<T>. floating point values use fdiv_truncated.
+    HWM_ARITHMETIC_EXPRESSION_DIVISION(div_truncated, truncated_division, true)
+    //! @brief div_floored(e, d). d is a value or a divisor<T>. floating point values use fdiv_floored.
+    HWM_ARITHMETIC_EXPRESSION_DIVISION(div_floored, floored_division, true)
+    //! @brief div_euclidean(e, d). d is a value or a divisor<T>. floating point values use fdiv_euclidean.
+    HWM_ARITHMETIC_EXPRESSION_DIVISION(div_euclidean, euclidean_division, true)
+
+#undef HWM_ARITHMETIC_EXPRESSION_DIVISION
+
+    //============================================================================//
+    //! @}
+    //  enddef of expression_operators
+    //============================================================================//
+
+    //============================================================================//
+    //! @defgroup expression_evaluation Evaluation of Expressions.
+    //! @{
+    //============================================================================//
+
+    //! @brief evaluate `e' for each element of [first, last) in one pass,
+    //! and write the results converted to U to the range beginning at `out'.
+    //! `out' may be equal to `first', but the ranges must not overlap otherwise.
+    //! the result for an element is the same as e(x), and the preconditions of the functions in `e' apply.
+    //! @return the end of the output range.
+    template<typename T, typename U, typename E>
+    U *     evaluate    (T const *first, T const *last, expression_base<E> const &e, U *out)
+    {
+        typedef typename E::template result<T>::type V;
+        BOOST_ASSERT(first <= last);
+
+        V buffer[detail::block_length];
+        while(first != last) {
+            std::size_t const rest = static_cast<std::size_t>(last - first);
+            std::size_t const n = (rest < detail::block_length) ? rest : static_cast<std::size_t>(detail::block_length);
+            V const * const p = e.derived().evaluate(first, n, buffer);
+            for(std::size_t i = 0; i < n; ++i) { out[i] = static_cast<U>(p[i]); }
+            first += n;
+            out += n;
+        }
+        return out;
+    }
+
+    //! @brief evaluate `e' for arrays.
+    template<typename T, typename U, std::size_t N, typename E>
+    U *     evaluate    (T const (&in)[N], expression_base<E> const &e, U (&out)[N])
+    {
+        return evaluate(in, in + N, e, out);
+    }
+
+    //============================================================================//
+    //! @}
+    //  enddef of expression_evaluation
+    //============================================================================//
+
+}}} //namespace hwm::arithmetic::expression
+
+#endif  //HWM_ARITHMETIC_EXPRESSION_HPP
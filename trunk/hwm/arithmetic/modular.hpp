@@ -0,0 +1,294 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef HWM_ARITHMETIC_MODULAR_HPP
+#define HWM_ARITHMETIC_MODULAR_HPP
+
+//! hwm.Arithmetic
+//! modular arithmetic with a fixed modulus.
+//! up to 32 bits, the exact results are reduced by Barrett reduction.
+//! 64-bit values use 128-bit intermediates, and Montgomery reduction for pow_mod by an odd modulus.
+//! @file
+
+#include <cstddef>
+#include <boost/assert.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/mpl/if.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/integral_constant.hpp>
+#include <boost/type_traits/is_integral.hpp>
+#include <boost/type_traits/is_signed.hpp>
+#include <boost/type_traits/make_unsigned.hpp>
+
+#include "./batch.hpp"
+#include "./divisor.hpp"
+
+namespace hwm { namespace arithmetic {
+
+    //! @cond DETAIL
+    namespace detail
+    {
+        template<typename T, typename U>
+        U       magnitude   (T const x, boost::true_type)
+        {
+            return (x < 0) ? static_cast<U>(static_cast<U>(0) - static_cast<U>(x)) : static_cast<U>(x);
+        }
+
+        template<typename T, typename U>
+        U       magnitude   (T const x, boost::false_type)
+        {
+            return static_cast<U>(x);
+        }
+
+        template<typename T>
+        bool    is_negative (T const x, boost::true_type)   { return x < 0; }
+
+        template<typename T>
+        bool    is_negative (T const, boost::false_type)    { return false; }
+
+        template<typename T, bool Wide = (sizeof(T) > 4)>
+        class modular_impl;
+
+        //  Barrett reduction.
+        //  the exact sum and product of values up to 32 bits fit in 64 bits.
+        //  q = mulhi(p, floor(2^64 / m)) is either floor(p / m) or one less than it,
+        //  so p - q * m needs at most one correction.
+        template<typename T>
+        class modular_impl<T, false>
+        {
+            typedef typename boost::is_signed<T>::type  is_signed_type;
+            typedef typename boost::mpl::if_<
+                        is_signed_type, boost::int64_t, boost::uint64_t
+                    >::type                             wide_type;
+
+        public:
+            explicit
+            modular_impl    (boost::uint64_t const m)
+                :   m_  (m)
+                ,   mu_ (static_cast<boost::uint64_t>(-1) / m)
+            {
+                //floor((2^64 - 1) / m) is one less than floor(2^64 / m) for powers of two.
+                //(m == 1 keeps 2^64 - 1, which still satisfies the bound above.)
+                if(m != 1 && (m & (m - 1)) == 0) { ++mu_; }
+            }
+
+            T   reduce  (T const x) const { return reduce_wide(x); }
+
+            T   add     (T const x, T const y) const
+            {
+                return reduce_wide(static_cast<wide_type>(x) + static_cast<wide_type>(y));
+            }
+
+            T   mul     (T const x, T const y) const
+            {
+                return reduce_wide(static_cast<wide_type>(x) * static_cast<wide_type>(y));
+            }
+
+            T   pow     (T const x, boost::uintmax_t e) const
+            {
+                boost::uint64_t base = static_cast<boost::uint64_t>(reduce(x));
+                boost::uint64_t acc = barrett(1);
+                for( ; e != 0; e >>= 1) {
+                    if(e & 1) { acc = barrett(acc * base); }
+                    base = barrett(base * base);
+                }
+                return static_cast<T>(acc);
+            }
+
+        private:
+            T   reduce_wide (wide_type const x) const
+            {
+                boost::uint64_t const r = barrett(magnitude<wide_type, boost::uint64_t>(x, is_signed_type()));
+                return static_cast<T>((is_negative(x, is_signed_type()) && r != 0) ? m_ - r : r);
+            }
+
+            boost::uint64_t barrett (boost::uint64_t const p) const
+            {
+                boost::uint64_t const q = mulhi(p, mu_);
+                boost::uint64_t const r = p - q * m_;
+                return (r >= m_) ? r - m_ : r;
+            }
+
+            boost::uint64_t m_;
+            boost::uint64_t mu_;
+        };
+
+        //  64-bit values.
+        //  the product is reduced by the 128-by-64 bit division.
+        //  pow_mod by an odd modulus uses Montgomery reduction with R = 2^64,
+        //  where the conversion to the Montgomery form is paid only once.
+        template<typename T>
+        class modular_impl<T, true>
+        {
+            BOOST_STATIC_ASSERT(sizeof(T) == 8);
+            typedef typename boost::is_signed<T>::type      is_signed_type;
+            typedef typename boost::make_unsigned<T>::type  U;
+
+        public:
+            explicit
+            modular_impl    (U const m)
+                :   m_      (m)
+                ,   div_    (m)
+                ,   odd_    ((m & 1) != 0)
+                ,   inv_    (0)
+                ,   r1_     (static_cast<U>(static_cast<U>(0 - m) % m))
+                ,   r2_     (0)
+            {
+                if(!odd_) { return; }
+
+                //m * m == 1 (mod 8) for odd m, and each Newton step doubles the correct bits.
+                inv_ = m;
+                for(int i = 0; i < 5; ++i) { inv_ = static_cast<U>(inv_ * (2 - m * inv_)); }
+                wide_multiply<8>::divide(r1_, static_cast<U>(0), m, r2_);
+            }
+
+            T   reduce  (T const x) const
+            {
+                return apply_sign(div_.mod_truncated(magnitude<T, U>(x, is_signed_type())), is_negative(x, is_signed_type()));
+            }
+
+            T   add     (T const x, T const y) const
+            {
+                U const rx = static_cast<U>(reduce(x));
+                U const ry = static_cast<U>(reduce(y));
+                U const s  = static_cast<U>(rx + ry);
+                //the sum wraps around only if m is greater than 2^63.
+                return static_cast<T>((s < rx || s >= m_) ? static_cast<U>(s - m_) : s);
+            }
+
+            T   mul     (T const x, T const y) const
+            {
+                U const r = mul_unsigned(magnitude<T, U>(x, is_signed_type()), magnitude<T, U>(y, is_signed_type()));
+                return apply_sign(r, is_negative(x, is_signed_type()) != is_negative(y, is_signed_type()));
+            }
+
+            T   pow     (T const x, boost::uintmax_t e) const
+            {
+                U base = static_cast<U>(reduce(x));
+                if(!odd_) {
+                    U acc = div_.mod_truncated(1);
+                    for( ; e != 0; e >>= 1) {
+                        if(e & 1) { acc = mul_unsigned(acc, base); }
+                        base = mul_unsigned(base, base);
+                    }
+                    return static_cast<T>(acc);
+                }
+
+                //stay in the Montgomery form (x * R mod m) until the end.
+                base = montgomery_mul(base, r2_);
+                U acc = r1_;
+                for( ; e != 0; e >>= 1) {
+                    if(e & 1) { acc = montgomery_mul(acc, base); }
+                    base = montgomery_mul(base, base);
+                }
+                return static_cast<T>(redc(0, acc));
+            }
+
+        private:
+            T   apply_sign      (U const r, bool const negative) const
+            {
+                return static_cast<T>((negative && r != 0) ? static_cast<U>(m_ - r) : r);
+            }
+
+            U   mul_unsigned    (U const x, U const y) const
+            {
+                U hi = mulhi(x, y);
+                //the division needs hi < m. it already holds if either operand is reduced.
+                if(hi >= m_) { hi = div_.mod_truncated(hi); }
+                U rem;
+                wide_multiply<8>::divide(hi, static_cast<U>(x * y), m_, rem);
+                return rem;
+            }
+
+            //! (hi * 2^64 + lo) * 2^-64 mod m. hi must be less than m.
+            //! with t = lo * m^-1 (mod 2^64), the low halves of (hi, lo) and t * m cancel exactly.
+            U   redc            (U const hi, U const lo) const
+            {
+                U const t = static_cast<U>(lo * inv_);
+                U const u = mulhi(t, m_);
+                U const r = static_cast<U>(hi - u);
+                return (hi < u) ? static_cast<U>(r + m_) : r;
+            }
+
+            //! x * y * 2^-64 mod m. x and y must be less than m.
+            U   montgomery_mul  (U const x, U const y) const
+            {
+                return redc(mulhi(x, y), static_cast<U>(x * y));
+            }
+
+            U           m_;
+            divisor<U>  div_;
+            bool        odd_;
+            U           inv_;   //m^-1 mod 2^64
+            U           r1_;    //R mod m
+            U           r2_;    //R^2 mod m
+        };
+    }   //namespace detail
+    //! @endcond
+
+    //! @brief modular arithmetic with a precomputed modulus.
+    //! every operation returns the mathematically exact result reduced by mod_euclidean,
+    //! i.e. a value in [0, abs(m)), without overflow of the intermediate values.
+    //! @tparam T must be an integral type.
+    template<typename T>
+    class modular_context
+    {
+        BOOST_STATIC_ASSERT(boost::is_integral<T>::value);
+        typedef typename boost::make_unsigned<T>::type  unsigned_type;
+
+    public:
+        typedef T   value_type;
+
+        //! @brief precompute the constants for the modulus `m'.
+        //! m must not be zero. a negative modulus is equivalent to its absolute value.
+        explicit
+        modular_context     (T const &m)
+            :   m_      (m)
+            ,   div_    (m)
+            ,   impl_   (detail::magnitude<T, unsigned_type>(m, typename boost::is_signed<T>::type()))
+        {
+            BOOST_ASSERT(m != 0);
+        }
+
+        //! @return the modulus.
+        T       modulus     () const { return m_; }
+
+        //! @return mod_euclidean(x, m).
+        T       reduce      (T const &x) const { return impl_.reduce(x); }
+
+        //! @brief bulk version of reduce.
+        //! `out' may be equal to `first'.
+        //! @return out + (last - first).
+        T *     reduce      (T const *first, T const *last, T *out) const
+        {
+            return mod_euclidean(first, last, div_, out);
+        }
+
+        //! @brief bulk version of reduce for arrays.
+        template<std::size_t N>
+        T *     reduce      (T const (&in)[N], T (&out)[N]) const
+        {
+            return reduce(in, in + N, out);
+        }
+
+        //! @return mod_euclidean(x + y, m), computed without overflow.
+        T       add_mod     (T const &x, T const &y) const { return impl_.add(x, y); }
+
+        //! @return mod_euclidean(x * y, m), computed without overflow.
+        T       mul_mod     (T const &x, T const &y) const { return impl_.mul(x, y); }
+
+        //! @return mod_euclidean(x^e, m), computed without overflow.
+        //! x^0 is 1 (0 if abs(m) is 1).
+        T       pow_mod     (T const &x, boost::uintmax_t const e) const { return impl_.pow(x, e); }
+
+    private:
+        T                           m_;
+        divisor<T>                  div_;
+        detail::modular_impl<T>     impl_;
+    };
+
+}}  //namespace hwm::arithmetic
+
+#endif  //HWM_ARITHMETIC_MODULAR_HPP
@@ -0,0 +1,295 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef HWM_ARITHMETIC_PARALLEL_HPP
+#define HWM_ARITHMETIC_PARALLEL_HPP
+
+//! hwm.Arithmetic
+//! bulk operations over large arrays, on the threads of a thread_pool.
+//! the arrays are split into chunks that fit in the cache of a core,
+//! and each chunk is processed by the bulk function of the same name. (see batch.hpp)
+//! an expression of expression.hpp is evaluated in one pass over each chunk.
+//! requires Boost.Thread. (see thread_pool.hpp)
+//! @file
+
+#include <cstddef>
+#include <boost/assert.hpp>
+
+#include "../thread_pool.hpp"
+#include "./batch.hpp"
+#include "./divisor.hpp"
+#include "./expression.hpp"
+
+//default
+//each chunk reads 64KiB of the input.
+
+//definition
+//HWM_ARITHMETIC_PARALLEL_CHUNK_BYTES=n      //<= each chunk reads n bytes of the input
+
+#if !defined HWM_ARITHMETIC_PARALLEL_CHUNK_BYTES
+    #define HWM_ARITHMETIC_PARALLEL_CHUNK_BYTES (64 * 1024)
+#endif
+
+namespace hwm { namespace arithmetic { namespace parallel {
+
+    //! @cond DETAIL
+    namespace detail
+    {
+        namespace ad = hwm::arithmetic::detail;
+
+        //! the number of elements in a chunk. a multiple of 64 bytes, so that the chunks of
+        //! an aligned array do not share a cache line.
+        template<typename T, typename U>
+        std::size_t     chunk_length    ()
+        {
+            std::size_t const size = (sizeof(T) < sizeof(U)) ? sizeof(U) : sizeof(T);
+            std::size_t const n = (HWM_ARITHMETIC_PARALLEL_CHUNK_BYTES) / size;
+            return (n < 64) ? 64 : n;
+        }
+
+        template<ad::division_kind Kind, bool Quotient, typename D>
+        struct divmod_chunk
+        {
+            explicit divmod_chunk   (D const &d) : d_(d) {}
+
+            template<typename T>
+            void    operator()  (T const *first, T const *last, T *out) const
+            {
+                ad::divmod_batch<Kind, Quotient>(first, last, d_, out);
+            }
+
+            D   d_;
+        };
+
+        template<typename Op>
+        struct round_chunk
+        {
+            template<typename T, typename U>
+            void    operator()  (T const *first, T const *last, U *out) const
+            {
+                ad::round_batch<Op>(first, last, out);
+            }
+        };
+
+        template<typename E>
+        struct expression_chunk
+        {
+            explicit expression_chunk   (E const &e) : e_(e) {}
+
+            template<typename T, typename U>
+            void    operator()  (T const *first, T const *last, U *out) const
+            {
+                expression::evaluate(first, last, e_, out);
+            }
+
+            E   e_;
+        };
+
+        //! applies `Op' to the chunk of the given index.
+        template<typename T, typename U, typename Op>
+        struct chunk_task
+        {
+            chunk_task  (T const *first, std::size_t length, U *out, std::size_t chunk, Op const &op)
+                :   first_  (first)
+                ,   length_ (length)
+                ,   out_    (out)
+                ,   chunk_  (chunk)
+                ,   op_     (op)
+            {}
+
+            void    operator()  (std::size_t i) const
+            {
+                std::size_t const begin = i * chunk_;
+                std::size_t const end = (length_ - begin < chunk_) ? length_ : begin + chunk_;
+                op_(first_ + begin, first_ + end, out_ + begin);
+            }
+
+            T const *   first_;
+            std::size_t length_;
+            U *         out_;
+            std::size_t chunk_;
+            Op          op_;
+        };
+
+        template<typename T, typename U, typename Op>
+        U *     apply   (T const *first, T const *last, U *out, thread_pool &pool, Op const &op)
+        {
+            BOOST_ASSERT(first <= last);
+            std::size_t const length = static_cast<std::size_t>(last - first);
+            std::size_t const chunk = chunk_length<T, U>();
+
+            if(length <= chunk || pool.size() == 1) {
+                op(first, last, out);
+            } else {
+                pool.for_each_index(
+                    (length + chunk - 1) / chunk,
+                    chunk_task<T, U, Op>(first, length, out, chunk, op) );
+            }
+            return out + length;
+        }
+
+        template<ad::division_kind Kind, bool Quotient, typename T, typename D>
+        T *     divmod  (T const *first, T const *last, D const &d, T *out, thread_pool &pool)
+        {
+            return apply(first, last, out, pool, divmod_chunk<Kind, Quotient, D>(d));
+        }
+    }   //namespace detail
+    //! @endcond
+
+    //============================================================================//
+    //! @defgroup parallel_division Parallel Modulus and Division Operations.
+    //! apply a modulus or division operation with the same divisor to [first, last) on the threads of `pool',
+    //! and write the results to the range beginning at `out'.
+    //! `out' may be equal to `first', but the ranges must not overlap otherwise.
+    //! the preconditions and the results are the same as the scalar function of the same name.
+    //! @return the end of the output range.
+    //! @{
+    //============================================================================//
+
+    //! @brief parallel version of mod_truncated.
+    template<typename T>
+    T *     mod_truncated           (T const *first, T const *last, T const &divisor, T *out, thread_pool &pool)
+    {
+        BOOST_ASSERT(divisor != 0);
+        return detail::divmod<detail::ad::truncated_division, false>(first, last, divisor, out, pool);
+    }
+
+    //! @brief parallel version of mod_truncated by a precomputed divisor.
+    template<typename T>
+    T *     mod_truncated           (T const *first, T const *last, divisor<T> const &d, T *out, thread_pool &pool)
+    {
+        return detail::divmod<detail::ad::truncated_division, false>(first, last, d, out, pool);
+    }
+
+    //! @brief parallel version of mod_floored.
+    template<typename T>
+    T *     mod_floored             (T const *first, T const *last, T const &divisor, T *out, thread_pool &pool)
+    {
+        BOOST_ASSERT(divisor != 0);
+        return detail::divmod<detail::ad::floored_division, false>(first, last, divisor, out, pool);
+    }
+
+    //! @brief parallel version of mod_floored by a precomputed divisor.
+    template<typename T>
+    T *     mod_floored             (T const *first, T const *last, divisor<T> const &d, T *out, thread_pool &pool)
+    {
+        return detail::divmod<detail::ad::floored_division, false>(first, last, d, out, pool);
+    }
+
+    //! @brief parallel version of mod_euclidean.
+    template<typename T>
+    T *     mod_euclidean           (T const *first, T const *last, T const &divisor, T *out, thread_pool &pool)
+    {
+        BOOST_ASSERT(divisor != 0);
+        return detail::divmod<detail::ad::euclidean_division, false>(first, last, divisor, out, pool);
+    }
+
+    //! @brief parallel version of mod_euclidean by a precomputed divisor.
+    template<typename T>
+    T *     mod_euclidean           (T const *first, T const *last, divisor<T> const &d, T *out, thread_pool &pool)
+    {
+        return detail::divmod<detail::ad::euclidean_division, false>(first, last, d, out, pool);
+    }
+
+    //! @brief parallel version of div_truncated.
+    template<typename T>
+    T *     div_truncated           (T const *first, T const *last, T const &divisor, T *out, thread_pool &pool)
+    {
+        BOOST_ASSERT(divisor != 0);
+        return detail::divmod<detail::ad::truncated_division, true>(first, last, divisor, out, pool);
+    }
+
+    //! @brief parallel version of div_truncated by a precomputed divisor.
+    template<typename T>
+    T *     div_truncated           (T const *first, T const *last, divisor<T> const &d, T *out, thread_pool &pool)
+    {
+        return detail::divmod<detail::ad::truncated_division, true>(first, last, d, out, pool);
+    }
+
+    //! @brief parallel version of div_floored.
+    template<typename T>
+    T *     div_floored             (T const *first, T const *last, T const &divisor, T *out, thread_pool &pool)
+    {
+        BOOST_ASSERT(divisor != 0);
+        return detail::divmod<detail::ad::floored_division, true>(first, last, divisor, out, pool);
+    }
+
+    //! @brief parallel version of div_floored by a precomputed divisor.
+    template<typename T>
+    T *     div_floored             (T const *first, T const *last, divisor<T> const &d, T *out, thread_pool &pool)
+    {
+        return detail::divmod<detail::ad::floored_division, true>(first, last, d, out, pool);
+    }
+
+    //! @brief parallel version of div_euclidean.
+    template<typename T>
+    T *     div_euclidean           (T const *first, T const *last, T const &divisor, T *out, thread_pool &pool)
+    {
+        BOOST_ASSERT(divisor != 0);
+        return detail::divmod<detail::ad::euclidean_division, true>(first, last, divisor, out, pool);
+    }
+
+    //! @brief parallel version of div_euclidean by a precomputed divisor.
+    template<typename T>
+    T *     div_euclidean           (T const *first, T const *last, divisor<T> const &d, T *out, thread_pool &pool)
+    {
+        return detail::divmod<detail::ad::euclidean_division, true>(first, last, d, out, pool);
+    }
+
+    //============================================================================//
+    //! @}
+    //  enddef of parallel_division
+    //============================================================================//
+
+    //============================================================================//
+    //! @defgroup parallel_rounding Parallel Rounding Operations.
+    //! round each value in [first, last) on the threads of `pool',
+    //! and write the results to the range beginning at `out'.
+    //! the results are the same as the bulk function of the same name.
+    //! `out' may be equal to `first' if T and U are the same type.
+    //! @return the end of the output range.
+    //! @{
+    //============================================================================//
+
+    //! @brief parallel version of round_simple.
+    template<typename T, typename U>
+    U *     round_simple            (T const *first, T const *last, U *out, thread_pool &pool)
+    {
+        return detail::apply(first, last, out, pool, detail::round_chunk<detail::ad::round_simple_op>());
+    }
+
+    //! @brief parallel version of round_to_nearest_even.
+    template<typename T, typename U>
+    U *     round_to_nearest_even   (T const *first, T const *last, U *out, thread_pool &pool)
+    {
+        return detail::apply(first, last, out, pool, detail::round_chunk<detail::ad::round_to_nearest_even_op>());
+    }
+
+    //============================================================================//
+    //! @}
+    //  enddef of parallel_rounding
+    //============================================================================//
+
+    //============================================================================//
+    //! @defgroup parallel_expression Parallel Evaluation of Expressions.
+    //! @{
+    //============================================================================//
+
+    //! @brief parallel version of expression::evaluate. (see expression.hpp)
+    //! each chunk is evaluated in one pass on one thread.
+    template<typename T, typename U, typename E>
+    U *     evaluate                (T const *first, T const *last, expression::expression_base<E> const &e, U *out, thread_pool &pool)
+    {
+        return detail::apply(first, last, out, pool, detail::expression_chunk<E>(e.derived()));
+    }
+
+    //============================================================================//
+    //! @}
+    //  enddef of parallel_expression
+    //============================================================================//
+
+}}} //namespace hwm::arithmetic::parallel
+
+#endif  //HWM_ARITHMETIC_PARALLEL_HPP
@@ -0,0 +1,525 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef HWM_ARITHMETIC_PREDICATE_HPP
+#define HWM_ARITHMETIC_PREDICATE_HPP
+
+//! hwm.Arithmetic
+//! bulk sign, abs, odd and even.
+//! the predicates are packed in bitmasks, one bit for each element, so that
+//! the elements are counted by popcount and selected by a scan of the set bits, without a branch for each element.
+//! e.g. the negative elements of [first, last)
+//!     std::vector<boost::uint64_t> mask(bitmask_size(last - first));
+//!     negative_mask(first, last, &mask[0]);
+//!     select(first, last, &mask[0], out);
+//! @file
+
+#include <cstddef>
+#include <boost/assert.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/type_traits/integral_constant.hpp>
+#include <boost/type_traits/is_floating_point.hpp>
+#include <boost/type_traits/is_integral.hpp>
+#include <boost/type_traits/is_signed.hpp>
+#include <boost/type_traits/make_unsigned.hpp>
+#include <boost/utility/enable_if.hpp>
+
+#include "../arithmetic.hpp"
+#include "./cpu.hpp"
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+namespace hwm { namespace arithmetic {
+
+    //! @cond DETAIL
+    namespace detail
+    {
+        inline
+        int     popcount    (boost::uint64_t x)
+        {
+#if defined(__GNUC__)
+            return __builtin_popcountll(x);
+#else
+            x = x - ((x >> 1) & 0x5555555555555555ULL);
+            x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+            x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+            return static_cast<int>((x * 0x0101010101010101ULL) >> 56);
+#endif
+        }
+
+        //! x must not be zero.
+        inline
+        int     count_trailing_zeros    (boost::uint64_t const x)
+        {
+            BOOST_ASSERT(x != 0);
+#if defined(__GNUC__)
+            return __builtin_ctzll(x);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+            unsigned long i;
+            _BitScanForward64(&i, x);
+            return static_cast<int>(i);
+#else
+            //the lowest set bit, and the bits below it.
+            return popcount((x & (0 - x)) - 1);
+#endif
+        }
+
+        //! the number of the set bits of [first, last).
+        inline
+        std::size_t count_bits_scalar   (boost::uint64_t const *first, boost::uint64_t const *last)
+        {
+            std::size_t n = 0;
+            for( ; first != last; ++first) { n += static_cast<std::size_t>(popcount(*first)); }
+            return n;
+        }
+
+#if defined HWM_ARITHMETIC_SIMD_X86
+        HWM_ARITHMETIC_TARGET_POPCNT
+        inline
+        std::size_t count_bits_popcnt   (boost::uint64_t const *first, boost::uint64_t const *last)
+        {
+            std::size_t n = 0;
+            for( ; first != last; ++first) {
+    #if defined(_MSC_VER) && defined(_M_X64)
+                n += static_cast<std::size_t>(__popcnt64(*first));
+    #elif defined(_MSC_VER)
+                n += static_cast<std::size_t>(__popcnt(static_cast<unsigned int>(*first)) + __popcnt(static_cast<unsigned int>(*first >> 32)));
+    #else
+                n += static_cast<std::size_t>(__builtin_popcountll(*first));
+    #endif
+            }
+            return n;
+        }
+#endif
+
+        //  predicates.
+        //  each op has the scalar function and, for the types listed in has_simd, the SSE4.1 / AVX2 instructions
+        //  that set the highest bit of each element where the predicate holds.
+        //  the last parameter of the SIMD functions selects the element type.
+
+        template<std::size_t Size>
+        struct lane_size {};
+
+        //! the element types of the SIMD kernels.
+        template<typename T>
+        struct is_simd_lane
+            :   boost::integral_constant<bool,
+                    (boost::is_integral<T>::value && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8)) ||
+                    (boost::is_floating_point<T>::value && (sizeof(T) == 4 || sizeof(T) == 8)) >
+        {};
+
+#if defined HWM_ARITHMETIC_SIMD_X86
+        //  the highest bits of the elements, packed in the low bits.
+        HWM_ARITHMETIC_TARGET_SSE41 inline unsigned int top_bits    (__m128i v, lane_size<1>)   { return static_cast<unsigned int>(_mm_movemask_epi8(v)); }
+        HWM_ARITHMETIC_TARGET_SSE41 inline unsigned int top_bits    (__m128i v, lane_size<2>)   { return static_cast<unsigned int>(_mm_movemask_epi8(_mm_packs_epi16(v, v))) & 0xFFu; }
+        HWM_ARITHMETIC_TARGET_SSE41 inline unsigned int top_bits    (__m128i v, lane_size<4>)   { return static_cast<unsigned int>(_mm_movemask_ps(_mm_castsi128_ps(v))); }
+        HWM_ARITHMETIC_TARGET_SSE41 inline unsigned int top_bits    (__m128i v, lane_size<8>)   { return static_cast<unsigned int>(_mm_movemask_pd(_mm_castsi128_pd(v))); }
+        //pack works within each 128-bit lane, so the bytes of the lower half are in the bits 0-7 and 16-23.
+        HWM_ARITHMETIC_TARGET_AVX2  inline unsigned int top_bits    (__m256i v, lane_size<1>)   { return static_cast<unsigned int>(_mm256_movemask_epi8(v)); }
+        HWM_ARITHMETIC_TARGET_AVX2  inline unsigned int top_bits    (__m256i v, lane_size<2>)
+        {
+            unsigned int const m = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_packs_epi16(v, v)));
+            return (m & 0xFFu) | ((m >> 8) & 0xFF00u);
+        }
+        HWM_ARITHMETIC_TARGET_AVX2  inline unsigned int top_bits    (__m256i v, lane_size<4>)   { return static_cast<unsigned int>(_mm256_movemask_ps(_mm256_castsi256_ps(v))); }
+        HWM_ARITHMETIC_TARGET_AVX2  inline unsigned int top_bits    (__m256i v, lane_size<8>)   { return static_cast<unsigned int>(_mm256_movemask_pd(_mm256_castsi256_pd(v))); }
+
+        //  the lowest bit moved to the highest bit. the 16-bit shift by 7 moves the lowest bit of each byte.
+        HWM_ARITHMETIC_TARGET_SSE41 inline __m128i  low_to_top  (__m128i x, lane_size<1>)   { return _mm_slli_epi16(x, 7); }
+        HWM_ARITHMETIC_TARGET_SSE41 inline __m128i  low_to_top  (__m128i x, lane_size<2>)   { return _mm_slli_epi16(x, 15); }
+        HWM_ARITHMETIC_TARGET_SSE41 inline __m128i  low_to_top  (__m128i x, lane_size<4>)   { return _mm_slli_epi32(x, 31); }
+        HWM_ARITHMETIC_TARGET_SSE41 inline __m128i  low_to_top  (__m128i x, lane_size<8>)   { return _mm_slli_epi64(x, 63); }
+        HWM_ARITHMETIC_TARGET_AVX2  inline __m256i  low_to_top  (__m256i x, lane_size<1>)   { return _mm256_slli_epi16(x, 7); }
+        HWM_ARITHMETIC_TARGET_AVX2  inline __m256i  low_to_top  (__m256i x, lane_size<2>)   { return _mm256_slli_epi16(x, 15); }
+        HWM_ARITHMETIC_TARGET_AVX2  inline __m256i  low_to_top  (__m256i x, lane_size<4>)   { return _mm256_slli_epi32(x, 31); }
+        HWM_ARITHMETIC_TARGET_AVX2  inline __m256i  low_to_top  (__m256i x, lane_size<8>)   { return _mm256_slli_epi64(x, 63); }
+
+        //  0 - x.
+        HWM_ARITHMETIC_TARGET_SSE41 inline __m128i  negate      (__m128i x, lane_size<1>)   { return _mm_sub_epi8(_mm_setzero_si128(), x); }
+        HWM_ARITHMETIC_TARGET_SSE41 inline __m128i  negate      (__m128i x, lane_size<2>)   { return _mm_sub_epi16(_mm_setzero_si128(), x); }
+        HWM_ARITHMETIC_TARGET_SSE41 inline __m128i  negate      (__m128i x, lane_size<4>)   { return _mm_sub_epi32(_mm_setzero_si128(), x); }
+        HWM_ARITHMETIC_TARGET_SSE41 inline __m128i  negate      (__m128i x, lane_size<8>)   { return _mm_sub_epi64(_mm_setzero_si128(), x); }
+        HWM_ARITHMETIC_TARGET_AVX2  inline __m256i  negate      (__m256i x, lane_size<1>)   { return _mm256_sub_epi8(_mm256_setzero_si256(), x); }
+        HWM_ARITHMETIC_TARGET_AVX2  inline __m256i  negate      (__m256i x, lane_size<2>)   { return _mm256_sub_epi16(_mm256_setzero_si256(), x); }
+        HWM_ARITHMETIC_TARGET_AVX2  inline __m256i  negate      (__m256i x, lane_size<4>)   { return _mm256_sub_epi32(_mm256_setzero_si256(), x); }
+        HWM_ARITHMETIC_TARGET_AVX2  inline __m256i  negate      (__m256i x, lane_size<8>)   { return _mm256_sub_epi64(_mm256_setzero_si256(), x); }
+
+        //  all bits set where x is zero.
+        HWM_ARITHMETIC_TARGET_SSE41 inline __m128i  is_zero     (__m128i x, lane_size<1>)   { return _mm_cmpeq_epi8(x, _mm_setzero_si128()); }
+        HWM_ARITHMETIC_TARGET_SSE41 inline __m128i  is_zero     (__m128i x, lane_size<2>)   { return _mm_cmpeq_epi16(x, _mm_setzero_si128()); }
+        HWM_ARITHMETIC_TARGET_SSE41 inline __m128i  is_zero     (__m128i x, lane_size<4>)   { return _mm_cmpeq_epi32(x, _mm_setzero_si128()); }
+        HWM_ARITHMETIC_TARGET_SSE41 inline __m128i  is_zero     (__m128i x, lane_size<8>)   { return _mm_cmpeq_epi64(x, _mm_setzero_si128()); }
+        HWM_ARITHMETIC_TARGET_AVX2  inline __m256i  is_zero     (__m256i x, lane_size<1>)   { return _mm256_cmpeq_epi8(x, _mm256_setzero_si256()); }
+        HWM_ARITHMETIC_TARGET_AVX2  inline __m256i  is_zero     (__m256i x, lane_size<2>)   { return _mm256_cmpeq_epi16(x, _mm256_setzero_si256()); }
+        HWM_ARITHMETIC_TARGET_AVX2  inline __m256i  is_zero     (__m256i x, lane_size<4>)   { return _mm256_cmpeq_epi32(x, _mm256_setzero_si256()); }
+        HWM_ARITHMETIC_TARGET_AVX2  inline __m256i  is_zero     (__m256i x, lane_size<8>)   { return _mm256_cmpeq_epi64(x, _mm256_setzero_si256()); }
+#endif
+
+        struct odd_op
+        {
+            template<typename T>
+            static bool apply   (T const &x) { return odd(x); }
+
+            template<typename T> struct has_simd : boost::integral_constant<bool, is_simd_lane<T>::value && boost::is_integral<T>::value> {};
+
+#if defined HWM_ARITHMETIC_SIMD_X86
+            template<typename T> HWM_ARITHMETIC_TARGET_SSE41 static __m128i sse41  (__m128i x, T) { return low_to_top(x, lane_size<sizeof(T)>()); }
+            template<typename T> HWM_ARITHMETIC_TARGET_AVX2  static __m256i avx2   (__m256i x, T) { return low_to_top(x, lane_size<sizeof(T)>()); }
+#endif
+        };
+
+        struct even_op
+        {
+            template<typename T>
+            static bool apply   (T const &x) { return even(x); }
+
+            template<typename T> struct has_simd : odd_op::has_simd<T> {};
+
+#if defined HWM_ARITHMETIC_SIMD_X86
+            template<typename T> HWM_ARITHMETIC_TARGET_SSE41 static __m128i sse41  (__m128i x, T) { return _mm_andnot_si128(low_to_top(x, lane_size<sizeof(T)>()), _mm_set1_epi32(-1)); }
+            template<typename T> HWM_ARITHMETIC_TARGET_AVX2  static __m256i avx2   (__m256i x, T) { return _mm256_andnot_si256(low_to_top(x, lane_size<sizeof(T)>()), _mm256_set1_epi32(-1)); }
+#endif
+        };
+
+        //! sign(x) < 0. -0.0 and NaN are not negative.
+        struct negative_op
+        {
+            template<typename T>
+            static bool apply   (T const &x) { return sign(x) < 0; }
+
+            template<typename T> struct has_simd : boost::integral_constant<bool, is_simd_lane<T>::value && boost::is_signed<T>::value> {};
+
+#if defined HWM_ARITHMETIC_SIMD_X86
+            //the sign bit of a signed integer is the predicate.
+            template<typename T> HWM_ARITHMETIC_TARGET_SSE41 static __m128i sse41  (__m128i x, T) { return x; }
+            template<typename T> HWM_ARITHMETIC_TARGET_AVX2  static __m256i avx2   (__m256i x, T) { return x; }
+            HWM_ARITHMETIC_TARGET_SSE41 static __m128i  sse41   (__m128i x, float)  { return _mm_castps_si128(_mm_cmplt_ps(_mm_castsi128_ps(x), _mm_setzero_ps())); }
+            HWM_ARITHMETIC_TARGET_SSE41 static __m128i  sse41   (__m128i x, double) { return _mm_castpd_si128(_mm_cmplt_pd(_mm_castsi128_pd(x), _mm_setzero_pd())); }
+            HWM_ARITHMETIC_TARGET_AVX2  static __m256i  avx2    (__m256i x, float)  { return _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(x), _mm256_setzero_ps(), _CMP_LT_OQ)); }
+            HWM_ARITHMETIC_TARGET_AVX2  static __m256i  avx2    (__m256i x, double) { return _mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(x), _mm256_setzero_pd(), _CMP_LT_OQ)); }
+#endif
+        };
+
+        template<> struct negative_op::has_simd<float>      : boost::true_type {};
+        template<> struct negative_op::has_simd<double>     : boost::true_type {};
+
+        //! sign(x) > 0.
+        struct positive_op
+        {
+            template<typename T>
+            static bool apply   (T const &x) { return sign(x) > 0; }
+
+            template<typename T> struct has_simd : is_simd_lane<T> {};
+
+#if defined HWM_ARITHMETIC_SIMD_X86
+            template<typename T> HWM_ARITHMETIC_TARGET_SSE41 static __m128i sse41  (__m128i x, T) { return integral(x, lane_size<sizeof(T)>(), boost::is_signed<T>()); }
+            template<typename T> HWM_ARITHMETIC_TARGET_AVX2  static __m256i avx2   (__m256i x, T) { return integral(x, lane_size<sizeof(T)>(), boost::is_signed<T>()); }
+            HWM_ARITHMETIC_TARGET_SSE41 static __m128i  sse41   (__m128i x, float)  { return _mm_castps_si128(_mm_cmpgt_ps(_mm_castsi128_ps(x), _mm_setzero_ps())); }
+            HWM_ARITHMETIC_TARGET_SSE41 static __m128i  sse41   (__m128i x, double) { return _mm_castpd_si128(_mm_cmpgt_pd(_mm_castsi128_pd(x), _mm_setzero_pd())); }
+            HWM_ARITHMETIC_TARGET_AVX2  static __m256i  avx2    (__m256i x, float)  { return _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(x), _mm256_setzero_ps(), _CMP_GT_OQ)); }
+            HWM_ARITHMETIC_TARGET_AVX2  static __m256i  avx2    (__m256i x, double) { return _mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(x), _mm256_setzero_pd(), _CMP_GT_OQ)); }
+
+        private:
+            //x > 0 is (0 - x) < 0 and x >= 0. (0 - min) is min, and min is negative.
+            template<std::size_t Size> HWM_ARITHMETIC_TARGET_SSE41 static __m128i integral  (__m128i x, lane_size<Size> s, boost::true_type)  { return _mm_andnot_si128(x, negate(x, s)); }
+            template<std::size_t Size> HWM_ARITHMETIC_TARGET_AVX2  static __m256i integral  (__m256i x, lane_size<Size> s, boost::true_type)  { return _mm256_andnot_si256(x, negate(x, s)); }
+            //unsigned x > 0 is x != 0.
+            template<std::size_t Size> HWM_ARITHMETIC_TARGET_SSE41 static __m128i integral  (__m128i x, lane_size<Size> s, boost::false_type) { return _mm_andnot_si128(is_zero(x, s), _mm_set1_epi32(-1)); }
+            template<std::size_t Size> HWM_ARITHMETIC_TARGET_AVX2  static __m256i integral  (__m256i x, lane_size<Size> s, boost::false_type) { return _mm256_andnot_si256(is_zero(x, s), _mm256_set1_epi32(-1)); }
+#endif
+        };
+
+        //! writes the masks of [first, last). the bits past the last element are zero.
+        template<typename Pred, typename T>
+        boost::uint64_t *
+                mask_scalar (T const *first, T const *last, boost::uint64_t *out)
+        {
+            while(first != last) {
+                std::size_t const rest = static_cast<std::size_t>(last - first);
+                std::size_t const n = (rest < 64) ? rest : 64;
+                boost::uint64_t bits = 0;
+                for(std::size_t i = 0; i < n; ++i) {
+                    bits |= static_cast<boost::uint64_t>(Pred::apply(first[i])) << i;
+                }
+                *out++ = bits;
+                first += n;
+            }
+            return out;
+        }
+
+#if defined HWM_ARITHMETIC_SIMD_X86
+        template<typename Pred, typename T>
+        HWM_ARITHMETIC_TARGET_SSE41
+        boost::uint64_t *
+                mask_sse41  (T const *first, T const *last, boost::uint64_t *out)
+        {
+            std::size_t const lanes = 16 / sizeof(T);
+            for( ; last - first >= 64; first += 64, ++out) {
+                boost::uint64_t bits = 0;
+                for(std::size_t i = 0; i < 64; i += lanes) {
+                    __m128i const x = _mm_loadu_si128(reinterpret_cast<__m128i const *>(first + i));
+                    bits |= static_cast<boost::uint64_t>(top_bits(Pred::sse41(x, T()), lane_size<sizeof(T)>())) << i;
+                }
+                *out = bits;
+            }
+            return mask_scalar<Pred>(first, last, out);
+        }
+
+        template<typename Pred, typename T>
+        HWM_ARITHMETIC_TARGET_AVX2
+        boost::uint64_t *
+                mask_avx2   (T const *first, T const *last, boost::uint64_t *out)
+        {
+            std::size_t const lanes = 32 / sizeof(T);
+            for( ; last - first >= 64; first += 64, ++out) {
+                boost::uint64_t bits = 0;
+                for(std::size_t i = 0; i < 64; i += lanes) {
+                    __m256i const x = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(first + i));
+                    bits |= static_cast<boost::uint64_t>(top_bits(Pred::avx2(x, T()), lane_size<sizeof(T)>())) << i;
+                }
+                *out = bits;
+            }
+            return mask_scalar<Pred>(first, last, out);
+        }
+#endif  //HWM_ARITHMETIC_SIMD_X86
+
+        template<typename Pred, typename T>
+        boost::uint64_t *
+                mask_batch  (
+                    T const *first, T const *last, boost::uint64_t *out,
+                    typename boost::disable_if_c<Pred::template has_simd<T>::value>::type* = 0 )
+        {
+            return mask_scalar<Pred>(first, last, out);
+        }
+
+        template<typename Pred, typename T>
+        boost::uint64_t *
+                mask_batch  (
+                    T const *first, T const *last, boost::uint64_t *out,
+                    typename boost::enable_if_c<Pred::template has_simd<T>::value>::type* = 0 )
+        {
+            BOOST_ASSERT(first <= last);
+#if defined HWM_ARITHMETIC_SIMD_X86
+            switch(current_simd_level()) {
+            case simd_avx2:     return mask_avx2<Pred>(first, last, out);
+            case simd_sse41:    return mask_sse41<Pred>(first, last, out);
+            default:            break;
+            }
+#endif
+            return mask_scalar<Pred>(first, last, out);
+        }
+
+        //! counts the elements by the masks of blocks on the stack.
+        template<typename Pred, typename T>
+        std::size_t count_batch (T const *first, T const *last);
+
+        //! the sign of a value without branches.
+        //! the result is an int, so that a float is not converted back from its own type.
+        template<typename T>
+        int     sign_value  (T const &x, boost::true_type)  { return static_cast<int>(x > 0) - static_cast<int>(x < 0); }
+
+        template<typename T>
+        int     sign_value  (T const &x, boost::false_type) { return static_cast<int>(x != 0); }
+
+        //! abs of a signed integral value by the sign mask. abs(min) wraps around to min.
+        template<typename T>
+        T       abs_value   (T const &x, boost::true_type)  { return integral_division<T>::abs(x); }
+
+        template<typename T>
+        T       abs_value   (T const &x, boost::false_type) { return abs(x); }
+    }   //namespace detail
+    //! @endcond
+
+    //============================================================================//
+    //! @defgroup bitmask Bitmasks.
+    //! a bitmask of n elements is an array of bitmask_size(n) words,
+    //! where the bit (i % 64) of the word (i / 64) is the predicate of the element i.
+    //! the bits past the last element are zero.
+    //! @{
+    //============================================================================//
+
+    //! @return the number of words of the bitmask of n elements.
+    inline
+    std::size_t bitmask_size            (std::size_t n) { return (n + 63) / 64; }
+
+    //! @return the number of the set bits of [first, last), by popcount.
+    inline
+    std::size_t count_bits              (boost::uint64_t const *first, boost::uint64_t const *last)
+    {
+        BOOST_ASSERT(first <= last);
+#if defined HWM_ARITHMETIC_SIMD_X86
+        if(current_simd_level() == simd_avx2) { return detail::count_bits_popcnt(first, last); }
+#endif
+        return detail::count_bits_scalar(first, last);
+    }
+
+    //! @brief copy the elements of [first, last) whose bits in `mask' are set to the range beginning at `out'.
+    //! the set bits are scanned by count trailing zeros, so the cost depends on the number of the selected elements,
+    //! and there is no branch for each element.
+    //! `out' may be equal to `first'.
+    //! @return the end of the output range.
+    template<typename T, typename U>
+    U *     select                      (T const *first, T const *last, boost::uint64_t const *mask, U *out)
+    {
+        BOOST_ASSERT(first <= last);
+        std::size_t const n = static_cast<std::size_t>(last - first);
+        for(std::size_t w = 0; w * 64 < n; ++w) {
+            T const * const base = first + w * 64;
+            for(boost::uint64_t bits = mask[w]; bits != 0; bits &= bits - 1) {
+                *out++ = static_cast<U>(base[detail::count_trailing_zeros(bits)]);
+            }
+        }
+        return out;
+    }
+
+    //! @brief write the indices of the set bits of [first, last) in increasing order to the range beginning at `out'.
+    //! @return the end of the output range.
+    template<typename U>
+    U *     select_indices              (boost::uint64_t const *first, boost::uint64_t const *last, U *out)
+    {
+        BOOST_ASSERT(first <= last);
+        for(std::size_t w = 0; first + w != last; ++w) {
+            for(boost::uint64_t bits = first[w]; bits != 0; bits &= bits - 1) {
+                *out++ = static_cast<U>(w * 64 + static_cast<std::size_t>(detail::count_trailing_zeros(bits)));
+            }
+        }
+        return out;
+    }
+
+    //============================================================================//
+    //! @}
+    //  enddef of bitmask
+    //============================================================================//
+
+    //============================================================================//
+    //! @defgroup batch_predicate Bulk Predicates.
+    //! write the bitmask of a predicate of each element of [first, last) to the array beginning at `out'.
+    //! `out' must have bitmask_size(last - first) words.
+    //! the predicates are the same as the scalar functions. (odd(x), even(x), sign(x) < 0 and sign(x) > 0)
+    //! integral types of 8, 16, 32 and 64 bits, float and double use SSE4.1 / AVX2 kernels, with compare and movemask.
+    //! @return the end of the bitmask.
+    //! @{
+    //============================================================================//
+
+    //! @brief bulk version of odd.
+    template<typename T>
+    boost::uint64_t *
+            odd_mask                    (T const *first, T const *last, boost::uint64_t *out)
+    {
+        return detail::mask_batch<detail::odd_op>(first, last, out);
+    }
+
+    //! @brief bulk version of even.
+    template<typename T>
+    boost::uint64_t *
+            even_mask                   (T const *first, T const *last, boost::uint64_t *out)
+    {
+        return detail::mask_batch<detail::even_op>(first, last, out);
+    }
+
+    //! @brief bulk version of sign(x) < 0.
+    template<typename T>
+    boost::uint64_t *
+            negative_mask               (T const *first, T const *last, boost::uint64_t *out)
+    {
+        return detail::mask_batch<detail::negative_op>(first, last, out);
+    }
+
+    //! @brief bulk version of sign(x) > 0.
+    template<typename T>
+    boost::uint64_t *
+            positive_mask               (T const *first, T const *last, boost::uint64_t *out)
+    {
+        return detail::mask_batch<detail::positive_op>(first, last, out);
+    }
+
+    //! @return the number of the odd elements of [first, last).
+    template<typename T>
+    std::size_t count_odd               (T const *first, T const *last) { return detail::count_batch<detail::odd_op>(first, last); }
+
+    //! @return the number of the even elements of [first, last).
+    template<typename T>
+    std::size_t count_even              (T const *first, T const *last) { return detail::count_batch<detail::even_op>(first, last); }
+
+    //! @return the number of the elements of [first, last) where sign(x) < 0.
+    template<typename T>
+    std::size_t count_negative          (T const *first, T const *last) { return detail::count_batch<detail::negative_op>(first, last); }
+
+    //! @return the number of the elements of [first, last) where sign(x) > 0.
+    template<typename T>
+    std::size_t count_positive          (T const *first, T const *last) { return detail::count_batch<detail::positive_op>(first, last); }
+
+    //============================================================================//
+    //! @}
+    //  enddef of batch_predicate
+    //============================================================================//
+
+    //============================================================================//
+    //! @defgroup batch_sign Bulk Sign and Abs.
+    //! write the results of each element of [first, last) to the range beginning at `out'.
+    //! the loops have no branches, so that a compiler can vectorize them.
+    //! `out' may be equal to `first' if T and U are the same type.
+    //! @return the end of the output range.
+    //! @{
+    //============================================================================//
+
+    //! @brief bulk version of sign. the results are -1, 0 or 1 converted to U.
+    template<typename T, typename U>
+    U *     sign                        (T const *first, T const *last, U *out)
+    {
+        BOOST_ASSERT(first <= last);
+        typedef boost::integral_constant<bool, !boost::is_integral<T>::value || boost::is_signed<T>::value> is_signed_type;
+        std::size_t const n = static_cast<std::size_t>(last - first);
+        for(std::size_t i = 0; i < n; ++i) {
+            out[i] = static_cast<U>(detail::sign_value(first[i], is_signed_type()));
+        }
+        return out + n;
+    }
+
+    //! @brief bulk version of abs.
+    //! the result of the minimum value of a signed type is the minimum value.
+    template<typename T>
+    T *     abs                         (T const *first, T const *last, T *out)
+    {
+        BOOST_ASSERT(first <= last);
+        typedef boost::integral_constant<bool, boost::is_integral<T>::value && boost::is_signed<T>::value> is_signed_integral;
+        std::size_t const n = static_cast<std::size_t>(last - first);
+        for(std::size_t i = 0; i < n; ++i) {
+            out[i] = detail::abs_value(first[i], is_signed_integral());
+        }
+        return out + n;
+    }
+
+    //============================================================================//
+    //! @}
+    //  enddef of batch_sign
+    //============================================================================//
+
+    //! @cond DETAIL
+    namespace detail
+    {
+        template<typename Pred, typename T>
+        std::size_t count_batch (T const *first, T const *last)
+        {
+            BOOST_ASSERT(first <= last);
+            std::size_t const block = 16 * 64;
+            boost::uint64_t mask[block / 64];
+            std::size_t n = 0;
+            while(first != last) {
+                std::size_t const rest = static_cast<std::size_t>(last - first);
+                std::size_t const length = (rest < block) ? rest : block;
+                n += count_bits(mask, mask_batch<Pred>(first, first + length, mask));
+                first += length;
+            }
+            return n;
+        }
+    }   //namespace detail
+    //! @endcond
+
+}}  //namespace hwm::arithmetic
+
+#endif  //HWM_ARITHMETIC_PREDICATE_HPP
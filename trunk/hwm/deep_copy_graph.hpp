@@ -0,0 +1,255 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+//! Cloning a graph of deep_copy_ptrs which share their pointees with deep_copy_policy::cow,
+//! so that a pointee shared in the source is cloned once and shared in the same way in the clone.
+//! requires Boost.Thread, for the context of each thread. (link boost_thread and boost_system)
+
+//! @file
+
+#ifndef HWM_DEEPCOPYGRAPH_HPP
+#define HWM_DEEPCOPYGRAPH_HPP
+
+#include <cstddef>
+#include <vector>
+#include <boost/assert.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/tss.hpp>
+
+#include "deep_copy_ptr.hpp"
+
+namespace hwm {
+
+class deep_copy_graph_context;
+
+//undocumented.
+//! @cond NOT_GENERATED
+namespace detail {
+
+//! the clone of each shared holder, by the holder of the source.
+//! open addressing with linear probing in one array, so that a lookup in a large graph is one or two cache misses,
+//! not a node of a bucket list. holds a reference to each clone until cleared.
+class deep_copy_graph_map
+    :   boost::noncopyable
+{
+    struct entry
+    {
+        deep_copy_ptr_holder_base const    *source;
+        deep_copy_ptr_holder_base          *clone;
+    };
+
+    typedef deep_copy_ptr_ownership<deep_copy_policy::cow>  ownership;
+
+public:
+    deep_copy_graph_map     () : size_(0), shift_(64) {}
+    ~deep_copy_graph_map    () { clear(); }
+
+    std::size_t                 size    () const { return size_; }
+
+    //! @return the clone of `source', or null.
+    deep_copy_ptr_holder_base * find    (deep_copy_ptr_holder_base const *source) const
+    {
+        if(size_ == 0) { return 0; }
+        std::size_t const mask = entries_.size() - 1;
+        for(std::size_t i = index_of(source); ; i = (i + 1) & mask) {
+            entry const &e = entries_[i];
+            if(e.source == source) { return e.clone; }
+            if(!e.source) { return 0; }
+        }
+    }
+
+    //! add `source', which is not in the map, and take a reference of `clone'.
+    void                        insert  (deep_copy_ptr_holder_base const *source, deep_copy_ptr_holder_base *clone)
+    {
+        BOOST_ASSERT(source && clone && !find(source));
+        if((size_ + 1) * 2 > entries_.size()) { rehash((size_ + 1) * 2); }
+        place(source, ownership::share(clone));
+        ++size_;
+    }
+
+    //! make room for `n' sources without a rehash.
+    void                        reserve (std::size_t n)
+    {
+        if(n * 2 > entries_.size()) { rehash(n * 2); }
+    }
+
+    //! release the clones. the array is kept.
+    void                        clear   ()
+    {
+        for(std::size_t i = 0; i < entries_.size(); ++i) {
+            entry &e = entries_[i];
+            if(e.source) {
+                ownership::release(e.clone);
+                e.source = 0;
+                e.clone = 0;
+            }
+        }
+        size_ = 0;
+    }
+
+private:
+    //! the page of `source' by fibonacci hashing, plus the offset in the page.
+    //! the holders in a page, which are mostly cloned one after another, are looked up in a few lines of the array,
+    //! and the pages, or the holders of a large stride, are spread over it.
+    std::size_t                 index_of    (deep_copy_ptr_holder_base const *source) const
+    {
+        boost::uint64_t const x = static_cast<boost::uint64_t>(reinterpret_cast<std::size_t>(source));
+        boost::uint64_t const page = ((x >> 12) * UINT64_C(0x9E3779B97F4A7C15)) >> shift_;
+        return static_cast<std::size_t>((page + ((x >> 4) & 255)) & (entries_.size() - 1));
+    }
+
+    void                        place       (deep_copy_ptr_holder_base const *source, deep_copy_ptr_holder_base *clone)
+    {
+        std::size_t const mask = entries_.size() - 1;
+        std::size_t i = index_of(source);
+        while(entries_[i].source) { i = (i + 1) & mask; }
+        entries_[i].source = source;
+        entries_[i].clone = clone;
+    }
+
+    //! grow to a power of two, at least `n' and 16.
+    void                        rehash      (std::size_t n)
+    {
+        std::size_t capacity = 16;
+        int bits = 4;
+        while(capacity < n) { capacity *= 2; ++bits; }
+
+        entry const empty = { 0, 0 };
+        std::vector<entry> old(capacity, empty);
+        old.swap(entries_);
+        shift_ = 64 - bits;
+        for(std::size_t i = 0; i < old.size(); ++i) {
+            if(old[i].source) { place(old[i].source, old[i].clone); }
+        }
+    }
+
+    std::vector<entry>  entries_;
+    std::size_t         size_;
+    int                 shift_;
+};
+
+//! the context of the calling thread, while deep_copy_graph_context::clone runs.
+class deep_copy_graph_scope
+    :   boost::noncopyable
+{
+public:
+    explicit deep_copy_graph_scope  (deep_copy_graph_context &ctx) : previous_(slot().get())
+    {
+        slot().reset(&ctx);
+    }
+    ~deep_copy_graph_scope          () { slot().reset(previous_); }
+
+    static deep_copy_graph_context *    current () { return slot().get(); }
+
+    //! constructed by the first context, before the threads use it.
+    static boost::thread_specific_ptr<deep_copy_graph_context> &
+                                        slot    ()
+    {
+        static boost::thread_specific_ptr<deep_copy_graph_context> s(&no_cleanup);
+        return s;
+    }
+
+private:
+    static void no_cleanup  (deep_copy_graph_context *) {}
+
+    deep_copy_graph_context *previous_;
+};
+
+}   //namespace detail
+//! @endcond
+
+//! The pointees already cloned by a graph clone, by their sources.
+//! a deep_copy_ptr with deep_copy_policy::cow may share its pointee with the others,
+//! and the copy constructor and deep_copy_ptr(rhs, r) clone it again for each of them,
+//! so a DAG is cloned as a tree, which may be exponentially larger.
+//! clone() clones each shared pointee once, and makes the clones share it as the sources did,
+//! so that the clone of a DAG takes O(V + E).
+//! the pointees which are not shared are cloned without the lookup.
+//! a context is used by one thread, and keeps the clones across the calls of clone(),
+//! so that the roots which share the pointees are cloned sharing them, until clear().
+//! the sources must not be modified or destroyed while they are in the context.
+class deep_copy_graph_context
+    :   boost::noncopyable
+{
+public:
+    //! @brief clone into `r', or with the global new if `r' is null.
+    explicit    deep_copy_graph_context (deep_copy_memory_resource *r = 0)
+        :   resource_(r ? r : detail::deep_copy_new_delete_resource::instance())
+    {
+        detail::deep_copy_graph_scope::slot();
+    }
+
+    //! @brief Clone `src', and the graph of the pointees reached by graph_clone from it.
+    template<class T>
+    deep_copy_ptr<T, deep_copy_policy::cow>
+                clone       (deep_copy_ptr<T, deep_copy_policy::cow> const &src);
+
+    deep_copy_memory_resource *
+                resource    () const { return resource_; }
+
+    //! @brief the number of the shared pointees cloned.
+    std::size_t size        () const { return clones_.size(); }
+
+    //! @brief make room for `n' shared pointees, for a large graph.
+    void        reserve     (std::size_t n) { clones_.reserve(n); }
+
+    //! @brief Forget the clones. the next clone() clones every pointee again.
+    void        clear       () { clones_.clear(); }
+
+    //! @brief the context of the clone() running on the calling thread, or null.
+    static deep_copy_graph_context *
+                current     () { return detail::deep_copy_graph_scope::current(); }
+
+private:
+    template<class T>
+    friend deep_copy_ptr<T, deep_copy_policy::cow>
+                graph_clone (deep_copy_ptr<T, deep_copy_policy::cow> const &src, deep_copy_memory_resource *r);
+
+    deep_copy_memory_resource  *resource_;
+    detail::deep_copy_graph_map clones_;
+};
+
+//! @brief Clone `src' into `r', keeping the sharing of the pointees, in the current context if any.
+//! call this in the resource constructors of the pointees (see deep_copy_uses_resource),
+//! for the deep_copy_ptrs which may share, in place of deep_copy_ptr(rhs, r).
+//! without a context, it is the same as deep_copy_ptr(rhs, r), and every pointee is cloned.
+template<class T>
+deep_copy_ptr<T, deep_copy_policy::cow>
+            graph_clone (deep_copy_ptr<T, deep_copy_policy::cow> const &src, deep_copy_memory_resource *r)
+{
+    typedef deep_copy_ptr<T, deep_copy_policy::cow> ptr_type;
+    typedef detail::deep_copy_ptr_access access;
+
+    deep_copy_graph_context * const ctx = deep_copy_graph_context::current();
+    detail::deep_copy_ptr_holder_base * const h = access::holder(src);
+    if(!ctx) { return ptr_type(src, r); }
+    //a null `r' would clone by the copy constructor, which shares the pointees reached from *src.
+    if(!r) { r = ctx->resource(); }
+    //a pointee of one deep_copy_ptr can not be reached again.
+    if(!h || h->use_count() == 1) { return ptr_type(src, r); }
+
+    ptr_type result;
+    if(detail::deep_copy_ptr_holder_base * const found = ctx->clones_.find(h)) {
+        access::share(result, found);
+    } else {
+        //the pointees reached from *src are cloned first, and may grow the map.
+        ptr_type(src, r).swap(result);
+        ctx->clones_.insert(h, access::holder(result));
+    }
+    return result;
+}
+
+template<class T>
+deep_copy_ptr<T, deep_copy_policy::cow>
+            deep_copy_graph_context::clone  (deep_copy_ptr<T, deep_copy_policy::cow> const &src)
+{
+    detail::deep_copy_graph_scope const scope(*this);
+    return graph_clone(src, resource_);
+}
+
+}   //hwm
+
+#endif  //HWM_DEEPCOPYGRAPH_HPP
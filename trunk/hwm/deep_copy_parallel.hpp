@@ -0,0 +1,292 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+//! Cloning ranges and trees of deep_copy_ptr on the threads of a thread_pool.
+//! requires Boost.Thread. (see thread_pool.hpp)
+
+//! @file
+
+#ifndef HWM_DEEPCOPYPARALLEL_HPP
+#define HWM_DEEPCOPYPARALLEL_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+#include <boost/assert.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+
+#include "deep_copy_ptr.hpp"
+#include "thread_pool.hpp"
+
+namespace hwm {
+
+class deep_copy_parallel_context;
+
+//undocumented.
+//! @cond NOT_GENERATED
+namespace detail {
+
+//! the clones which a nested parallel_clone has assigned when a clone threw.
+//! they were allocated in the resources of several threads, which may still be cloning,
+//! so they are destroyed by the outermost parallel_clone after the threads have joined.
+class deep_copy_parallel_garbage
+    :   boost::noncopyable
+{
+    typedef void (*release_type)(deep_copy_ptr_holder_base *h);
+
+    struct entry
+    {
+        deep_copy_ptr_holder_base  *holder;
+        release_type                release;
+    };
+
+public:
+    ~deep_copy_parallel_garbage () { release(); }
+
+    //! take the deep_copy_ptrs of [out, out + count) out, which become null.
+    template<class OutputIterator>
+    void    bury    (OutputIterator out, std::size_t count)
+    {
+        typedef typename std::iterator_traits<OutputIterator>::value_type   ptr_type;
+        typedef typename ptr_type::policy_type                              policy_type;
+
+        boost::lock_guard<boost::mutex> lock(mutex_);
+        entries_.reserve(entries_.size() + count);
+        for(std::size_t i = 0; i < count; ++i, ++out) {
+            if(deep_copy_ptr_holder_base * const h = deep_copy_ptr_access::release(*out)) {
+                entry const e = { h, &deep_copy_ptr_ownership<policy_type>::release };
+                entries_.push_back(e);
+            }
+        }
+    }
+
+    //! destroy the clones. called when no thread is cloning.
+    void    release ()
+    {
+        std::vector<entry> entries;
+        {
+            boost::lock_guard<boost::mutex> lock(mutex_);
+            entries.swap(entries_);
+        }
+        for(std::size_t i = 0; i < entries.size(); ++i) { entries[i].release(entries[i].holder); }
+    }
+
+private:
+    boost::mutex        mutex_;
+    std::vector<entry>  entries_;
+};
+
+//! the context of the calling thread while it runs a chunk, and the number of the pieces
+//! which the outermost range has been split into so far, along the nested ranges down to the chunk.
+class deep_copy_parallel_scope
+    :   boost::noncopyable
+{
+public:
+    deep_copy_parallel_scope    (deep_copy_parallel_context &ctx, std::size_t pieces)
+        :   ctx_(&ctx), pieces_(pieces), previous_(current())
+    {
+        slot().reset(this);
+    }
+    ~deep_copy_parallel_scope   () { slot().reset(previous_); }
+
+    deep_copy_parallel_context &    context () const { return *ctx_; }
+    std::size_t                     pieces  () const { return pieces_; }
+
+    static deep_copy_parallel_scope *   current () { return slot().get(); }
+
+    //! constructed by the first context, before the threads use it.
+    static boost::thread_specific_ptr<deep_copy_parallel_scope> &
+                                        slot    ()
+    {
+        static boost::thread_specific_ptr<deep_copy_parallel_scope> s(&no_cleanup);
+        return s;
+    }
+
+private:
+    static void no_cleanup  (deep_copy_parallel_scope *) {}
+
+    deep_copy_parallel_context  *ctx_;
+    std::size_t                 pieces_;
+    deep_copy_parallel_scope    *previous_;
+};
+
+}   //namespace detail
+//! @endcond
+
+//! The threads and the memory resources of parallel_clone.
+//! each thread of the pool clones with its own resource, so that the threads do not share an allocator.
+//! a context must be used by one parallel_clone at a time, and the resources must outlive the clones.
+//! while parallel_clone runs, a resource is used only by its thread, as parallel_clone destroys
+//! the old elements of the output, and the clones assigned before a clone threw, after the threads have joined.
+//! a resource constructor must therefore not throw after its own parallel_clone returned,
+//! or it destroys the clones of the other threads while they may be cloning; otherwise the resources must be synchronized.
+class deep_copy_parallel_context
+    :   boost::noncopyable
+{
+public:
+    //! @brief clone with the global new.
+    explicit    deep_copy_parallel_context  (thread_pool &pool)
+        :   pool_(&pool)
+        ,   resources_(pool.size(), detail::deep_copy_new_delete_resource::instance())
+    {
+        detail::deep_copy_parallel_scope::slot();
+    }
+
+    //! @brief clone into `resources', pool.size() of them, indexed by thread_pool::thread_index().
+    //! a resource is used by one thread at a time, so it need not be synchronized. (see above)
+    deep_copy_parallel_context  (thread_pool &pool, deep_copy_memory_resource * const *resources)
+        :   pool_(&pool)
+        ,   resources_(resources, resources + pool.size())
+    {
+        detail::deep_copy_parallel_scope::slot();
+    }
+
+    thread_pool &   pool        () const { return *pool_; }
+
+    //! @brief the resource of the calling thread.
+    deep_copy_memory_resource *
+                    resource    () const { return resources_[pool_->thread_index()]; }
+
+    //! @brief the context of the parallel_clone running on the calling thread, or null.
+    static deep_copy_parallel_context *
+                    current     ()
+    {
+        detail::deep_copy_parallel_scope const *s = detail::deep_copy_parallel_scope::current();
+        return s ? &s->context() : 0;
+    }
+
+private:
+    template<class RandomAccessIterator, class OutputIterator>
+    friend void parallel_clone  (deep_copy_parallel_context &ctx, RandomAccessIterator first, RandomAccessIterator last, OutputIterator out);
+
+    thread_pool                                *pool_;
+    std::vector<deep_copy_memory_resource *>    resources_;
+    detail::deep_copy_parallel_garbage          garbage_;
+};
+
+//undocumented.
+//! @cond NOT_GENERATED
+namespace detail {
+
+//! clone each element of [first, last) into out, which is null, with `r'.
+//! an old element would be released into the resource of another thread.
+template<class InputIterator, class OutputIterator>
+void    deep_copy_serial_clone  (InputIterator first, InputIterator last, OutputIterator out, deep_copy_memory_resource *r)
+{
+    typedef typename std::iterator_traits<OutputIterator>::value_type ptr_type;
+    for( ; first != last; ++first, ++out) {
+        BOOST_ASSERT(!*out);
+        ptr_type(*first, r).swap(*out);
+    }
+}
+
+//! destroys the garbage at the end of the outermost parallel_clone, after the threads have joined.
+class deep_copy_parallel_garbage_guard
+    :   boost::noncopyable
+{
+public:
+    explicit deep_copy_parallel_garbage_guard   (deep_copy_parallel_garbage *garbage) : garbage_(garbage) {}
+    ~deep_copy_parallel_garbage_guard           () { if(garbage_) { garbage_->release(); } }
+
+private:
+    deep_copy_parallel_garbage *garbage_;
+};
+
+//! the elements of a chunk, with the resource and the context of the thread that runs it.
+template<class RandomAccessIterator, class OutputIterator>
+class deep_copy_parallel_chunk
+{
+public:
+    deep_copy_parallel_chunk    (deep_copy_parallel_context &ctx, RandomAccessIterator first, OutputIterator out, std::size_t count, std::size_t chunk, std::size_t pieces)
+        :   ctx_(&ctx), first_(first), out_(out), count_(count), chunk_(chunk), pieces_(pieces)
+    {}
+
+    void    operator()  (std::size_t i) const
+    {
+        deep_copy_parallel_scope const scope(*ctx_, pieces_);
+        std::size_t const begin = i * chunk_;
+        std::size_t const end = (count_ - begin < chunk_) ? count_ : begin + chunk_;
+        deep_copy_serial_clone(first_ + begin, first_ + end, out_ + begin, ctx_->resource());
+    }
+
+private:
+    deep_copy_parallel_context *ctx_;
+    RandomAccessIterator        first_;
+    OutputIterator              out_;
+    std::size_t                 count_;
+    std::size_t                 chunk_;
+    std::size_t                 pieces_;
+};
+
+//! enough pieces for each thread to take several, as the sizes of the pointees vary.
+inline std::size_t  deep_copy_parallel_pieces   (deep_copy_parallel_context const &ctx)
+{
+    return ctx.pool().size() * 8;
+}
+
+}   //namespace detail
+//! @endcond
+
+//! @brief Clone each deep_copy_ptr of [first, last) into [out, out + (last - first)), on the threads of `ctx'.
+//! each element is cloned as deep_copy_ptr(*first, ctx.resource()) on some thread, and swapped into *out.
+//! so the output is equal to the serial copy, element by element, except that the clones are not shared with cow.
+//! the old elements of the output are destroyed on the calling thread, after the threads have joined.
+//! a clone which calls parallel_clone(first, last, out, r) for the deep_copy_ptrs in it,
+//! e.g. a node of a tree for its children, is split on the same threads.
+//! if a clone throws, the first exception is rethrown, and the output is partially assigned.
+template<class RandomAccessIterator, class OutputIterator>
+void    parallel_clone  (deep_copy_parallel_context &ctx, RandomAccessIterator first, RandomAccessIterator last, OutputIterator out)
+{
+    typedef typename std::iterator_traits<OutputIterator>::value_type ptr_type;
+
+    std::size_t const count = static_cast<std::size_t>(last - first);
+    if(count == 0) { return; }
+    detail::deep_copy_parallel_scope const *outer = detail::deep_copy_parallel_scope::current();
+    bool const nested = outer && &outer->context() == &ctx;
+
+    //declared before `old', so that the old elements are destroyed first. both after the threads have joined.
+    detail::deep_copy_parallel_garbage_guard const guard(nested ? 0 : &ctx.garbage_);
+    std::vector<ptr_type> old;
+    if(!nested) {
+        old.resize(count);
+        for(std::size_t i = 0; i < count; ++i) { old[i].swap(out[i]); }
+    }
+
+    std::size_t const pieces = (nested ? outer->pieces() : 1) * count;
+    std::size_t const per_chunk = count / detail::deep_copy_parallel_pieces(ctx);
+    std::size_t const chunk = (per_chunk == 0) ? 1 : per_chunk;
+    try {
+        ctx.pool().for_each_index(
+            (count + chunk - 1) / chunk,
+            detail::deep_copy_parallel_chunk<RandomAccessIterator, OutputIterator>(ctx, first, out, count, chunk, pieces) );
+    } catch(...) {
+        //the enclosing clone unwinds on this thread, while the other threads may still be cloning.
+        if(nested) { ctx.garbage_.bury(out, count); }
+        throw;
+    }
+}
+
+//! @brief Clone each deep_copy_ptr of [first, last) into [out, out + (last - first)), which are null,
+//! on the threads of the current context, or serially with `r'.
+//! call this in the resource constructors of the pointees (see deep_copy_uses_resource), to clone a tree in parallel.
+//! the range is split while the enclosing ranges have been split into fewer pieces than
+//! several for each thread, and is cloned serially below, as a loop costs more than a small pointee.
+template<class RandomAccessIterator, class OutputIterator>
+void    parallel_clone  (RandomAccessIterator first, RandomAccessIterator last, OutputIterator out, deep_copy_memory_resource *r)
+{
+    detail::deep_copy_parallel_scope const *s = detail::deep_copy_parallel_scope::current();
+    if(s && last - first > 1 && s->pieces() < detail::deep_copy_parallel_pieces(s->context())) {
+        parallel_clone(s->context(), first, last, out);
+    } else {
+        detail::deep_copy_serial_clone(first, last, out, r);
+    }
+}
+
+}   //hwm
+
+#endif  //HWM_DEEPCOPYPARALLEL_HPP
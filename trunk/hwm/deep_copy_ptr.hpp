@@ -12,55 +12,394 @@
 #ifndef HWM_DEEPCOPYPTR_HPP
 #define HWM_DEEPCOPYPTR_HPP
 
+#include <cstddef>
 #include <memory>
+#include <new>
 #include <boost/assert.hpp>
+#include <boost/atomic.hpp>
+#include <boost/config.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/move/core.hpp>
+#include <boost/move/unique_ptr.hpp>
+#include <boost/move/utility_core.hpp>
 #include <boost/noncopyable.hpp>
 #include <boost/operators.hpp>
+#include <boost/preprocessor/arithmetic/inc.hpp>
+#include <boost/preprocessor/repetition/enum_binary_params.hpp>
+#include <boost/preprocessor/repetition/enum_params.hpp>
+#include <boost/preprocessor/repetition/repeat_from_to.hpp>
+#include <boost/smart_ptr/detail/atomic_count.hpp>
+#include <boost/type_traits/alignment_of.hpp>
+#include <boost/type_traits/integral_constant.hpp>
 
 #include "safe_bool.hpp"
 
+//default
+//without variadic templates, make_deep_copy and the in-place constructor of deep_copy_ptr take up to 5 arguments.
+
+//definition
+//HWM_DEEP_COPY_PTR_MAX_ARITY   //<= the maximum number of the arguments without variadic templates.
+
+#if !defined HWM_DEEP_COPY_PTR_MAX_ARITY
+    #define HWM_DEEP_COPY_PTR_MAX_ARITY 5
+#endif
+
+#if !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES) && !defined(BOOST_NO_CXX11_RVALUE_REFERENCES)
+    #define HWM_DEEP_COPY_PTR_VARIADIC
+#endif
+
+//default
+//deep_copy_ptr clones into boost::container::pmr::memory_resource.
+
+//definition
+//HWM_DEEP_COPY_PTR_STD_PMR     //<= clones into std::pmr::memory_resource instead. requires C++17.
+
+#if defined(HWM_DEEP_COPY_PTR_STD_PMR)
+    #include <memory_resource>
+#else
+    #include <boost/container/pmr/memory_resource.hpp>
+#endif
+
 namespace hwm {
 
+//! @brief the memory resource which a deep_copy_ptr can be cloned into.
+#if defined(HWM_DEEP_COPY_PTR_STD_PMR)
+typedef std::pmr::memory_resource                   deep_copy_memory_resource;
+#else
+typedef boost::container::pmr::memory_resource      deep_copy_memory_resource;
+#endif
+
+//! @brief specialize as boost::true_type for Y which has the constructor Y(Y const &, deep_copy_memory_resource *),
+//! so that the clone of Y into a memory resource passes it down to the deep_copy_ptrs in Y.
+template<typename Y>
+struct deep_copy_uses_resource : boost::false_type {};
+
+//! @brief specialize as boost::true_type for T, before deep_copy_ptr<T> is used,
+//! so that deep_copy_ptr<T> caches the hash of its pointee, and operator== rejects the different hashes first.
+//! the hash is boost::hash<T>, i.e. hash_value(T const &).
+template<typename T>
+struct deep_copy_cached_hash : boost::false_type {};
+
+//! @brief a tag to construct the pointee of a deep_copy_ptr as Y in place.
+//! e.g. deep_copy_ptr<B> p(in_place_type<C>(), "this is C", 1);
+template<typename Y>
+struct in_place_type {};
+
+//! policies of deep_copy_ptr.
+namespace deep_copy_policy {
+
+    //! @brief every copy clones the pointee.
+    struct clone {};
+
+    //! @brief copy-on-write. the copies share the pointee through an atomic reference count,
+    //! and the first non-const access to a shared pointee clones it.
+    struct cow {};
+
+}   //namespace deep_copy_policy
+
 //undocumented.
 //! @cond NOT_GENERATED
 namespace detail {
 
+class deep_copy_ptr_holder_base;
+struct deep_copy_ptr_access;
+
+//! the operations of a holder, for each type of the holder.
+//! called through a static table in place of the virtual functions.
+struct deep_copy_ptr_holder_ops
+{
+    //! a holder of the copy of the pointee of `h', allocated in `r', or with the global new if `r' is null.
+    deep_copy_ptr_holder_base * (*clone)    (deep_copy_ptr_holder_base const *h, deep_copy_memory_resource *r);
+    //! destroy and deallocate `h', by the way it was allocated.
+    void                        (*destroy)  (deep_copy_ptr_holder_base *h);
+    //! the pointee of `h', as T *.
+    void *                      (*get)      (deep_copy_ptr_holder_base *h);
+};
+
+//! the global new, as a resource, so that a pointee of deep_copy_uses_resource is cloned
+//! by its resource constructor, which a null resource skips. (see deep_copy_parallel.hpp and deep_copy_graph.hpp)
+class deep_copy_new_delete_resource
+    :   public deep_copy_memory_resource
+{
+public:
+    static deep_copy_new_delete_resource *  instance    ()
+    {
+        static deep_copy_new_delete_resource r;
+        return &r;
+    }
+
+private:
+    virtual void *  do_allocate     (std::size_t bytes, std::size_t)    { return ::operator new(bytes); }
+    virtual void    do_deallocate   (void *p, std::size_t, std::size_t) { ::operator delete(p); }
+    virtual bool    do_is_equal     (deep_copy_memory_resource const &rhs) const BOOST_NOEXCEPT { return this == &rhs; }
+};
+
+//! destroys a holder by the way it was allocated.
+struct deep_copy_ptr_holder_deleter
+{
+    void    operator()  (deep_copy_ptr_holder_base *h) const;
+};
+
 class deep_copy_ptr_holder_base
     :   boost::noncopyable
 {
 public:
-    virtual ~deep_copy_ptr_holder_base      () {}
-    virtual std::auto_ptr<deep_copy_ptr_holder_base>
-                            clone           () const = 0;
-    virtual void *          get_ptr         () = 0;
-    virtual const void *    get_ptr         () const = 0;
+    typedef boost::movelib::unique_ptr<deep_copy_ptr_holder_base, deep_copy_ptr_holder_deleter>   holder_ptr;
+
+    //! @brief clone into `r', or with the global new if `r' is null.
+    holder_ptr              clone           (deep_copy_memory_resource *r) const { return holder_ptr(ops_->clone(this, r)); }
+    void *                  get_ptr         ()          { return ops_->get(this); }
+    //! @brief destroy and deallocate *this. the holders from the global new are deleted.
+    void                    destroy         ()          { ops_->destroy(this); }
+
+    //! the number of the deep_copy_ptrs sharing this holder. always 1 with deep_copy_policy::clone.
+    long                    use_count       () const { return refs_; }
+    void                    add_ref         () const { ++refs_; }
+    //! @return true if the last reference has gone.
+    bool                    release_ref     () const { return --refs_ == 0; }
+
+protected:
+    explicit deep_copy_ptr_holder_base      (deep_copy_ptr_holder_ops const &ops) : ops_(&ops), refs_(1) {}
+    ~deep_copy_ptr_holder_base              () {}
+
+private:
+    deep_copy_ptr_holder_ops const     *ops_;
+    mutable boost::detail::atomic_count refs_;
+};
+
+inline
+void    deep_copy_ptr_holder_deleter::operator()    (deep_copy_ptr_holder_base *h) const
+{
+    if(h) { h->destroy(); }
+}
+
+//! deallocates the storage from a memory resource unless released, for a constructor which throws.
+class deep_copy_resource_storage
+    :   boost::noncopyable
+{
+public:
+    deep_copy_resource_storage  (deep_copy_memory_resource *r, std::size_t size, std::size_t align)
+        :   r_(r), p_(r->allocate(size, align)), size_(size), align_(align) {}
+    ~deep_copy_resource_storage () { if(p_) { r_->deallocate(p_, size_, align_); } }
+
+    void *  get     () const    { return p_; }
+    void    release ()          { p_ = 0; }
+
+private:
+    deep_copy_memory_resource  *r_;
+    void                       *p_;
+    std::size_t                 size_;
+    std::size_t                 align_;
+};
+
+//! holds the pointee as a member, so that the holder and the pointee are one allocation.
+template <class T, class Y = T>
+class deep_copy_ptr_inline_holder
+    :   public deep_copy_ptr_holder_base
+{
+    typedef deep_copy_ptr_inline_holder<T, Y>   this_type;
+    typedef deep_copy_ptr_holder_base           base_type;
+
+    Y                           value_;
+    deep_copy_memory_resource  *resource_;  //null if allocated with the global new.
+
+    //! copy `src' allocated in `r', with the constructor which passes `r' down, or without.
+    deep_copy_ptr_inline_holder (Y const &src, deep_copy_memory_resource *r, boost::true_type)  : base_type(ops), value_(src, r), resource_(r) {}
+    deep_copy_ptr_inline_holder (Y const &src, deep_copy_memory_resource *r, boost::false_type) : base_type(ops), value_(src), resource_(r) {}
+
+public:
+#if defined(HWM_DEEP_COPY_PTR_VARIADIC)
+    template<class... Args>
+    explicit deep_copy_ptr_inline_holder    (Args &&... args) : base_type(ops), value_(boost::forward<Args>(args)...), resource_(0) {}
+#else
+    deep_copy_ptr_inline_holder             () : base_type(ops), value_(), resource_(0) {}
+
+    #define HWM_DEEP_COPY_PTR_INLINE_HOLDER_CTOR(z, n, unused)                             \
+        template<BOOST_PP_ENUM_PARAMS(n, class A)>                                          \
+        explicit deep_copy_ptr_inline_holder    (BOOST_PP_ENUM_BINARY_PARAMS(n, A, const &a)) \
+            :   base_type(ops), value_(BOOST_PP_ENUM_PARAMS(n, a)), resource_(0) {}
+
+    BOOST_PP_REPEAT_FROM_TO(1, BOOST_PP_INC(HWM_DEEP_COPY_PTR_MAX_ARITY), HWM_DEEP_COPY_PTR_INLINE_HOLDER_CTOR, ~)
+    #undef HWM_DEEP_COPY_PTR_INLINE_HOLDER_CTOR
+#endif
+
+    //! @brief a holder of the copy of `src', allocated in `r', or with the global new if `r' is null.
+    static base_type *      copy_of     (Y const &src, deep_copy_memory_resource *r)
+    {
+        if(!r) { return new this_type(src); }
+        deep_copy_resource_storage storage(r, sizeof(this_type), boost::alignment_of<this_type>::value);
+        this_type * const holder = ::new(storage.get()) this_type(src, r, typename deep_copy_uses_resource<Y>::type());
+        storage.release();
+        return holder;
+    }
+
+    static base_type *      clone       (base_type const *h, deep_copy_memory_resource *r)
+    {
+        return copy_of(static_cast<this_type const *>(h)->value_, r);
+    }
+
+    static void             destroy     (base_type *h)
+    {
+        this_type * const p = static_cast<this_type *>(h);
+        deep_copy_memory_resource * const r = p->resource_;
+        if(!r) { delete p; return; }
+        p->~this_type();
+        r->deallocate(p, sizeof(this_type), boost::alignment_of<this_type>::value);
+    }
+
+    static void *           get         (base_type *h) { return static_cast<T *>(&static_cast<this_type *>(h)->value_); }
+
+    static deep_copy_ptr_holder_ops const ops;
 };
 
+template <class T, class Y>
+deep_copy_ptr_holder_ops const deep_copy_ptr_inline_holder<T, Y>::ops = {
+    &deep_copy_ptr_inline_holder<T, Y>::clone,
+    &deep_copy_ptr_inline_holder<T, Y>::destroy,
+    &deep_copy_ptr_inline_holder<T, Y>::get
+};
+
+//! owns the pointee as Y, so that it is deleted as Y even if T has no virtual destructor.
+//! the clones are deep_copy_ptr_inline_holder, which need one allocation.
 template <class T, class Y = T>
 class deep_copy_ptr_holder
     :   public deep_copy_ptr_holder_base
 {
     typedef deep_copy_ptr_holder<T, Y>  this_type;
     typedef deep_copy_ptr_holder_base   base_type;
-    
-    std::auto_ptr<T> ptr_;              //pointer used by deep_copy_ptr
 
+    boost::movelib::unique_ptr<Y> ptr_; //pointer used by deep_copy_ptr
+
+    explicit deep_copy_ptr_holder   (Y *ptr) : base_type(ops), ptr_(ptr) {}
+
+public:
+    //! @brief take the ownership of `ptr', which must not be null.
+    //! `ptr' is deleted if the allocation of the holder throws.
+    static holder_ptr       create      (Y *ptr)
+    {
+        BOOST_ASSERT(ptr);
+        boost::movelib::unique_ptr<Y> guard(ptr);
+        this_type * const holder = new this_type(ptr);
+        guard.release();
+        return holder_ptr(holder);
+    }
+
+    static base_type *      clone       (base_type const *h, deep_copy_memory_resource *r)
+    {
+        return deep_copy_ptr_inline_holder<T, Y>::copy_of(*static_cast<this_type const *>(h)->ptr_, r);
+    }
+
+    static void             destroy     (base_type *h) { delete static_cast<this_type *>(h); }
+
+    static void *           get         (base_type *h) { return static_cast<T *>(static_cast<this_type *>(h)->ptr_.get()); }
+
+    static deep_copy_ptr_holder_ops const ops;
+};
+
+template <class T, class Y>
+deep_copy_ptr_holder_ops const deep_copy_ptr_holder<T, Y>::ops = {
+    &deep_copy_ptr_holder<T, Y>::clone,
+    &deep_copy_ptr_holder<T, Y>::destroy,
+    &deep_copy_ptr_holder<T, Y>::get
+};
+
+//! the hash of the pointee of deep_copy_ptr, computed each time.
+template<bool Cached>
+class deep_copy_ptr_hash_cache
+{
 public:
-    explicit deep_copy_ptr_holder   (Y  *ptr) : ptr_(ptr) {}
-    explicit deep_copy_ptr_holder   (std::auto_ptr<Y> p) : ptr_(p) {}
+    template<class T>
+    std::size_t     hash_of         (T const *p) const { return p ? boost::hash<T>()(*p) : 0; }
+    void            invalidate_hash () {}
 
-    std::auto_ptr<Y>    clone_detail() const    {
-        return
-            (ptr_.get())
-            ?   std::auto_ptr<Y>( new Y(static_cast<Y const &>(*ptr_.get())) )
-            :   std::auto_ptr<Y>();
+    //! @return false if the pointees `p' of *this and `q' of `rhs' are known to be different.
+    template<class T>
+    bool            may_equal       (T const *, deep_copy_ptr_hash_cache const &, T const *) const { return true; }
+};
+
+//! the hash of the pointee of deep_copy_ptr, computed on the first use,
+//! and kept until the pointee may be written.
+//! the const hash_of may run on several threads at once. they compute the same hash of the same pointee,
+//! so the hash is loaded and stored with no ordering, and a thread which sees no hash computes it again.
+template<>
+class deep_copy_ptr_hash_cache<true>
+{
+public:
+    deep_copy_ptr_hash_cache        () : hash_(not_computed) {}
+    deep_copy_ptr_hash_cache        (deep_copy_ptr_hash_cache const &rhs) : hash_(rhs.load()) {}
+    deep_copy_ptr_hash_cache &
+                    operator=       (deep_copy_ptr_hash_cache const &rhs)
+    {
+        store(rhs.load());
+        return *this;
     }
-    
-    virtual std::auto_ptr<base_type>
-                            clone       () const    { return std::auto_ptr<base_type>(new this_type(clone_detail())); }
 
-    virtual void *          get_ptr     ()          { return ptr_.get(); }
-    virtual const void *    get_ptr     () const    { return ptr_.get(); }
+    template<class T>
+    std::size_t     hash_of         (T const *p) const
+    {
+        std::size_t h = load();
+        if(h == not_computed) {
+            //a hash equal to the sentinel is computed each time.
+            h = p ? boost::hash<T>()(*p) : 0;
+            store(h);
+        }
+        return h;
+    }
+    void            invalidate_hash () { store(not_computed); }
+
+    template<class T>
+    bool            may_equal       (T const *p, deep_copy_ptr_hash_cache const &rhs, T const *q) const
+    {
+        return hash_of(p) == rhs.hash_of(q);
+    }
+
+private:
+    static std::size_t const not_computed = ~static_cast<std::size_t>(0);
+
+    std::size_t     load            () const { return hash_.load(boost::memory_order_relaxed); }
+    void            store           (std::size_t h) const { hash_.store(h, boost::memory_order_relaxed); }
+
+    mutable boost::atomic<std::size_t>  hash_;
+};
+
+//! how deep_copy_ptr copies, writes and releases its holder, for each policy.
+template<class Policy>
+struct deep_copy_ptr_ownership;
+
+template<>
+struct deep_copy_ptr_ownership<deep_copy_policy::clone>
+{
+    typedef deep_copy_ptr_holder_base   holder_base;
+
+    static holder_base *    share   (holder_base const *h) { return h ? h->clone(0).release() : 0; }
+    static holder_base *    unshare (holder_base *h) { return h; }
+    static void             release (holder_base *h) { if(h) { h->destroy(); } }
+};
+
+template<>
+struct deep_copy_ptr_ownership<deep_copy_policy::cow>
+{
+    typedef deep_copy_ptr_holder_base   holder_base;
+
+    static holder_base *    share   (holder_base const *h)
+    {
+        if(h) { h->add_ref(); }
+        return const_cast<holder_base *>(h);
+    }
+
+    //! @return `h' if it is not shared, or its clone. `h' is released only if the clone succeeded.
+    static holder_base *    unshare (holder_base *h)
+    {
+        if(!h || h->use_count() == 1) { return h; }
+        holder_base * const c = h->clone(0).release();
+        release(h);
+        return c;
+    }
+
+    static void             release (holder_base *h)
+    {
+        if(h && h->release_ref()) { h->destroy(); }
+    }
 };
 
 }   //namespace detail
@@ -69,67 +408,206 @@ public:
 //! A deep copy pointer
 //! @tparam T is pointer_type of deep_copy_pointer<T>.
 //! pointer that deep_copy_pointer<T> having evaluated T when pointer used, but when pointer will be copied, copied as a type that deep_copy_ptr had received(typename Y).
-template <class T>
+//! moving a deep_copy_ptr moves the pointer only, and the moved-from deep_copy_ptr becomes null.
+//! so a container relocates the elements without cloning them. (e.g. std::vector grows, std::sort swaps.)
+//! a deep_copy_ptr made by make_deep_copy or the in-place constructor, and every clone,
+//! allocates the pointee and its holder at once.
+//! the handle caches the pointer to the pointee, so get, -> and * are a load without an indirect call.
+//! the holder is cloned and destroyed through a static table of functions for its type, not a virtual table.
+//! @tparam Policy deep_copy_policy::clone or deep_copy_policy::cow.
+//! with deep_copy_policy::cow, copying shares the pointee, and the const get, -> and * never clone.
+//! the non-const get, -> and * clone the pointee first if it is shared,
+//! so a pointer or a reference taken from them must not be used for writing after *this is copied.
+//! the deep_copy_ptrs sharing a pointee may be read and copied on different threads at once,
+//! as far as the const member functions of T are safe for that.
+//! with deep_copy_cached_hash<T>, hash() and operator== cache the hash of the pointee in the handle,
+//! until the non-const get, -> or * is called. the copies take over the cached hash.
+//! the pointee must not be written through a pointer taken before the hash was cached.
+//! hash() and operator== may run on different threads at once, as the other const member functions.
+template <class T, class Policy = deep_copy_policy::clone>
 class deep_copy_ptr
-    :   public safe_bool< deep_copy_ptr<T> >
-    ,   public boost::equality_comparable< deep_copy_ptr<T> >
+    :   public safe_bool< deep_copy_ptr<T, Policy> >
+    ,   public boost::equality_comparable< deep_copy_ptr<T, Policy> >
+    ,   private detail::deep_copy_ptr_hash_cache< deep_copy_cached_hash<T>::value >
 {
+    BOOST_COPYABLE_AND_MOVABLE(deep_copy_ptr)
+
+    typedef detail::deep_copy_ptr_holder_base               holder_base;
+    typedef detail::deep_copy_ptr_ownership<Policy>         ownership;
+    typedef detail::deep_copy_ptr_hash_cache< deep_copy_cached_hash<T>::value > hash_cache;
+
+    template<class U, class P> friend class deep_copy_ptr;
+    friend struct detail::deep_copy_ptr_access;
+
 public:
-    typedef deep_copy_ptr<T>    this_type;
+    typedef deep_copy_ptr<T, Policy>    this_type;
+    typedef Policy                      policy_type;
     
 public:
     //! @brief Default constructor
-    deep_copy_ptr               () : holder_(new detail::deep_copy_ptr_holder<T>(0)) {}
+    //! the null pointer allocates nothing.
+    deep_copy_ptr               () BOOST_NOEXCEPT : holder_(), ptr_() {}
 
     //! @brief Construct from raw pointer.
     //! @tparam Y must be comparable to T.
     template<typename Y>
-    explicit    deep_copy_ptr   (Y *p) : holder_(new detail::deep_copy_ptr_holder<T, Y>(std::auto_ptr<Y>(p)))   {}
+    explicit    deep_copy_ptr   (Y *p) : holder_(make_holder(p).release()), ptr_(pointee_of(holder_)) {}
 
+#if !defined(BOOST_NO_CXX11_SMART_PTR) && !defined(BOOST_NO_CXX11_RVALUE_REFERENCES)
+    //! @brief Construct from unique_ptr.
+    //! @tparam Y must be comparable to T.
+    template<typename Y>
+    explicit    deep_copy_ptr   (std::unique_ptr<Y> &&p)
+        :   holder_(make_holder(p.get()).release()), ptr_(pointee_of(holder_)) { p.release(); }
+#else
     //! @brief Construct from auto_ptr.
     //! @tparam Y must be comparable to T.
     template<typename Y>
-    explicit    deep_copy_ptr   (std::auto_ptr<Y> p) : holder_(new detail::deep_copy_ptr_holder<T, Y>(p))       {}
+    explicit    deep_copy_ptr   (std::auto_ptr<Y> p)
+        :   holder_(make_holder(p.get()).release()), ptr_(pointee_of(holder_)) { p.release(); }
+#endif
+
+#if defined(HWM_DEEP_COPY_PTR_VARIADIC)
+    //! @brief Construct the pointee as Y in place, from `args'.
+    //! @tparam Y must be comparable to T.
+    template<typename Y, typename... Args>
+    explicit    deep_copy_ptr   (in_place_type<Y>, Args &&... args)
+        :   holder_(new detail::deep_copy_ptr_inline_holder<T, Y>(boost::forward<Args>(args)...)), ptr_(pointee_of(holder_)) {}
+#else
+    //! @brief Construct the pointee as Y in place.
+    //! @tparam Y must be comparable to T.
+    template<typename Y>
+    explicit    deep_copy_ptr   (in_place_type<Y>)
+        :   holder_(new detail::deep_copy_ptr_inline_holder<T, Y>()), ptr_(pointee_of(holder_)) {}
+
+    #define HWM_DEEP_COPY_PTR_IN_PLACE_CTOR(z, n, unused)                                          \
+        template<typename Y, BOOST_PP_ENUM_PARAMS(n, typename A)>                                   \
+        deep_copy_ptr   (in_place_type<Y>, BOOST_PP_ENUM_BINARY_PARAMS(n, A, const &a))             \
+            :   holder_(new detail::deep_copy_ptr_inline_holder<T, Y>(BOOST_PP_ENUM_PARAMS(n, a)))    \
+            ,   ptr_(pointee_of(holder_)) {}
+
+    BOOST_PP_REPEAT_FROM_TO(1, BOOST_PP_INC(HWM_DEEP_COPY_PTR_MAX_ARITY), HWM_DEEP_COPY_PTR_IN_PLACE_CTOR, ~)
+    #undef HWM_DEEP_COPY_PTR_IN_PLACE_CTOR
+#endif
 
     //! @brief Copy constructor
-    deep_copy_ptr               (this_type const &rhs) : holder_(rhs.holder_->clone()) {}
+    //! with deep_copy_policy::cow, shares the pointee of `rhs'.
+    deep_copy_ptr               (this_type const &rhs)
+        :   hash_cache(rhs), holder_(ownership::share(rhs.holder_)), ptr_(pointee_of(holder_)) {}
+
+    //! @brief Move constructor
+    //! Exception guarantee : no-throw
+    deep_copy_ptr               (BOOST_RV_REF(this_type) rhs) BOOST_NOEXCEPT
+        :   hash_cache(rhs), holder_(rhs.holder_), ptr_(rhs.ptr_)
+    {
+        rhs.holder_ = 0;
+        rhs.ptr_ = 0;
+    }
 
     //! @brief Construct from deep_copy_ptr.
     //! @tparam Y must be comparable to T.
-    //! @note Not a copy constructor.
-    template<typename Y>
-    explicit     deep_copy_ptr  (deep_copy_ptr<Y> const &rhs) : holder_(rhs.holder_->clone()) {}
+    //! @note Not a copy constructor. always clones, also from an rvalue,
+    //! as the holder of `rhs' gives its pointee as a Y *, which may not be at the address of the T.
+    template<typename Y, typename P>
+    explicit     deep_copy_ptr  (deep_copy_ptr<Y, P> const &rhs)
+        :   holder_(rhs.holder_ ? rhs.holder_->clone(0).release() : 0), ptr_(pointee_of(holder_)) {}
+
+    //! @brief Clone `rhs' into the memory resource `r', or with the global new if `r' is null.
+    //! the clone is not shared, even with deep_copy_policy::cow.
+    //! the copies of the clone use the global new again, and those of Y specializing deep_copy_uses_resource
+    //! pass `r' down to its own deep_copy_ptrs.
+    //! `r' must outlive the clone. a monotonic resource frees a whole snapshot at once,
+    //! after the deep_copy_ptrs destroyed the pointees.
+    deep_copy_ptr               (this_type const &rhs, deep_copy_memory_resource *r)
+        :   hash_cache(rhs), holder_(rhs.holder_ ? rhs.holder_->clone(r).release() : 0), ptr_(pointee_of(holder_)) {}
+
+    ~deep_copy_ptr              () { ownership::release(holder_); }
 
     //! @brief Assignment operator
     //! Exception guarantee : strong
-    this_type & operator =  (this_type const &rhs) {
-        BOOST_ASSERT(rhs.holder_.get());
-        deep_copy_ptr<T>(rhs).swap(*this);
+    this_type & operator =  (BOOST_COPY_ASSIGN_REF(this_type) rhs) {
+        assign(ownership::share(rhs.holder_));
+        hash_cache::operator=(rhs);
+        return *this;
+    }
+
+    //! @brief Move assignment operator
+    //! Exception guarantee : no-throw
+    this_type & operator =  (BOOST_RV_REF(this_type) rhs) BOOST_NOEXCEPT {
+        if(this != &rhs) {
+            ownership::release(holder_);
+            holder_ = rhs.holder_;
+            ptr_ = rhs.ptr_;
+            hash_cache::operator=(rhs);
+            rhs.holder_ = 0;
+            rhs.ptr_ = 0;
+        }
         return *this;
     }
 
     //! @brief Exception guarantee : no-throw
-    void        swap            (this_type &rhs) throw()
+    void        swap            (this_type &rhs) BOOST_NOEXCEPT
     {
-        std::swap(holder_, rhs.holder_);
+        holder_base * const tmp = holder_;
+        holder_ = rhs.holder_;
+        rhs.holder_ = tmp;
+        T * const tmp_ptr = ptr_;
+        ptr_ = rhs.ptr_;
+        rhs.ptr_ = tmp_ptr;
+        hash_cache const tmp_hash = *this;
+        hash_cache::operator=(rhs);
+        static_cast<hash_cache &>(rhs) = tmp_hash;
     }
 
     //! @brief Evaluable in boolean context.
     bool        boolean_test    () const {
-        return holder_->get_ptr() != 0;
+        return ptr_ != 0;
+    }
+
+    //! @brief Reset pointer to null.
+    //! Exception guarantee : no-throw
+    void        reset           () BOOST_NOEXCEPT {
+        assign(0);
     }
 
     //! @brief Reset pointer
     //! Exception guarantee : strong
     template<typename Y>
-    void        reset           (Y* p = 0) {
-        deep_copy_ptr(p).swap(*this);
+    void        reset           (Y* p) {
+        assign(make_holder(p).release());
     }
 
+#if !defined(BOOST_NO_CXX11_SMART_PTR) && !defined(BOOST_NO_CXX11_RVALUE_REFERENCES)
+    //! @brief Reset pointer
+    //! Exception guarantee : strong
+    template<typename Y>
+    void        reset           (std::unique_ptr<Y> &&p) {
+        assign(make_holder(p.get()).release());
+        p.release();
+    }
+#endif
+
+    //! @brief the number of the deep_copy_ptrs sharing the pointee, or 0 if null.
+    //! always 1 for non-null with deep_copy_policy::clone.
+    long        use_count       () const    { return holder_ ? holder_->use_count() : 0; }
+
     //! @brief Get a pointer.
-    T *         get             ()          { return static_cast<T *>(holder_->get_ptr()); }
+    //! with deep_copy_policy::cow, clones the pointee first if it is shared.
+    //! Exception guarantee : strong
+    T *         get             ()
+    {
+        this->invalidate_hash();
+        holder_base * const h = ownership::unshare(holder_);
+        if(h != holder_) {
+            holder_ = h;
+            ptr_ = pointee_of(h);
+        }
+        return ptr_;
+    }
     //! @brief Get a pointer.
-    T   const * get             () const    { return static_cast<T const*>(holder_->get_ptr()); }
+    //! never clones.
+    T   const * get             () const    { return ptr_; }
+
     //! @brief Get member.
     T *         operator ->     ()          { return get(); }
     //! @brief Get member.
@@ -137,8 +615,9 @@ public:
 
     //! @brief Get reference.
     T &         operator *      ()          {
-        BOOST_ASSERT(get());
-        return *get();
+        T * const p = get();
+        BOOST_ASSERT(p);
+        return *p;
     }
 
     //! @brief Get reference.
@@ -147,27 +626,142 @@ public:
         return *get();
     }
 
+    //! @brief the hash of the pointee by boost::hash<T>, or 0 if null.
+    //! cached with deep_copy_cached_hash<T>.
+    std::size_t hash            () const    { return this->hash_of(get()); }
+
     //! @brief Deep comparison
+    //! the deep_copy_ptrs sharing a pointee are equal without comparing it.
+    //! with deep_copy_cached_hash<T>, the different hashes are unequal without comparing the pointees.
     bool        operator==      (this_type const &rhs) const
     {
         return
             (!*this && !rhs) ||
             (*this && rhs && (
                 (this->get() == rhs.get()) ||
-                (**this == *rhs) ) );
+                (this->may_equal(get(), rhs, rhs.get()) && **this == *rhs) ) );
     }
 
 private:
-    std::auto_ptr<detail::deep_copy_ptr_holder_base> holder_;
+    typedef holder_base::holder_ptr holder_ptr;
+
+    template<typename Y>
+    static holder_ptr   make_holder     (Y *p)
+    {
+        if(!p) { return holder_ptr(); }
+        return detail::deep_copy_ptr_holder<T, Y>::create(p);
+    }
+
+    static T *          pointee_of      (holder_base *h) { return h ? static_cast<T *>(h->get_ptr()) : 0; }
+
+    //! take the ownership of `h', and release the current holder.
+    void                assign          (holder_base *h) BOOST_NOEXCEPT
+    {
+        ownership::release(holder_);
+        holder_ = h;
+        ptr_ = pointee_of(h);
+        this->invalidate_hash();
+    }
+
+    holder_base *   holder_;
+    T *             ptr_;       //the pointee of holder_, cached.
+};
+
+//undocumented.
+//! @cond NOT_GENERATED
+namespace detail {
+
+//! the holder of a deep_copy_ptr, for cloning a graph of the pointees shared with deep_copy_policy::cow,
+//! and for destroying the clones of parallel_clone later on another thread.
+struct deep_copy_ptr_access
+{
+    template<class T, class Policy>
+    static deep_copy_ptr_holder_base *  holder  (deep_copy_ptr<T, Policy> const &p) { return p.holder_; }
+
+    //! take the holder out of `p', which becomes null without releasing it.
+    template<class T, class Policy>
+    static deep_copy_ptr_holder_base *  release (deep_copy_ptr<T, Policy> &p) BOOST_NOEXCEPT
+    {
+        deep_copy_ptr_holder_base * const h = p.holder_;
+        p.holder_ = 0;
+        p.ptr_ = 0;
+        p.invalidate_hash();
+        return h;
+    }
+
+    //! make `p' share the holder `h'.
+    template<class T>
+    static void                         share   (deep_copy_ptr<T, deep_copy_policy::cow> &p, deep_copy_ptr_holder_base *h)
+    {
+        p.assign(deep_copy_ptr_ownership<deep_copy_policy::cow>::share(h));
+    }
 };
 
+}   //namespace detail
+//! @endcond
+
+#if defined(HWM_DEEP_COPY_PTR_VARIADIC) && !defined(BOOST_NO_CXX11_FUNCTION_TEMPLATE_DEFAULT_ARGS)
+//! @brief make a deep_copy_ptr<T> that holds Y constructed from `args', with one allocation.
+//! e.g. make_deep_copy<C>("this is C", 1), or make_deep_copy<B, C>("this is C held as B", 1).
+//! @tparam Y must be comparable to T.
+//! @note for a deep_copy_ptr<B>, use make_deep_copy<B, C>. make_deep_copy<C> makes a deep_copy_ptr<C>,
+//! and deep_copy_ptr<B> constructed from it clones the pointee, which is a second allocation.
+template<typename T, typename Y = T, typename... Args>
+deep_copy_ptr<T>    make_deep_copy  (Args &&... args)
+{
+    return deep_copy_ptr<T>(in_place_type<Y>(), boost::forward<Args>(args)...);
+}
+#else
+//! @brief make a deep_copy_ptr<T> that holds Y constructed from the arguments, with one allocation.
+//! without the default template arguments, Y must be specified. e.g. make_deep_copy<C, C>("this is C", 1)
+//! @tparam T the type of the deep_copy_ptr, which is not converted without a clone. e.g. make_deep_copy<B, C> for deep_copy_ptr<B>.
+//! @tparam Y must be comparable to T.
+template<typename T, typename Y>
+deep_copy_ptr<T>    make_deep_copy  ()
+{
+    return deep_copy_ptr<T>(in_place_type<Y>());
+}
+
+#define HWM_DEEP_COPY_PTR_MAKE(z, n, unused)                                                    \
+    template<typename T, typename Y, BOOST_PP_ENUM_PARAMS(n, typename A)>                       \
+    deep_copy_ptr<T>    make_deep_copy  (BOOST_PP_ENUM_BINARY_PARAMS(n, A, const &a))           \
+    {                                                                                           \
+        return deep_copy_ptr<T>(in_place_type<Y>(), BOOST_PP_ENUM_PARAMS(n, a));                \
+    }
+
+BOOST_PP_REPEAT_FROM_TO(1, BOOST_PP_INC(HWM_DEEP_COPY_PTR_MAX_ARITY), HWM_DEEP_COPY_PTR_MAKE, ~)
+#undef HWM_DEEP_COPY_PTR_MAKE
+#endif
+
 //! swap
-template<typename T>
-void swap(deep_copy_ptr<T> &lhs, deep_copy_ptr<T> &rhs)
+template<typename T, typename Policy>
+void swap(deep_copy_ptr<T, Policy> &lhs, deep_copy_ptr<T, Policy> &rhs) BOOST_NOEXCEPT
 {
     lhs.swap(rhs);
 }
 
+//! hash for boost::hash.
+template<typename T, typename Policy>
+std::size_t hash_value(deep_copy_ptr<T, Policy> const &p)
+{
+    return p.hash();
+}
+
 }   //hwm
 
+#if !defined(BOOST_NO_CXX11_HDR_FUNCTIONAL)
+#include <functional>
+
+namespace std {
+
+//! hash for the unordered containers.
+template<typename T, typename Policy>
+struct hash< hwm::deep_copy_ptr<T, Policy> >
+{
+    std::size_t operator()  (hwm::deep_copy_ptr<T, Policy> const &p) const { return p.hash(); }
+};
+
+}   //namespace std
+#endif
+
 #endif  //HWM_DEEPCOPYPTR_HPP
@@ -0,0 +1,375 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+//! Deep copyable, deep comparable polymorphic value with the small buffer optimization.
+
+//! @file
+
+#ifndef HWM_DEEPCOPYVALUE_HPP
+#define HWM_DEEPCOPYVALUE_HPP
+
+#include <cstddef>
+#include <new>
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/move/core.hpp>
+#include <boost/move/utility_core.hpp>
+#include <boost/operators.hpp>
+#include <boost/preprocessor/arithmetic/inc.hpp>
+#include <boost/preprocessor/repetition/enum_binary_params.hpp>
+#include <boost/preprocessor/repetition/enum_params.hpp>
+#include <boost/preprocessor/repetition/repeat_from_to.hpp>
+#include <boost/type_traits/aligned_storage.hpp>
+#include <boost/type_traits/alignment_of.hpp>
+#include <boost/type_traits/is_convertible.hpp>
+#include <boost/type_traits/is_nothrow_move_constructible.hpp>
+#include <boost/utility/enable_if.hpp>
+
+#include "deep_copy_ptr.hpp"
+#include "safe_bool.hpp"
+
+namespace hwm {
+
+//undocumented.
+//! @cond NOT_GENERATED
+namespace detail {
+
+//! the strictest alignment of the fundamental types.
+union deep_copy_value_max_align
+{
+    long double     ld;
+    double          d;
+    long            l;
+    void *          p;
+    void          (*f)();
+#if defined(BOOST_HAS_LONG_LONG)
+    long long       ll;
+#endif
+};
+
+//! the operations of a deep_copy_value, for each dynamic type.
+//! the storage is the object itself when it is inline, otherwise a pointer to the object.
+template<class T>
+struct deep_copy_value_ops
+{
+    //! copy the object in `src' into `dst', and return the pointer to it.
+    T *     (*copy)     (void const *src, void *dst);
+    //! move the object in `src' into `dst', and return the pointer to it. `src' is left with no object.
+    T *     (*move)     (void *src, void *dst);
+    void    (*destroy)  (void *storage);
+    //! if the object is placed in the storage.
+    bool    is_inline;
+};
+
+template<class Y, std::size_t Size, std::size_t Align>
+struct deep_copy_value_is_inline
+{
+    BOOST_STATIC_CONSTANT(bool, value = (
+        sizeof(Y) <= Size &&
+        Align % boost::alignment_of<Y>::value == 0 &&
+        boost::is_nothrow_move_constructible<Y>::value ));
+};
+
+template<class T, class Y, bool Inline>
+struct deep_copy_value_model;
+
+//! Y is placed in the storage.
+template<class T, class Y>
+struct deep_copy_value_model<T, Y, true>
+{
+    static Y &  object  (void *storage)         { return *static_cast<Y *>(storage); }
+    static Y const &
+                object  (void const *storage)   { return *static_cast<Y const *>(storage); }
+
+#if defined(HWM_DEEP_COPY_PTR_VARIADIC)
+    template<class... Args>
+    static T *  construct   (void *dst, Args &&... args) { return ::new(dst) Y(boost::forward<Args>(args)...); }
+#else
+    static T *  construct   (void *dst) { return ::new(dst) Y(); }
+
+    #define HWM_DEEP_COPY_VALUE_CONSTRUCT_INLINE(z, n, unused)                                     \
+        template<BOOST_PP_ENUM_PARAMS(n, class A)>                                                  \
+        static T *  construct   (void *dst, BOOST_PP_ENUM_BINARY_PARAMS(n, A, const &a))            \
+        {                                                                                           \
+            return ::new(dst) Y(BOOST_PP_ENUM_PARAMS(n, a));                                        \
+        }
+
+    BOOST_PP_REPEAT_FROM_TO(1, BOOST_PP_INC(HWM_DEEP_COPY_PTR_MAX_ARITY), HWM_DEEP_COPY_VALUE_CONSTRUCT_INLINE, ~)
+    #undef HWM_DEEP_COPY_VALUE_CONSTRUCT_INLINE
+#endif
+
+    static T *  copy    (void const *src, void *dst) { return ::new(dst) Y(object(src)); }
+
+    static T *  move    (void *src, void *dst)
+    {
+        T * const p = ::new(dst) Y(boost::move(object(src)));
+        object(src).~Y();
+        return p;
+    }
+
+    static void destroy (void *storage) { object(storage).~Y(); }
+
+    static deep_copy_value_ops<T> const ops;
+};
+
+template<class T, class Y>
+deep_copy_value_ops<T> const deep_copy_value_model<T, Y, true>::ops = {
+    &deep_copy_value_model<T, Y, true>::copy,
+    &deep_copy_value_model<T, Y, true>::move,
+    &deep_copy_value_model<T, Y, true>::destroy,
+    true
+};
+
+//! Y is allocated on the heap, and the storage holds the pointer to it.
+template<class T, class Y>
+struct deep_copy_value_model<T, Y, false>
+{
+    static Y *& pointer (void *storage)         { return *static_cast<Y **>(storage); }
+    static Y *  pointer (void const *storage)   { return *static_cast<Y * const *>(storage); }
+
+    static T *  place   (void *dst, Y *p)       { ::new(dst) Y *(p); return p; }
+
+#if defined(HWM_DEEP_COPY_PTR_VARIADIC)
+    template<class... Args>
+    static T *  construct   (void *dst, Args &&... args) { return place(dst, new Y(boost::forward<Args>(args)...)); }
+#else
+    static T *  construct   (void *dst) { return place(dst, new Y()); }
+
+    #define HWM_DEEP_COPY_VALUE_CONSTRUCT_HEAP(z, n, unused)                                       \
+        template<BOOST_PP_ENUM_PARAMS(n, class A)>                                                  \
+        static T *  construct   (void *dst, BOOST_PP_ENUM_BINARY_PARAMS(n, A, const &a))            \
+        {                                                                                           \
+            return place(dst, new Y(BOOST_PP_ENUM_PARAMS(n, a)));                                   \
+        }
+
+    BOOST_PP_REPEAT_FROM_TO(1, BOOST_PP_INC(HWM_DEEP_COPY_PTR_MAX_ARITY), HWM_DEEP_COPY_VALUE_CONSTRUCT_HEAP, ~)
+    #undef HWM_DEEP_COPY_VALUE_CONSTRUCT_HEAP
+#endif
+
+    static T *  copy    (void const *src, void *dst) { return construct(dst, *pointer(src)); }
+
+    static T *  move    (void *src, void *dst) { return place(dst, pointer(src)); }
+
+    static void destroy (void *storage) { delete pointer(storage); }
+
+    static deep_copy_value_ops<T> const ops;
+};
+
+template<class T, class Y>
+deep_copy_value_ops<T> const deep_copy_value_model<T, Y, false>::ops = {
+    &deep_copy_value_model<T, Y, false>::copy,
+    &deep_copy_value_model<T, Y, false>::move,
+    &deep_copy_value_model<T, Y, false>::destroy,
+    false
+};
+
+}   //namespace detail
+//! @endcond
+
+//! A deep copyable polymorphic value with the small buffer optimization.
+//! @tparam T is the static type of the value, as deep_copy_ptr<T>.
+//! @tparam InlineBytes is the size of the buffer in the handle.
+//! an object of the dynamic type Y is placed in the buffer if it fits the size and the alignment,
+//! and its move constructor does not throw. otherwise it is allocated on the heap.
+//! copying an inline value allocates nothing, and get() is a load of a pointer without a virtual call.
+//! copies and comparisons are deep, as deep_copy_ptr. the copy is made as Y, and operator== compares as T.
+//! moving a deep_copy_value moves the inline object, or the pointer to the heap object.
+//! the moved-from deep_copy_value becomes null.
+template <class T, std::size_t InlineBytes = 48>
+class deep_copy_value
+    :   public safe_bool< deep_copy_value<T, InlineBytes> >
+    ,   public boost::equality_comparable< deep_copy_value<T, InlineBytes> >
+{
+    BOOST_COPYABLE_AND_MOVABLE(deep_copy_value)
+
+    BOOST_STATIC_CONSTANT(std::size_t, storage_size = (InlineBytes < sizeof(void *)) ? sizeof(void *) : InlineBytes);
+    BOOST_STATIC_CONSTANT(std::size_t, storage_align = boost::alignment_of<detail::deep_copy_value_max_align>::value);
+
+    typedef detail::deep_copy_value_ops<T>  ops_type;
+
+    template<class Y>
+    struct model
+        :   detail::deep_copy_value_model<T, Y, detail::deep_copy_value_is_inline<Y, storage_size, storage_align>::value>
+    {};
+
+public:
+    typedef deep_copy_value<T, InlineBytes> this_type;
+
+    //! @brief Default constructor. the value is null.
+    deep_copy_value             () BOOST_NOEXCEPT : ops_(0), ptr_(0) {}
+
+    //! @brief Construct from a copy of `y', held as Y.
+    //! @tparam Y must be comparable to T, and derived from T.
+    template<typename Y>
+    explicit    deep_copy_value (
+        Y const &y,
+        typename boost::enable_if< boost::is_convertible<Y *, T *> >::type * = 0 )
+        :   ops_(0), ptr_(0)
+    {
+        ptr_ = model<Y>::construct(storage(), y);
+        ops_ = &model<Y>::ops;
+    }
+
+#if defined(HWM_DEEP_COPY_PTR_VARIADIC)
+    //! @brief Construct the value as Y in place, from `args'.
+    //! @tparam Y must be comparable to T.
+    template<typename Y, typename... Args>
+    explicit    deep_copy_value (in_place_type<Y>, Args &&... args) : ops_(0), ptr_(0)
+    {
+        ptr_ = model<Y>::construct(storage(), boost::forward<Args>(args)...);
+        ops_ = &model<Y>::ops;
+    }
+#else
+    //! @brief Construct the value as Y in place.
+    //! @tparam Y must be comparable to T.
+    template<typename Y>
+    explicit    deep_copy_value (in_place_type<Y>) : ops_(0), ptr_(0)
+    {
+        ptr_ = model<Y>::construct(storage());
+        ops_ = &model<Y>::ops;
+    }
+
+    #define HWM_DEEP_COPY_VALUE_IN_PLACE_CTOR(z, n, unused)                                        \
+        template<typename Y, BOOST_PP_ENUM_PARAMS(n, typename A)>                                   \
+        deep_copy_value (in_place_type<Y>, BOOST_PP_ENUM_BINARY_PARAMS(n, A, const &a))             \
+            :   ops_(0), ptr_(0)                                                                    \
+        {                                                                                           \
+            ptr_ = model<Y>::construct(storage(), BOOST_PP_ENUM_PARAMS(n, a));                      \
+            ops_ = &model<Y>::ops;                                                                  \
+        }
+
+    BOOST_PP_REPEAT_FROM_TO(1, BOOST_PP_INC(HWM_DEEP_COPY_PTR_MAX_ARITY), HWM_DEEP_COPY_VALUE_IN_PLACE_CTOR, ~)
+    #undef HWM_DEEP_COPY_VALUE_IN_PLACE_CTOR
+#endif
+
+    //! @brief Copy constructor
+    deep_copy_value             (this_type const &rhs) : ops_(0), ptr_(0)
+    {
+        if(rhs.ops_) {
+            ptr_ = rhs.ops_->copy(rhs.storage(), storage());
+            ops_ = rhs.ops_;
+        }
+    }
+
+    //! @brief Move constructor
+    //! Exception guarantee : no-throw
+    deep_copy_value             (BOOST_RV_REF(this_type) rhs) BOOST_NOEXCEPT : ops_(0), ptr_(0)
+    {
+        take(rhs);
+    }
+
+    ~deep_copy_value            () { reset(); }
+
+    //! @brief Assignment operator
+    //! Exception guarantee : strong
+    this_type & operator =  (BOOST_COPY_ASSIGN_REF(this_type) rhs) {
+        if(this != &rhs) {
+            this_type tmp(rhs);
+            reset();
+            take(tmp);
+        }
+        return *this;
+    }
+
+    //! @brief Move assignment operator
+    //! Exception guarantee : no-throw
+    this_type & operator =  (BOOST_RV_REF(this_type) rhs) BOOST_NOEXCEPT {
+        if(this != &rhs) {
+            reset();
+            take(rhs);
+        }
+        return *this;
+    }
+
+    //! @brief Exception guarantee : no-throw
+    void        swap            (this_type &rhs) BOOST_NOEXCEPT
+    {
+        this_type tmp(boost::move(rhs));
+        rhs = boost::move(*this);
+        *this = boost::move(tmp);
+    }
+
+    //! @brief Evaluable in boolean context.
+    bool        boolean_test    () const {
+        return ptr_ != 0;
+    }
+
+    //! @brief Reset the value to null.
+    //! Exception guarantee : no-throw
+    void        reset           () BOOST_NOEXCEPT {
+        if(ops_) {
+            ops_->destroy(storage());
+            ops_ = 0;
+            ptr_ = 0;
+        }
+    }
+
+    //! @return if the value is placed in the handle. false if the value is null.
+    bool        is_inline       () const {
+        return ops_ != 0 && ops_->is_inline;
+    }
+
+    //! @brief Get a pointer.
+    T *         get             ()          { return ptr_; }
+    //! @brief Get a pointer.
+    T   const * get             () const    { return ptr_; }
+    //! @brief Get member.
+    T *         operator ->     ()          { return get(); }
+    //! @brief Get member.
+    T   const * operator ->     () const    { return get(); }
+
+    //! @brief Get reference.
+    T &         operator *      ()          {
+        BOOST_ASSERT(get());
+        return *get();
+    }
+
+    //! @brief Get reference.
+    T   const & operator *      () const    {
+        BOOST_ASSERT(get());
+        return *get();
+    }
+
+    //! @brief Deep comparison
+    bool        operator==      (this_type const &rhs) const
+    {
+        return
+            (!*this && !rhs) ||
+            (*this && rhs && (
+                (this->get() == rhs.get()) ||
+                (**this == *rhs) ) );
+    }
+
+private:
+    void *          storage ()          { return storage_.address(); }
+    void const *    storage () const    { return storage_.address(); }
+
+    //! move the value of `rhs', which becomes null. *this must be null.
+    void        take            (this_type &rhs) BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT(!ops_);
+        if(rhs.ops_) {
+            ptr_ = rhs.ops_->move(rhs.storage(), storage());
+            ops_ = rhs.ops_;
+            rhs.ops_ = 0;
+            rhs.ptr_ = 0;
+        }
+    }
+
+    ops_type const *    ops_;
+    T *                 ptr_;       //points into storage_, or to the heap.
+    typename boost::aligned_storage<storage_size, storage_align>::type  storage_;
+};
+
+//! swap
+template<typename T, std::size_t InlineBytes>
+void swap(deep_copy_value<T, InlineBytes> &lhs, deep_copy_value<T, InlineBytes> &rhs) BOOST_NOEXCEPT
+{
+    lhs.swap(rhs);
+}
+
+}   //hwm
+
+#endif  //HWM_DEEPCOPYVALUE_HPP
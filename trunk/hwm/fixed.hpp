@@ -0,0 +1,519 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef HWM_FIXED_HPP
+#define HWM_FIXED_HPP
+
+//! hwm.Fixed
+//! binary fixed-point number whose arithmetic stays in integers.
+//! @file
+
+#include <cmath>
+#include <cstddef>
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/integer.hpp>
+#include <boost/operators.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/is_floating_point.hpp>
+#include <boost/type_traits/is_integral.hpp>
+#include <boost/type_traits/is_same.hpp>
+#include <boost/type_traits/is_signed.hpp>
+#include <boost/utility/enable_if.hpp>
+
+#include "./arithmetic.hpp"
+#include "./arithmetic/cpu.hpp"
+
+namespace hwm {
+
+//! policies of fixed.
+namespace fixed_policy {
+
+    //! @brief round half up, exactly.
+    //! @note unlike arithmetic::round_simple, i.e. floor(x + 0.5), a value is not rounded up where x + 0.5 itself rounds.
+    struct round_simple
+    {
+        //! @return v / 2^Shift rounded to an integer. W is a signed or unsigned integral type.
+        template<int Shift, typename W>
+        static W        shift_right (W const v)
+        {
+            if(Shift == 0) { return v; }
+            W const half = static_cast<W>(static_cast<W>(static_cast<W>(1) << Shift) >> 1);
+            return static_cast<W>(static_cast<W>(v + half) >> Shift);
+        }
+
+        //! @return y rounded to an integral value.
+        static double   round       (double const y)
+        {
+            //not floor(y + 0.5), where the addition itself can round up. (e.g. y = 0.49999999999999994)
+            double const r = std::floor(y);
+            return (y - r >= 0.5) ? r + 1.0 : r;
+        }
+    };
+
+    //! @brief round half to even, also known as banker's rounding.
+    //! @note unlike arithmetic::round_to_nearest_even, negative values are rounded in the same way as positive ones.
+    struct round_to_nearest_even
+    {
+        template<int Shift, typename W>
+        static W        shift_right (W const v)
+        {
+            if(Shift == 0) { return v; }
+            W const one     = static_cast<W>(1);
+            W const half    = static_cast<W>(static_cast<W>(one << Shift) >> 1);
+            W const mask    = static_cast<W>((one << Shift) - one);
+            W const q       = static_cast<W>(v >> Shift);
+            W const r       = static_cast<W>(v & mask);
+            bool const up   = (r > half) || (r == half && (q & one) != 0);
+            return static_cast<W>(q + (up ? one : 0));
+        }
+
+        static double   round       (double const y)
+        {
+            double const r = std::floor(y);
+            double const d = y - r;
+            if(d > 0.5)     { return r + 1.0; }
+            if(d == 0.5)    { return (std::fmod(r, 2.0) != 0) ? r + 1.0 : r; }
+            return r;
+        }
+    };
+
+    //! @brief truncated division. the same as arithmetic::div_truncated.
+    struct truncated
+    {
+        template<typename W>
+        static W    divide  (W const &dividend, W const &divisor) { return arithmetic::div_truncated(dividend, divisor); }
+    };
+
+    //! @brief floored division. the same as arithmetic::div_floored.
+    struct floored
+    {
+        template<typename W>
+        static W    divide  (W const &dividend, W const &divisor) { return arithmetic::div_floored(dividend, divisor); }
+    };
+
+    //! @brief Euclidean division. the same as arithmetic::div_euclidean.
+    struct euclidean
+    {
+        template<typename W>
+        static W    divide  (W const &dividend, W const &divisor) { return arithmetic::div_euclidean(dividend, divisor); }
+    };
+
+}   //namespace fixed_policy
+
+//! @cond DETAIL
+namespace detail {
+
+    //! the smallest signed integer that has `Bits' bits.
+    template<int Bits>
+    struct fixed_storage
+    {
+        typedef typename boost::int_t<Bits>::least  type;
+    };
+
+    //! an integral type that holds the product of two values of S.
+    template<typename S, std::size_t Size = sizeof(S), bool IsSigned = boost::is_signed<S>::value>
+    struct fixed_wide;
+
+    template<typename S> struct fixed_wide<S, 1, true>  { typedef boost::int32_t    type; };
+    template<typename S> struct fixed_wide<S, 2, true>  { typedef boost::int32_t    type; };
+    template<typename S> struct fixed_wide<S, 4, true>  { typedef boost::int64_t    type; };
+    template<typename S> struct fixed_wide<S, 1, false> { typedef boost::uint32_t   type; };
+    template<typename S> struct fixed_wide<S, 2, false> { typedef boost::uint32_t   type; };
+    template<typename S> struct fixed_wide<S, 4, false> { typedef boost::uint64_t   type; };
+#if defined(BOOST_HAS_INT128)
+    template<typename S> struct fixed_wide<S, 8, true>  { typedef boost::int128_type    type; };
+    template<typename S> struct fixed_wide<S, 8, false> { typedef boost::uint128_type   type; };
+#endif
+
+}   //namespace detail
+//! @endcond
+
+//! @brief binary fixed-point number.
+//! the value is raw() / 2^FracBits.
+//! the result of each operation must be representable, as for the builtin integers.
+//! @tparam IntBits the number of integral bits, including the sign bit for signed storage.
+//! @tparam FracBits the number of fractional bits.
+//! @tparam Storage an integral type that has at least IntBits + FracBits bits.
+//!     sizeof(fixed) is equal to sizeof(Storage).
+//! @tparam RoundingPolicy fixed_policy::round_simple or fixed_policy::round_to_nearest_even.
+//!     used where the fractional bits are discarded. (conversion from floating point or
+//!     from a fixed with more fractional bits, and multiplication)
+//! @tparam DivisionPolicy fixed_policy::truncated, fixed_policy::floored or fixed_policy::euclidean.
+//!     used by division and to_integer().
+template<
+    int IntBits,
+    int FracBits,
+    typename Storage        = typename detail::fixed_storage<IntBits + FracBits>::type,
+    typename RoundingPolicy = fixed_policy::round_simple,
+    typename DivisionPolicy = fixed_policy::truncated
+>
+class fixed
+    :   boost::totally_ordered< fixed<IntBits, FracBits, Storage, RoundingPolicy, DivisionPolicy>
+    ,   boost::additive< fixed<IntBits, FracBits, Storage, RoundingPolicy, DivisionPolicy>
+    ,   boost::multiplicative< fixed<IntBits, FracBits, Storage, RoundingPolicy, DivisionPolicy>
+        > > >
+{
+    BOOST_STATIC_ASSERT(boost::is_integral<Storage>::value);
+    BOOST_STATIC_ASSERT(IntBits >= 0 && FracBits >= 0);
+    BOOST_STATIC_ASSERT(IntBits + FracBits <= static_cast<int>(sizeof(Storage) * 8));
+
+public:
+    typedef fixed<IntBits, FracBits, Storage, RoundingPolicy, DivisionPolicy>   this_type;
+    typedef Storage                                                             storage_type;
+    typedef RoundingPolicy                                                      rounding_policy;
+    typedef DivisionPolicy                                                      division_policy;
+    //! an integral type that holds the intermediate products.
+    typedef typename detail::fixed_wide<Storage>::type                          wide_type;
+
+    BOOST_STATIC_CONSTANT(int, integer_bits = IntBits);
+    BOOST_STATIC_CONSTANT(int, fractional_bits = FracBits);
+
+    //! @brief zero.
+    fixed   () : value_(0) {}
+
+    //! @brief construct from an integral value.
+    template<typename T>
+    explicit
+    fixed   (T const &v, typename boost::enable_if<boost::is_integral<T> >::type* = 0)
+        :   value_(static_cast<Storage>(static_cast<wide_type>(v) * one()))
+    {}
+
+    //! @brief construct from a floating point value, rounded by the rounding policy.
+    template<typename T>
+    explicit
+    fixed   (T const &v, typename boost::enable_if<boost::is_floating_point<T> >::type* = 0)
+        :   value_(from_floating(v))
+    {}
+
+    //! @brief construct from a fixed with a different format.
+    //! extra fractional bits are rounded by the rounding policy.
+    template<int I, int F, typename S>
+    explicit
+    fixed   (fixed<I, F, S, RoundingPolicy, DivisionPolicy> const &v)
+        :   value_(rescale<F>(v.raw()))
+    {}
+
+    //! @brief construct from the raw representation.
+    static
+    this_type   from_raw    (Storage const raw)
+    {
+        this_type f;
+        f.value_ = raw;
+        return f;
+    }
+
+    //! @return the raw representation.
+    Storage     raw         () const { return value_; }
+
+    //! @return the value as double. exact if Storage is not wider than 32 bits.
+    double      to_double   () const { return static_cast<double>(value_) * std::ldexp(1.0, -FracBits); }
+
+    //! @return the value as float.
+    float       to_float    () const { return static_cast<float>(value_) * std::ldexp(1.0f, -FracBits); }
+
+    //! @return the integral part divided by the division policy. (e.g. floored division gives floor(value))
+    Storage     to_integer  () const
+    {
+        return static_cast<Storage>(DivisionPolicy::divide(static_cast<wide_type>(value_), one()));
+    }
+
+    this_type   operator-   () const { return from_raw(static_cast<Storage>(-static_cast<wide_type>(value_))); }
+
+    this_type & operator+=  (this_type const &rhs)
+    {
+        value_ = static_cast<Storage>(static_cast<wide_type>(value_) + rhs.value_);
+        return *this;
+    }
+
+    this_type & operator-=  (this_type const &rhs)
+    {
+        value_ = static_cast<Storage>(static_cast<wide_type>(value_) - rhs.value_);
+        return *this;
+    }
+
+    //! the product is rounded by the rounding policy.
+    this_type & operator*=  (this_type const &rhs)
+    {
+        wide_type const p = static_cast<wide_type>(value_) * static_cast<wide_type>(rhs.value_);
+        value_ = static_cast<Storage>(RoundingPolicy::template shift_right<FracBits>(p));
+        return *this;
+    }
+
+    //! the quotient is divided by the division policy.
+    //! rhs must not be zero.
+    this_type & operator/=  (this_type const &rhs)
+    {
+        BOOST_ASSERT(rhs.value_ != 0);
+        wide_type const n = static_cast<wide_type>(value_) * one();
+        value_ = static_cast<Storage>(DivisionPolicy::divide(n, static_cast<wide_type>(rhs.value_)));
+        return *this;
+    }
+
+    bool        operator==  (this_type const &rhs) const { return value_ == rhs.value_; }
+    bool        operator<   (this_type const &rhs) const { return value_ < rhs.value_; }
+
+    //! @return v * 2^FracBits rounded by the rounding policy, as the raw representation.
+    template<typename T>
+    static
+    Storage     from_floating   (T const &v)
+    {
+        //multiplication by a power of two is exact.
+        return static_cast<Storage>(RoundingPolicy::round(std::ldexp(static_cast<double>(v), FracBits)));
+    }
+
+private:
+    static
+    wide_type   one         () { return static_cast<wide_type>(static_cast<wide_type>(1) << FracBits); }
+
+    template<int F, typename S>
+    static
+    Storage     rescale     (S const raw)
+    {
+        typedef typename detail::fixed_wide<S>::type    source_wide;
+        if(F <= FracBits) {
+            return static_cast<Storage>(
+                static_cast<wide_type>(raw) * static_cast<wide_type>(static_cast<wide_type>(1) << (F <= FracBits ? FracBits - F : 0)) );
+        }
+        return static_cast<Storage>(
+            RoundingPolicy::template shift_right<(F > FracBits ? F - FracBits : 0)>(static_cast<source_wide>(raw)) );
+    }
+
+    Storage     value_;
+};
+
+//! @cond DETAIL
+namespace detail {
+
+    //! the combinations of the storage and floating point type that have SIMD kernels.
+    template<typename S, typename T>    struct is_simd_fixed                        { static bool const value = false; };
+    template<>                          struct is_simd_fixed<boost::int16_t, float> { static bool const value = true; };
+    template<>                          struct is_simd_fixed<boost::int32_t, float> { static bool const value = true; };
+
+    template<typename T, typename Fixed>
+    Fixed * to_fixed_scalar     (T const *first, T const *last, Fixed *out)
+    {
+        for( ; first != last; ++first, ++out) { *out = Fixed(*first); }
+        return out;
+    }
+
+    template<typename Fixed, typename T>
+    T *     to_floating_scalar  (Fixed const *first, Fixed const *last, T *out)
+    {
+        for( ; first != last; ++first, ++out) {
+            *out = boost::is_same<T, float>::value ? static_cast<T>(first->to_float()) : static_cast<T>(first->to_double());
+        }
+        return out;
+    }
+
+#if defined HWM_ARITHMETIC_SIMD_X86
+    //  float kernels.
+    //  x * 2^FracBits is exact in float, so rounding it in float gives the same result as the scalar code.
+    //  the conversion from int32 to float rounds once, as static_cast<float> does.
+
+    template<typename Rounding> struct fixed_round_simd;
+
+    template<>
+    struct fixed_round_simd<fixed_policy::round_simple>
+    {
+        //r = floor(y), and r + 1 if y - r >= 0.5. (y - r is exact)
+        HWM_ARITHMETIC_TARGET_SSE41
+        static __m128   sse41   (__m128 const y)
+        {
+            __m128 const r = _mm_floor_ps(y);
+            __m128 const up = _mm_and_ps(_mm_cmpge_ps(_mm_sub_ps(y, r), _mm_set1_ps(0.5f)), _mm_set1_ps(1.0f));
+            return _mm_add_ps(r, up);
+        }
+
+        HWM_ARITHMETIC_TARGET_AVX2
+        static __m256   avx2    (__m256 const y)
+        {
+            __m256 const r = _mm256_floor_ps(y);
+            __m256 const up = _mm256_and_ps(_mm256_cmp_ps(_mm256_sub_ps(y, r), _mm256_set1_ps(0.5f), _CMP_GE_OQ), _mm256_set1_ps(1.0f));
+            return _mm256_add_ps(r, up);
+        }
+    };
+
+    template<>
+    struct fixed_round_simd<fixed_policy::round_to_nearest_even>
+    {
+        //the default rounding mode of the SIMD instructions.
+        HWM_ARITHMETIC_TARGET_SSE41
+        static __m128   sse41   (__m128 const y) { return _mm_round_ps(y, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+
+        HWM_ARITHMETIC_TARGET_AVX2
+        static __m256   avx2    (__m256 const y) { return _mm256_round_ps(y, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+    };
+
+    HWM_ARITHMETIC_TARGET_SSE41
+    inline __m128i  load_fixed_sse41    (boost::int32_t const *p) { return _mm_loadu_si128(reinterpret_cast<__m128i const *>(p)); }
+    HWM_ARITHMETIC_TARGET_SSE41
+    inline __m128i  load_fixed_sse41    (boost::int16_t const *p) { return _mm_cvtepi16_epi32(_mm_loadl_epi64(reinterpret_cast<__m128i const *>(p))); }
+    HWM_ARITHMETIC_TARGET_SSE41
+    inline void     store_fixed_sse41   (boost::int32_t *p, __m128i const v) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v); }
+    HWM_ARITHMETIC_TARGET_SSE41
+    inline void     store_fixed_sse41   (boost::int16_t *p, __m128i const v)
+    {
+        //the values are in range, so the saturation never happens.
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(p), _mm_packs_epi32(v, v));
+    }
+
+    HWM_ARITHMETIC_TARGET_AVX2
+    inline __m256i  load_fixed_avx2     (boost::int32_t const *p) { return _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p)); }
+    HWM_ARITHMETIC_TARGET_AVX2
+    inline __m256i  load_fixed_avx2     (boost::int16_t const *p) { return _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const *>(p))); }
+    HWM_ARITHMETIC_TARGET_AVX2
+    inline void     store_fixed_avx2    (boost::int32_t *p, __m256i const v) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+    HWM_ARITHMETIC_TARGET_AVX2
+    inline void     store_fixed_avx2    (boost::int16_t *p, __m256i const v)
+    {
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i *>(p),
+            _mm_packs_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1)) );
+    }
+
+    //  fixed has the same layout as its storage.
+    template<typename Fixed>
+    typename Fixed::storage_type *          storage_of  (Fixed *p)
+    {
+        return reinterpret_cast<typename Fixed::storage_type *>(p);
+    }
+
+    template<typename Fixed>
+    typename Fixed::storage_type const *    storage_of  (Fixed const *p)
+    {
+        return reinterpret_cast<typename Fixed::storage_type const *>(p);
+    }
+
+    template<typename Fixed>
+    HWM_ARITHMETIC_TARGET_SSE41
+    Fixed * to_fixed_sse41      (float const *first, float const *last, Fixed *out)
+    {
+        typedef fixed_round_simd<typename Fixed::rounding_policy> round;
+        __m128 const scale = _mm_set1_ps(std::ldexp(1.0f, Fixed::fractional_bits));
+        for( ; last - first >= 4; first += 4, out += 4) {
+            __m128 const y = _mm_mul_ps(_mm_loadu_ps(first), scale);
+            store_fixed_sse41(storage_of(out), _mm_cvttps_epi32(round::sse41(y)));
+        }
+        return to_fixed_scalar(first, last, out);
+    }
+
+    template<typename Fixed>
+    HWM_ARITHMETIC_TARGET_AVX2
+    Fixed * to_fixed_avx2       (float const *first, float const *last, Fixed *out)
+    {
+        typedef fixed_round_simd<typename Fixed::rounding_policy> round;
+        __m256 const scale = _mm256_set1_ps(std::ldexp(1.0f, Fixed::fractional_bits));
+        for( ; last - first >= 8; first += 8, out += 8) {
+            __m256 const y = _mm256_mul_ps(_mm256_loadu_ps(first), scale);
+            store_fixed_avx2(storage_of(out), _mm256_cvttps_epi32(round::avx2(y)));
+        }
+        return to_fixed_scalar(first, last, out);
+    }
+
+    template<typename Fixed>
+    HWM_ARITHMETIC_TARGET_SSE41
+    float * to_floating_sse41   (Fixed const *first, Fixed const *last, float *out)
+    {
+        __m128 const scale = _mm_set1_ps(std::ldexp(1.0f, -Fixed::fractional_bits));
+        for( ; last - first >= 4; first += 4, out += 4) {
+            _mm_storeu_ps(out, _mm_mul_ps(_mm_cvtepi32_ps(load_fixed_sse41(storage_of(first))), scale));
+        }
+        return to_floating_scalar(first, last, out);
+    }
+
+    template<typename Fixed>
+    HWM_ARITHMETIC_TARGET_AVX2
+    float * to_floating_avx2    (Fixed const *first, Fixed const *last, float *out)
+    {
+        __m256 const scale = _mm256_set1_ps(std::ldexp(1.0f, -Fixed::fractional_bits));
+        for( ; last - first >= 8; first += 8, out += 8) {
+            _mm256_storeu_ps(out, _mm256_mul_ps(_mm256_cvtepi32_ps(load_fixed_avx2(storage_of(first))), scale));
+        }
+        return to_floating_scalar(first, last, out);
+    }
+#endif  //HWM_ARITHMETIC_SIMD_X86
+
+    template<typename T, typename Fixed>
+    Fixed * to_fixed_batch      (
+                T const *first, T const *last, Fixed *out,
+                typename boost::disable_if_c<is_simd_fixed<typename Fixed::storage_type, T>::value>::type* = 0 )
+    {
+        return to_fixed_scalar(first, last, out);
+    }
+
+    template<typename T, typename Fixed>
+    Fixed * to_fixed_batch      (
+                T const *first, T const *last, Fixed *out,
+                typename boost::enable_if_c<is_simd_fixed<typename Fixed::storage_type, T>::value>::type* = 0 )
+    {
+#if defined HWM_ARITHMETIC_SIMD_X86
+        switch(arithmetic::current_simd_level()) {
+        case arithmetic::simd_avx2:     return to_fixed_avx2(first, last, out);
+        case arithmetic::simd_sse41:    return to_fixed_sse41(first, last, out);
+        default:                        break;
+        }
+#endif
+        return to_fixed_scalar(first, last, out);
+    }
+
+    template<typename Fixed, typename T>
+    T *     to_floating_batch   (
+                Fixed const *first, Fixed const *last, T *out,
+                typename boost::disable_if_c<is_simd_fixed<typename Fixed::storage_type, T>::value>::type* = 0 )
+    {
+        return to_floating_scalar(first, last, out);
+    }
+
+    template<typename Fixed, typename T>
+    T *     to_floating_batch   (
+                Fixed const *first, Fixed const *last, T *out,
+                typename boost::enable_if_c<is_simd_fixed<typename Fixed::storage_type, T>::value>::type* = 0 )
+    {
+#if defined HWM_ARITHMETIC_SIMD_X86
+        switch(arithmetic::current_simd_level()) {
+        case arithmetic::simd_avx2:     return to_floating_avx2(first, last, out);
+        case arithmetic::simd_sse41:    return to_floating_sse41(first, last, out);
+        default:                        break;
+        }
+#endif
+        return to_floating_scalar(first, last, out);
+    }
+
+}   //namespace detail
+//! @endcond
+
+//============================================================================//
+//! @defgroup fixed_conversion Bulk Conversion.
+//! convert each value in [first, last), and write the results to the range beginning at `out'.
+//! each result is equal to the scalar conversion.
+//! int16 and int32 storage from / to float use SSE4.1 / AVX2 kernels. (see arithmetic/cpu.hpp)
+//! @return the end of the output range.
+//! @{
+//============================================================================//
+
+//! @brief bulk version of the construction from floating point values.
+template<typename T, int I, int F, typename S, typename R, typename D>
+fixed<I, F, S, R, D> *  to_fixed    (T const *first, T const *last, fixed<I, F, S, R, D> *out)
+{
+    return detail::to_fixed_batch(first, last, out);
+}
+
+//! @brief bulk version of to_float / to_double.
+template<typename T, int I, int F, typename S, typename R, typename D>
+T *                     to_floating (fixed<I, F, S, R, D> const *first, fixed<I, F, S, R, D> const *last, T *out)
+{
+    BOOST_STATIC_ASSERT(boost::is_floating_point<T>::value);
+    return detail::to_floating_batch(first, last, out);
+}
+
+//============================================================================//
+//! @}
+//  enddef of fixed_conversion
+//============================================================================//
+
+}   //namespace hwm
+
+#endif  //HWM_FIXED_HPP
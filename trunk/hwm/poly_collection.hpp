@@ -0,0 +1,307 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+//! Deep copyable, deep comparable collection of polymorphic values,
+//! stored contiguously for each dynamic type.
+
+//! @file
+
+#ifndef HWM_POLYCOLLECTION_HPP
+#define HWM_POLYCOLLECTION_HPP
+
+#include <cstddef>
+#include <typeinfo>
+#include <vector>
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/move/utility_core.hpp>
+#include <boost/operators.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/is_convertible.hpp>
+#include <boost/type_traits/remove_cv.hpp>
+#include <boost/type_traits/remove_reference.hpp>
+
+#include "deep_copy_ptr.hpp"
+
+namespace hwm {
+
+//undocumented.
+//! @cond NOT_GENERATED
+namespace detail {
+
+//! the elements of one dynamic type.
+template<class Base>
+class poly_segment_base
+{
+public:
+    virtual ~poly_segment_base  () {}
+
+    virtual std::type_info const &  type    () const = 0;
+    virtual std::size_t             size    () const = 0;
+    //! the first element as Base, or null if empty. the next element is `stride' bytes after.
+    virtual Base *                  data    () = 0;
+    virtual Base const *            data    () const = 0;
+    virtual std::size_t             stride  () const = 0;
+    virtual void                    clear   () = 0;
+};
+
+template<class Base, class Y>
+class poly_segment
+    :   public poly_segment_base<Base>
+{
+public:
+    std::type_info const &  type    () const    { return typeid(Y); }
+    std::size_t             size    () const    { return elements.size(); }
+    Base *                  data    ()          { return elements.empty() ? 0 : static_cast<Base *>(&elements[0]); }
+    Base const *            data    () const    { return elements.empty() ? 0 : static_cast<Base const *>(&elements[0]); }
+    std::size_t             stride  () const    { return sizeof(Y); }
+    void                    clear   ()          { elements.clear(); }
+
+    std::vector<Y>  elements;
+};
+
+//! the i-th element of a segment, `stride' bytes apart.
+template<class Base>
+Base *  poly_segment_at (Base *first, std::size_t stride, std::size_t i)
+{
+    return reinterpret_cast<Base *>(reinterpret_cast<char *>(first) + stride * i);
+}
+
+template<class Base>
+Base const *    poly_segment_at (Base const *first, std::size_t stride, std::size_t i)
+{
+    return reinterpret_cast<Base const *>(reinterpret_cast<char const *>(first) + stride * i);
+}
+
+}   //namespace detail
+//! @endcond
+
+//! A collection of polymorphic values, which stores the elements of each dynamic type
+//! contiguously in a segment for the type, in place of a heap block for each element.
+//! @tparam Base is the static type of the elements, as deep_copy_ptr<Base>.
+//! an element is inserted by its dynamic type Y, and copied as Y.
+//! the collection is deep copyable, and operator== compares the elements of the same type
+//! in the order of insertion, as Base. the order of the elements of different types is not kept.
+//! for_each<Y> visits one segment by the static type Y, so that the calls through Y can be inlined,
+//! e.g. if Y is final, or its member functions are called by the qualified names.
+template <class Base>
+class poly_collection
+    :   public boost::equality_comparable< poly_collection<Base> >
+{
+    typedef detail::poly_segment_base<Base>     segment_base;
+    typedef deep_copy_ptr<segment_base>         segment_ptr;
+
+    template<class Y>
+    struct segment_of
+    {
+        typedef detail::poly_segment<Base, Y>   type;
+    };
+
+public:
+    typedef poly_collection<Base>   this_type;
+    typedef Base                    value_type;
+    typedef std::size_t             size_type;
+
+    //! @brief Default constructor. allocates nothing.
+    poly_collection     () {}
+
+#if !defined(BOOST_NO_CXX11_RVALUE_REFERENCES)
+    //! @brief Insert `y' at the end of the segment of its type.
+    //! @tparam Y must be the dynamic type of `y', derived from Base.
+    //! Exception guarantee : strong, except that the empty segment may be left.
+    template<typename Y>
+    void        insert          (Y &&y)
+    {
+        typedef typename boost::remove_cv<typename boost::remove_reference<Y>::type>::type element_type;
+        BOOST_STATIC_ASSERT((boost::is_convertible<element_type *, Base *>::value));
+        BOOST_ASSERT(typeid(y) == typeid(element_type));
+        segment<element_type>(true)->elements.push_back(boost::forward<Y>(y));
+    }
+#else
+    //! @brief Insert `y' at the end of the segment of its type.
+    //! @tparam Y must be the dynamic type of `y', derived from Base.
+    //! Exception guarantee : strong, except that the empty segment may be left.
+    template<typename Y>
+    void        insert          (Y const &y)
+    {
+        BOOST_STATIC_ASSERT((boost::is_convertible<Y *, Base *>::value));
+        BOOST_ASSERT(typeid(y) == typeid(Y));
+        segment<Y>(true)->elements.push_back(y);
+    }
+#endif
+
+    //! @brief Reserve the segment of Y for `n' elements.
+    template<typename Y>
+    void        reserve         (size_type n)
+    {
+        segment<Y>(true)->elements.reserve(n);
+    }
+
+    //! @brief the number of the elements.
+    size_type   size            () const
+    {
+        size_type n = 0;
+        for(std::size_t i = 0; i < segments_.size(); ++i) { n += segments_[i]->size(); }
+        return n;
+    }
+
+    //! @brief the number of the elements of Y.
+    template<typename Y>
+    size_type   size            () const
+    {
+        typename segment_of<Y>::type const *s = segment<Y>();
+        return s ? s->elements.size() : 0;
+    }
+
+    bool        empty           () const { return size() == 0; }
+
+    //! @brief Remove all the elements. the segments keep their capacity.
+    void        clear           ()
+    {
+        for(std::size_t i = 0; i < segments_.size(); ++i) { segments_[i]->clear(); }
+    }
+
+    //! @brief the elements of Y, as a contiguous range. [begin<Y>(), end<Y>()) is empty if there is no Y.
+    template<typename Y>
+    Y *         begin           ()          { return data_of<Y>(segment<Y>()); }
+    template<typename Y>
+    Y const *   begin           () const    { return data_of<Y>(segment<Y>()); }
+    template<typename Y>
+    Y *         end             ()          { return begin<Y>() + size<Y>(); }
+    template<typename Y>
+    Y const *   end             () const    { return begin<Y>() + size<Y>(); }
+
+    //! @brief Call `f' with each element as Base &, segment by segment.
+    template<typename F>
+    F           for_each        (F f)
+    {
+        for(std::size_t i = 0; i < segments_.size(); ++i) {
+            segment_base &s = *segments_[i];
+            Base * const first = s.data();
+            std::size_t const stride = s.stride();
+            std::size_t const n = s.size();
+            for(std::size_t j = 0; j < n; ++j) { f(*detail::poly_segment_at(first, stride, j)); }
+        }
+        return f;
+    }
+
+    //! @brief Call `f' with each element as Base const &, segment by segment.
+    template<typename F>
+    F           for_each        (F f) const
+    {
+        for(std::size_t i = 0; i < segments_.size(); ++i) {
+            segment_base const &s = *segments_[i];
+            Base const * const first = s.data();
+            std::size_t const stride = s.stride();
+            std::size_t const n = s.size();
+            for(std::size_t j = 0; j < n; ++j) { f(*detail::poly_segment_at(first, stride, j)); }
+        }
+        return f;
+    }
+
+    //! @brief Call `f' with each element of Y as Y &.
+    template<typename Y, typename F>
+    F           for_each        (F f)
+    {
+        for(Y *p = begin<Y>(), *last = end<Y>(); p != last; ++p) { f(*p); }
+        return f;
+    }
+
+    //! @brief Call `f' with each element of Y as Y const &.
+    template<typename Y, typename F>
+    F           for_each        (F f) const
+    {
+        for(Y const *p = begin<Y>(), *last = end<Y>(); p != last; ++p) { f(*p); }
+        return f;
+    }
+
+    //! @brief Exception guarantee : no-throw
+    void        swap            (this_type &rhs) BOOST_NOEXCEPT
+    {
+        segments_.swap(rhs.segments_);
+    }
+
+    //! @brief Deep comparison
+    bool        operator==      (this_type const &rhs) const
+    {
+        if(size() != rhs.size()) { return false; }
+        //as the sizes are equal, every element of rhs is compared if every nonempty segment of *this has its pair.
+        for(std::size_t i = 0; i < segments_.size(); ++i) {
+            segment_base const &s = *segments_[i];
+            if(s.size() == 0) { continue; }
+            segment_base const *r = rhs.find(s.type());
+            if(!r || !equal(s, *r)) { return false; }
+        }
+        return true;
+    }
+
+private:
+    //! compare the elements of the segments of the same type, as Base.
+    static bool             equal   (segment_base const &lhs, segment_base const &rhs)
+    {
+        std::size_t const n = lhs.size();
+        if(n != rhs.size()) { return false; }
+        Base const * const l = lhs.data();
+        Base const * const r = rhs.data();
+        std::size_t const stride = lhs.stride();
+        for(std::size_t i = 0; i < n; ++i) {
+            if(!(*detail::poly_segment_at(l, stride, i) == *detail::poly_segment_at(r, stride, i))) { return false; }
+        }
+        return true;
+    }
+
+    segment_base const *    find    (std::type_info const &type) const
+    {
+        for(std::size_t i = 0; i < segments_.size(); ++i) {
+            segment_base const &s = *segments_[i];
+            if(s.type() == type) { return &s; }
+        }
+        return 0;
+    }
+
+    //! @return the segment of Y, or null if none.
+    template<typename Y>
+    typename segment_of<Y>::type const *    segment     () const
+    {
+        return static_cast<typename segment_of<Y>::type const *>(find(typeid(Y)));
+    }
+
+    //! @return the segment of Y. it is added if none and `create', or null.
+    template<typename Y>
+    typename segment_of<Y>::type *          segment     (bool create = false)
+    {
+        typedef typename segment_of<Y>::type segment_type;
+        segment_base const *s = find(typeid(Y));
+        if(s) { return static_cast<segment_type *>(const_cast<segment_base *>(s)); }
+        if(!create) { return 0; }
+        segments_.push_back(make_deep_copy<segment_base, segment_type>());
+        return static_cast<segment_type *>(segments_.back().get());
+    }
+
+    template<typename Y>
+    static Y *          data_of (typename segment_of<Y>::type *s)
+    {
+        return (s && !s->elements.empty()) ? &s->elements[0] : 0;
+    }
+
+    template<typename Y>
+    static Y const *    data_of (typename segment_of<Y>::type const *s)
+    {
+        return (s && !s->elements.empty()) ? &s->elements[0] : 0;
+    }
+
+    std::vector<segment_ptr>    segments_;
+};
+
+//! swap
+template<typename Base>
+void swap(poly_collection<Base> &lhs, poly_collection<Base> &rhs) BOOST_NOEXCEPT
+{
+    lhs.swap(rhs);
+}
+
+}   //hwm
+
+#endif  //HWM_POLYCOLLECTION_HPP
@@ -0,0 +1,250 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+//! A fixed-size pool of worker threads for data parallel loops.
+//! requires Boost.Thread. (link boost_thread and boost_system)
+
+//! @file
+
+#ifndef HWM_THREAD_POOL_HPP
+#define HWM_THREAD_POOL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <boost/assert.hpp>
+#include <boost/bind/bind.hpp>
+#include <boost/exception_ptr.hpp>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/tss.hpp>
+
+namespace hwm {
+
+//undocumented.
+//! @cond NOT_GENERATED
+namespace detail {
+
+//! the indices of a for_each_index call.
+//! shared by the calling thread and the workers, and each index is claimed by exactly one of them.
+class thread_pool_job
+    :   boost::noncopyable
+{
+public:
+    explicit thread_pool_job    (std::size_t count)
+        :   next_   (0)
+        ,   count_  (count)
+        ,   active_ (0)
+        ,   closed_ (false)
+        ,   failed_ (false)
+    {}
+
+    virtual ~thread_pool_job    () {}
+
+    //! runs on a worker.
+    //! does nothing once the calling thread has finished, so that a worker that starts late
+    //! and the nested loops never wait for each other.
+    void    help    ()
+    {
+        {
+            boost::lock_guard<boost::mutex> lock(mutex_);
+            if(closed_) { return; }
+            ++active_;
+        }
+        run();
+        {
+            boost::lock_guard<boost::mutex> lock(mutex_);
+            if(--active_ == 0) { done_.notify_all(); }
+        }
+    }
+
+    //! claims and invokes indices until none is left or an exception is thrown.
+    void    run     ()
+    {
+        for( ; ; ) {
+            std::size_t i;
+            {
+                boost::lock_guard<boost::mutex> lock(mutex_);
+                if(failed_ || next_ == count_) { return; }
+                i = next_++;
+            }
+
+            //published after the catch, when the thrown object, which shares the error info with the copy, is destroyed.
+            boost::exception_ptr error;
+            try {
+                invoke(i);
+            } catch(...) {
+                error = boost::current_exception();
+            }
+            if(error) {
+                boost::lock_guard<boost::mutex> lock(mutex_);
+                if(!failed_) {
+                    failed_ = true;
+                    error_ = error;
+                }
+            }
+        }
+    }
+
+    //! called by the thread that created the job, after run().
+    //! waits for the workers running the job, and rethrows the first exception.
+    //! the exception is taken out of the job, as the last worker to drop the job may destroy it
+    //! while it is rethrown, and the reference count of its error info is not atomic.
+    void    finish  ()
+    {
+        boost::exception_ptr error;
+        {
+            boost::unique_lock<boost::mutex> lock(mutex_);
+            closed_ = true;
+            while(active_ != 0) { done_.wait(lock); }
+            error = error_;
+            error_ = boost::exception_ptr();
+        }
+        if(error) { boost::rethrow_exception(error); }
+    }
+
+private:
+    virtual void    invoke  (std::size_t i) = 0;
+
+    boost::mutex                mutex_;
+    boost::condition_variable   done_;
+    std::size_t                 next_;
+    std::size_t const           count_;
+    std::size_t                 active_;
+    bool                        closed_;
+    bool                        failed_;
+    boost::exception_ptr        error_;
+};
+
+template<class F>
+class thread_pool_job_impl
+    :   public thread_pool_job
+{
+public:
+    thread_pool_job_impl    (std::size_t count, F const &f) : thread_pool_job(count), f_(f) {}
+
+private:
+    virtual void    invoke  (std::size_t i) { f_(i); }
+
+    F   f_;
+};
+
+}   //namespace detail
+//! @endcond
+
+//! A fixed number of threads running the indices of a loop.
+//! the thread that calls for_each_index takes part in the loop,
+//! so thread_pool(n) runs a loop on n threads, with n - 1 workers.
+class thread_pool
+    :   boost::noncopyable
+{
+public:
+    //! @brief Construct with the number of threads that run a loop.
+    //! @param thread_count the calling thread and the workers. must not be zero.
+    explicit    thread_pool (std::size_t thread_count = default_thread_count())
+        :   stopping_   (false)
+    {
+        BOOST_ASSERT(thread_count != 0);
+        try {
+            for(std::size_t i = 1; i < thread_count; ++i) {
+                workers_.create_thread(boost::bind(&thread_pool::work, this, i));
+            }
+        } catch(...) {
+            stop();
+            throw;
+        }
+    }
+
+    //! @brief Stop and join the workers.
+    ~thread_pool            () { stop(); }
+
+    //! @brief The number of threads that run a loop.
+    std::size_t size        () const { return workers_.size() + 1; }
+
+    //! @brief The index of the calling thread, in [0, size()).
+    //! 1 to size() - 1 for the workers, and 0 for the other threads, i.e. the thread that calls for_each_index.
+    //! to keep a state for each thread of a loop in an array, e.g. a memory resource.
+    std::size_t thread_index    () const
+    {
+        std::size_t const *index = index_.get();
+        return index ? *index : 0;
+    }
+
+    //! @brief The number of hardware threads, or 1 if it is unknown.
+    static std::size_t
+                default_thread_count    ()
+    {
+        unsigned int const n = boost::thread::hardware_concurrency();
+        return (n != 0) ? n : 1;
+    }
+
+    //! @brief Invoke f(i) for each i in [0, count) and wait for all of them.
+    //! the indices are claimed one by one, in increasing order, by the calling thread and the workers,
+    //! so each index should be a coarse piece of work.
+    //! f is copied once and shared by the threads, and must be safe to call concurrently.
+    //! may be called from within f; the nested loop does not wait for a worker that is busy.
+    //! if f throws, the remaining indices are not invoked and the first exception is rethrown.
+    template<class F>
+    void        for_each_index  (std::size_t count, F f)
+    {
+        if(count == 0) { return; }
+
+        boost::shared_ptr<detail::thread_pool_job> const job(new detail::thread_pool_job_impl<F>(count, f));
+        std::size_t const helpers = (std::min)(workers_.size(), count - 1);
+        if(helpers != 0) {
+            boost::lock_guard<boost::mutex> lock(mutex_);
+            for(std::size_t i = 0; i < helpers; ++i) {
+                tasks_.push_back(boost::bind(&detail::thread_pool_job::help, job));
+            }
+            ready_.notify_all();
+        }
+
+        job->run();
+        job->finish();
+    }
+
+private:
+    void    work    (std::size_t index)
+    {
+        index_.reset(new std::size_t(index));
+        for( ; ; ) {
+            boost::function<void()> task;
+            {
+                boost::unique_lock<boost::mutex> lock(mutex_);
+                while(tasks_.empty() && !stopping_) { ready_.wait(lock); }
+                if(stopping_) { return; }
+                task.swap(tasks_.front());
+                tasks_.pop_front();
+            }
+            task();
+        }
+    }
+
+    void    stop    ()
+    {
+        {
+            boost::lock_guard<boost::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        ready_.notify_all();
+        workers_.join_all();
+    }
+
+    boost::mutex                            mutex_;
+    boost::condition_variable               ready_;
+    std::deque<boost::function<void()> >    tasks_;
+    bool                                    stopping_;
+    boost::thread_specific_ptr<std::size_t> index_;
+    boost::thread_group                     workers_;
+};
+
+}   //namespace hwm
+
+#endif  //HWM_THREAD_POOL_HPP
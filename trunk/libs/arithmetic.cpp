@@ -3,9 +3,357 @@
 //      (See accompanying file LICENSE_1_0.txt or copy at
 //          http://www.boost.org/LICENSE_1_0.txt)
 
+#include <limits>
+#include <vector>
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/mpl/if.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <boost/static_assert.hpp>
 #include <boost/test/minimal.hpp>
+#include <boost/type_traits/is_same.hpp>
+#include <boost/type_traits/make_unsigned.hpp>
 #include "../hwm/arithmetic.hpp"
 
+namespace {
+
+//! reference implementation.
+//! the quotient is adjusted with branches by the definition of each division.
+//! n - q * d, without overflow.
+template<typename T>
+T       modulus_of  (T const n, T const q, T const d)
+{
+    typedef typename boost::make_unsigned<T>::type U;
+    return static_cast<T>(static_cast<U>(n) - static_cast<U>((static_cast<U>(q) + 0u) * (static_cast<U>(d) + 0u)));
+}
+
+template<typename T>
+bool    equals_reference    (T const n, T const d)
+{
+    namespace har = hwm::arithmetic;
+
+    T const q_tr = n / d;
+    T const r_tr = n % d;
+
+    T q_fl = q_tr;
+    if(r_tr != 0 && ((r_tr < 0) != (d < 0))) { q_fl = q_fl - 1; }
+
+    T q_eu = q_tr;
+    if(r_tr < 0) { q_eu = (d > 0) ? q_eu - 1 : q_eu + 1; }
+
+    return
+        har::div_truncated(n, d)    == q_tr &&
+        har::mod_truncated(n, d)    == modulus_of(n, q_tr, d) &&
+        har::div_floored(n, d)      == q_fl &&
+        har::mod_floored(n, d)      == modulus_of(n, q_fl, d) &&
+        har::div_euclidean(n, d)    == q_eu &&
+        har::mod_euclidean(n, d)    == modulus_of(n, q_eu, d) &&
+        har::mod_euclidean(n, d)    >= 0;
+}
+
+template<typename T>
+bool    is_overflow (T const n, T const d)
+{
+    return
+        std::numeric_limits<T>::is_signed &&
+        n == (std::numeric_limits<T>::min)() &&
+        d == static_cast<T>(-1);
+}
+
+template<typename T>
+void    test_random_division    (std::size_t count)
+{
+    boost::random::mt19937 gen(12345);
+    boost::random::uniform_int_distribution<boost::intmax_t> dist(
+        (std::numeric_limits<T>::min)(), (std::numeric_limits<T>::max)() );
+    boost::random::uniform_int_distribution<int> bits(0, std::numeric_limits<T>::digits - 1);
+
+    bool ok = true;
+    for(std::size_t i = 0; i < count; ++i) {
+        T const n = static_cast<T>(dist(gen));
+        //divisors of every magnitude.
+        T d = static_cast<T>(static_cast<T>(dist(gen)) >> bits(gen));
+        if(d == 0) { d = 1; }
+        if(is_overflow(n, d)) { continue; }
+        ok = ok && equals_reference(n, d);
+    }
+    BOOST_CHECK(ok);
+}
+
+template<typename T>
+void    test_random_division_unsigned   (std::size_t count)
+{
+    boost::random::mt19937 gen(12345);
+    boost::random::uniform_int_distribution<boost::uintmax_t> dist(0, (std::numeric_limits<T>::max)());
+    boost::random::uniform_int_distribution<int> bits(0, std::numeric_limits<T>::digits - 1);
+
+    bool ok = true;
+    for(std::size_t i = 0; i < count; ++i) {
+        T const n = static_cast<T>(dist(gen));
+        T d = static_cast<T>(static_cast<T>(dist(gen)) >> bits(gen));
+        if(d == 0) { d = 1; }
+        ok = ok && equals_reference(n, d);
+    }
+    BOOST_CHECK(ok);
+}
+
+template<boost::intmax_t N, typename T>
+bool    equals_runtime_divisor  (T const x)
+{
+    namespace har = hwm::arithmetic;
+    T const d = static_cast<T>(N);
+    return
+        har::mod_truncated<N>(x)    == har::mod_truncated(x, d) &&
+        har::mod_floored<N>(x)      == har::mod_floored(x, d) &&
+        har::mod_euclidean<N>(x)    == har::mod_euclidean(x, d) &&
+        har::div_truncated<N>(x)    == har::div_truncated(x, d) &&
+        har::div_floored<N>(x)      == har::div_floored(x, d) &&
+        har::div_euclidean<N>(x)    == har::div_euclidean(x, d);
+}
+
+template<typename T>
+std::vector<T>  make_constant_dividends ()
+{
+    boost::random::mt19937 gen(12345);
+    boost::random::uniform_int_distribution<boost::intmax_t> dist(
+        static_cast<boost::intmax_t>((std::numeric_limits<T>::min)() + (std::numeric_limits<T>::is_signed ? 1 : 0)),
+        static_cast<boost::intmax_t>((std::numeric_limits<T>::max)() / 2) );
+
+    std::vector<T> v;
+    for(int i = -100; i <= 100; ++i) {
+        if(i < 0 && !std::numeric_limits<T>::is_signed) { continue; }
+        v.push_back(static_cast<T>(i));
+    }
+    v.push_back((std::numeric_limits<T>::max)());
+    for(int i = 0; i < 10000; ++i) {
+        v.push_back(static_cast<T>(dist(gen)));
+    }
+    return v;
+}
+
+template<typename T>
+void    test_constant_division  ()
+{
+    std::vector<T> const v = make_constant_dividends<T>();
+    bool ok = true;
+    for(std::size_t i = 0; i < v.size(); ++i) {
+        ok = ok &&
+            equals_runtime_divisor<1>(v[i]) &&
+            equals_runtime_divisor<2>(v[i]) &&
+            equals_runtime_divisor<4>(v[i]) &&
+            equals_runtime_divisor<64>(v[i]) &&
+            equals_runtime_divisor<3>(v[i]) &&
+            equals_runtime_divisor<7>(v[i]) &&
+            equals_runtime_divisor<10>(v[i]) &&
+            equals_runtime_divisor<100>(v[i]);
+    }
+    BOOST_CHECK(ok);
+}
+
+template<typename T>
+void    test_negative_constant_division ()
+{
+    std::vector<T> const v = make_constant_dividends<T>();
+    bool ok = true;
+    for(std::size_t i = 0; i < v.size(); ++i) {
+        ok = ok &&
+            equals_runtime_divisor<-1>(v[i]) &&
+            equals_runtime_divisor<-2>(v[i]) &&
+            equals_runtime_divisor<-4>(v[i]) &&
+            equals_runtime_divisor<-7>(v[i]) &&
+            equals_runtime_divisor<-100>(v[i]);
+    }
+    BOOST_CHECK(ok);
+}
+
+template<typename T, typename U>
+bool    is_type_of  (U const &) { return boost::is_same<T, U>::value; }
+
+//! float and long double versions give the results of the integral functions for integral values,
+//! and the results of the double versions for fractional values that all the types represent exactly.
+template<typename T>
+void    test_floating_division  ()
+{
+    namespace har = hwm::arithmetic;
+
+    BOOST_CHECK(is_type_of<T>(har::fmod_truncated(T(1), T(2))));
+    BOOST_CHECK(is_type_of<T>(har::fmod_floored(T(1), T(2))));
+    BOOST_CHECK(is_type_of<T>(har::fmod_euclidean(T(1), T(2))));
+    BOOST_CHECK(is_type_of<T>(har::fdiv_truncated(T(1), T(2))));
+    BOOST_CHECK(is_type_of<T>(har::fdiv_floored(T(1), T(2))));
+    BOOST_CHECK(is_type_of<T>(har::fdiv_euclidean(T(1), T(2))));
+
+    bool ok = true;
+    for(int x = -40; x <= 40; ++x) {
+        for(int y = -9; y <= 9; ++y) {
+            if(y == 0) { continue; }
+            T const fx = static_cast<T>(x);
+            T const fy = static_cast<T>(y);
+            ok = ok && har::fmod_truncated(fx, fy) == har::mod_truncated(x, y);
+            ok = ok && har::fmod_floored(fx, fy)   == har::mod_floored(x, y);
+            ok = ok && har::fmod_euclidean(fx, fy) == har::mod_euclidean(x, y);
+            ok = ok && har::fdiv_truncated(fx, fy) == har::div_truncated(x, y);
+            ok = ok && har::fdiv_floored(fx, fy)   == har::div_floored(x, y);
+            ok = ok && har::fdiv_euclidean(fx, fy) == har::div_euclidean(x, y);
+        }
+    }
+    BOOST_CHECK(ok);
+
+    double const divisors[] = { 1.25, -1.25, 0.375, -0.375, 7.5, -7.5 };
+    ok = true;
+    for(int i = -64; i <= 64; ++i) {
+        for(std::size_t j = 0; j < sizeof(divisors) / sizeof(divisors[0]); ++j) {
+            double const x = i * 0.625;
+            double const y = divisors[j];
+            T const fx = static_cast<T>(x);
+            T const fy = static_cast<T>(y);
+            ok = ok && har::fmod_truncated(fx, fy) == static_cast<T>(har::fmod_truncated(x, y));
+            ok = ok && har::fmod_floored(fx, fy)   == static_cast<T>(har::fmod_floored(x, y));
+            ok = ok && har::fmod_euclidean(fx, fy) == static_cast<T>(har::fmod_euclidean(x, y));
+            ok = ok && har::fdiv_truncated(fx, fy) == static_cast<T>(har::fdiv_truncated(x, y));
+            ok = ok && har::fdiv_floored(fx, fy)   == static_cast<T>(har::fdiv_floored(x, y));
+            ok = ok && har::fdiv_euclidean(fx, fy) == static_cast<T>(har::fdiv_euclidean(x, y));
+        }
+    }
+    BOOST_CHECK(ok);
+}
+
+//! an integral type that holds the exact results of T.
+template<typename T, bool IsSigned = std::numeric_limits<T>::is_signed, bool Small = (sizeof(T) <= 4)>
+struct exact_type;
+template<typename T> struct exact_type<T, true, true>   { typedef boost::intmax_t       type; };
+template<typename T> struct exact_type<T, false, true>  { typedef boost::uintmax_t      type; };
+#if defined(BOOST_HAS_INT128)
+template<typename T> struct exact_type<T, true, false>  { typedef boost::int128_type    type; };
+template<typename T> struct exact_type<T, false, false> { typedef boost::uint128_type   type; };
+#endif
+
+template<typename T, typename W>
+T       clamp_to    (W const v)
+{
+    W const lo = static_cast<W>((std::numeric_limits<T>::min)());
+    W const hi = static_cast<W>((std::numeric_limits<T>::max)());
+    return static_cast<T>(v < lo ? lo : (hi < v ? hi : v));
+}
+
+template<typename T, typename W>
+bool    is_representable    (W const v)
+{
+    return
+        !(v < static_cast<W>((std::numeric_limits<T>::min)())) &&
+        !(static_cast<W>((std::numeric_limits<T>::max)()) < v);
+}
+
+//! a checked function succeeds and gives the exact value if it is representable, and fails otherwise.
+template<typename T, typename W>
+bool    equals_checked  (bool const success, T const result, T const untouched, W const exact)
+{
+    return is_representable<T>(exact) ? (success && result == static_cast<T>(exact)) : (!success && result == untouched);
+}
+
+//! saturating and checked functions compared with the exact values in a wider type.
+template<typename T>
+bool    equals_saturation_reference (T const x, T const y)
+{
+    namespace har = hwm::arithmetic;
+    typedef typename exact_type<T>::type W;
+    bool const is_signed = std::numeric_limits<T>::is_signed;
+
+    W const sum         = static_cast<W>(x) + static_cast<W>(y);
+    W const difference  = (!is_signed && x < y) ? static_cast<W>(-1) : static_cast<W>(static_cast<W>(x) - static_cast<W>(y));
+    W const product     = static_cast<W>(x) * static_cast<W>(y);
+    W const absolute    = (is_signed && x < T()) ? static_cast<W>(0 - static_cast<W>(x)) : static_cast<W>(x);
+
+    T const untouched = 42;
+    T r_add = untouched, r_sub = untouched, r_mul = untouched, r_abs = untouched, r_div = untouched;
+    bool const ok_add = har::checked_add(x, y, r_add);
+    bool const ok_sub = har::checked_sub(x, y, r_sub);
+    bool const ok_mul = har::checked_mul(x, y, r_mul);
+    bool const ok_abs = har::checked_abs(x, r_abs);
+    bool const ok_div = har::checked_div(x, y, r_div);
+
+    bool ok =
+        har::add_sat(x, y) == clamp_to<T>(sum) &&
+        (is_signed || x >= y ? har::sub_sat(x, y) == clamp_to<T>(difference) : har::sub_sat(x, y) == 0) &&
+        har::mul_sat(x, y) == clamp_to<T>(product) &&
+        har::abs_sat(x) == clamp_to<T>(absolute) &&
+        equals_checked(ok_add, r_add, untouched, sum) &&
+        (is_signed || x >= y ? equals_checked(ok_sub, r_sub, untouched, difference) : (!ok_sub && r_sub == untouched)) &&
+        equals_checked(ok_mul, r_mul, untouched, product) &&
+        equals_checked(ok_abs, r_abs, untouched, absolute);
+
+    if(y == 0) {
+        ok = ok && !ok_div && r_div == untouched;
+    } else {
+        W const quotient = static_cast<W>(x) / static_cast<W>(y);
+        ok = ok && har::div_sat(x, y) == clamp_to<T>(quotient) && equals_checked(ok_div, r_div, untouched, quotient);
+    }
+    return ok;
+}
+
+template<typename T>
+void    test_saturation_exhaustive  ()
+{
+    int const lo = (std::numeric_limits<T>::min)();
+    int const hi = (std::numeric_limits<T>::max)();
+    bool ok = true;
+    for(int x = lo; x <= hi; ++x) {
+        for(int y = lo; y <= hi; ++y) {
+            ok = ok && equals_saturation_reference(static_cast<T>(x), static_cast<T>(y));
+        }
+    }
+    BOOST_CHECK(ok);
+}
+
+template<typename T>
+void    test_saturation_random  (std::size_t count)
+{
+    typedef typename boost::mpl::if_c<
+                std::numeric_limits<T>::is_signed, boost::intmax_t, boost::uintmax_t
+            >::type D;
+    boost::random::mt19937 gen(12345);
+    boost::random::uniform_int_distribution<D> dist(
+        static_cast<D>((std::numeric_limits<T>::min)()), static_cast<D>((std::numeric_limits<T>::max)()) );
+    boost::random::uniform_int_distribution<int> bits(0, std::numeric_limits<T>::digits - 1);
+
+    T const boundaries[] = {
+        (std::numeric_limits<T>::min)(), static_cast<T>((std::numeric_limits<T>::min)() + 1),
+        static_cast<T>(0), static_cast<T>(1), static_cast<T>(2),
+        static_cast<T>((std::numeric_limits<T>::max)() - 1), (std::numeric_limits<T>::max)()
+    };
+    std::size_t const boundary_count = sizeof(boundaries) / sizeof(boundaries[0]);
+
+    bool ok = true;
+    for(std::size_t i = 0; i < boundary_count; ++i) {
+        for(std::size_t j = 0; j < boundary_count; ++j) {
+            ok = ok && equals_saturation_reference(boundaries[i], boundaries[j]);
+            //three less, wrapping around.
+            T const near = static_cast<T>(static_cast<typename boost::make_unsigned<T>::type>(boundaries[j]) - 3u);
+            ok = ok && equals_saturation_reference(boundaries[i], near);
+        }
+    }
+    for(std::size_t i = 0; i < count; ++i) {
+        //values of every magnitude, so that the products both overflow and fit.
+        T const x = static_cast<T>(static_cast<T>(dist(gen)) >> bits(gen));
+        T const y = static_cast<T>(static_cast<T>(dist(gen)) >> bits(gen));
+        ok = ok && equals_saturation_reference(x, y);
+    }
+    BOOST_CHECK(ok);
+}
+
+}   //namespace
+
+#if !defined(BOOST_NO_CXX11_CONSTEXPR)
+//constant division is available in constant expressions.
+BOOST_STATIC_ASSERT(hwm::arithmetic::mod_floored<4>(-13)      == 3);
+BOOST_STATIC_ASSERT(hwm::arithmetic::div_floored<4>(-13)      == -4);
+BOOST_STATIC_ASSERT(hwm::arithmetic::mod_euclidean<-4>(-13)   == 3);
+BOOST_STATIC_ASSERT(hwm::arithmetic::div_euclidean<-4>(-13)   == 4);
+BOOST_STATIC_ASSERT(hwm::arithmetic::mod_truncated<7>(-13)    == -6);
+BOOST_STATIC_ASSERT(hwm::arithmetic::div_truncated<8>(-13)    == -1);
+#endif
+
 int test_main(int, char**)
 {
     namespace har = hwm::arithmetic;
@@ -161,6 +509,15 @@ int test_main(int, char**)
     BOOST_CHECK(har::fmod_euclidean(14, -4) == 2);
     BOOST_CHECK(har::fmod_euclidean(-14, -4)== 2);
 
+    test_floating_division<float>();
+    test_floating_division<double>();
+    test_floating_division<long double>();
+
+    //the double versions adjust the truncated quotient by the remainder of fmod, as they always have,
+    //also where x / y rounds to an integer. -0.5 / 0.1 rounds to -5, and fmod leaves -0.09999999999999998.
+    BOOST_CHECK(har::fdiv_floored(-0.5, 0.1) == -6);
+    BOOST_CHECK(har::fdiv_euclidean(-0.5, 0.1) == -6);
+
 
     //work as http://en.wikipedia.org/wiki/Modulo_operation
     BOOST_CHECK(13  == har::div_truncated   (13, 4)     *   4   + har::mod_truncated(13, 4)     );
@@ -176,5 +533,88 @@ int test_main(int, char**)
     BOOST_CHECK(13  == har::div_euclidean   (13, -4)    *   -4  + har::mod_euclidean(13, -4)    );
     BOOST_CHECK(-13 == har::div_euclidean   (-13, -4)   *   -4  + har::mod_euclidean(-13, -4)   );
 
+    //============================================================================//
+    //  pure integer division
+    //============================================================================//
+    test_random_division<boost::int8_t>(100000);
+    test_random_division<boost::int16_t>(100000);
+    test_random_division<boost::int32_t>(100000);
+    test_random_division<boost::int64_t>(100000);
+    test_random_division_unsigned<boost::uint8_t>(100000);
+    test_random_division_unsigned<boost::uint16_t>(100000);
+    test_random_division_unsigned<boost::uint32_t>(100000);
+    test_random_division_unsigned<boost::uint64_t>(100000);
+
+    //not representable as double.
+    boost::int64_t const big = (static_cast<boost::int64_t>(1) << 53) + 1;
+    BOOST_CHECK(har::div_floored(-big * 3, static_cast<boost::int64_t>(3))      == -big);
+    BOOST_CHECK(har::mod_floored(-big * 3 + 1, static_cast<boost::int64_t>(-3)) == -2);
+    BOOST_CHECK(har::div_euclidean(-big * 3 - 1, static_cast<boost::int64_t>(3)) == -big - 1);
+    BOOST_CHECK(har::abs(-big) == big);
+
+    //the modulus by -1 is always 0.
+    int const int_min = (std::numeric_limits<int>::min)();
+    BOOST_CHECK(har::mod_truncated(int_min, -1) == 0);
+    BOOST_CHECK(har::mod_floored(int_min, -1)   == 0);
+    BOOST_CHECK(har::mod_euclidean(int_min, -1) == 0);
+    BOOST_CHECK(har::mod_floored(-1, int_min)   == -1);
+    BOOST_CHECK(har::mod_euclidean(-1, int_min) == (std::numeric_limits<int>::max)());
+
+    //============================================================================//
+    //  division by constant
+    //============================================================================//
+    BOOST_CHECK(har::mod_floored<4>(-13)    == 3);
+    BOOST_CHECK(har::mod_floored<-4>(13)    == -3);
+    BOOST_CHECK(har::div_floored<4>(-13)    == -4);
+    BOOST_CHECK(har::mod_euclidean<-4>(-13) == 3);
+    BOOST_CHECK(har::div_euclidean<-4>(-13) == 4);
+    BOOST_CHECK(har::div_truncated<4>(-13)  == -3);
+    BOOST_CHECK(har::mod_truncated<4>(-13)  == -1);
+
+    test_constant_division<boost::int8_t>();
+    test_constant_division<boost::int16_t>();
+    test_constant_division<boost::int32_t>();
+    test_constant_division<boost::int64_t>();
+    test_constant_division<boost::uint8_t>();
+    test_constant_division<boost::uint16_t>();
+    test_constant_division<boost::uint32_t>();
+    test_constant_division<boost::uint64_t>();
+    test_negative_constant_division<boost::int8_t>();
+    test_negative_constant_division<boost::int16_t>();
+    test_negative_constant_division<boost::int32_t>();
+    test_negative_constant_division<boost::int64_t>();
+
+    //============================================================================//
+    //  saturating and checked operations
+    //============================================================================//
+    BOOST_CHECK(har::add_sat(int_min, -1) == int_min);
+    BOOST_CHECK(har::sub_sat(int_min, 1) == int_min);
+    BOOST_CHECK(har::add_sat((std::numeric_limits<int>::max)(), 1) == (std::numeric_limits<int>::max)());
+    BOOST_CHECK(har::mul_sat(int_min, -1) == (std::numeric_limits<int>::max)());
+    BOOST_CHECK(har::mul_sat(int_min, 2) == int_min);
+    BOOST_CHECK(har::abs_sat(int_min) == (std::numeric_limits<int>::max)());
+    BOOST_CHECK(har::div_sat(int_min, -1) == (std::numeric_limits<int>::max)());
+    BOOST_CHECK(har::sub_sat(3u, 5u) == 0u);
+    BOOST_CHECK(har::add_sat(static_cast<boost::uint8_t>(200), static_cast<boost::uint8_t>(100)) == 255);
+    {
+        int r = 0;
+        BOOST_CHECK(har::checked_add(1, 2, r) && r == 3);
+        BOOST_CHECK(!har::checked_abs(int_min, r) && r == 3);
+        BOOST_CHECK(!har::checked_div(int_min, -1, r) && r == 3);
+        BOOST_CHECK(!har::checked_div(1, 0, r) && r == 3);
+        BOOST_CHECK(!har::checked_mul(1 << 16, 1 << 16, r) && r == 3);
+    }
+
+    test_saturation_exhaustive<boost::int8_t>();
+    test_saturation_exhaustive<boost::uint8_t>();
+    test_saturation_random<boost::int16_t>(100000);
+    test_saturation_random<boost::uint16_t>(100000);
+    test_saturation_random<boost::int32_t>(100000);
+    test_saturation_random<boost::uint32_t>(100000);
+#if defined(BOOST_HAS_INT128)
+    test_saturation_random<boost::int64_t>(100000);
+    test_saturation_random<boost::uint64_t>(100000);
+#endif
+
     return 0;
 }
@@ -0,0 +1,322 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <boost/math/special_functions/next.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+#include <boost/test/minimal.hpp>
+#include "../hwm/arithmetic/batch.hpp"
+
+namespace har = hwm::arithmetic;
+
+namespace {
+
+//! values for every sign combination, the boundaries and random values.
+//! the minimum value is excluded because `min / -1' overflows.
+template<typename T>
+std::vector<T>  make_dividends  (std::size_t random_count)
+{
+    T const lo = static_cast<T>((std::numeric_limits<T>::min)() + (std::numeric_limits<T>::is_signed ? 1 : 0));
+    T const hi = (std::numeric_limits<T>::max)();
+
+    std::vector<T> v;
+    for(int i = -20; i <= 20; ++i) {
+        if(i < 0 && !std::numeric_limits<T>::is_signed) { continue; }
+        v.push_back(static_cast<T>(i));
+    }
+    v.push_back(hi);
+    v.push_back(static_cast<T>(hi - 1));
+    if(std::numeric_limits<T>::is_signed) {
+        v.push_back(lo);
+        v.push_back(static_cast<T>(lo + 1));
+    }
+
+    boost::random::mt19937 gen(42);
+    boost::random::uniform_int_distribution<T> dist(lo, hi);
+    for(std::size_t i = 0; i < random_count; ++i) {
+        v.push_back(dist(gen));
+    }
+    return v;
+}
+
+template<typename T>
+std::vector<T>  make_divisors   ()
+{
+    std::vector<T> v;
+    for(int i = 1; i <= 13; ++i) {
+        v.push_back(static_cast<T>(i));
+        if(std::numeric_limits<T>::is_signed) { v.push_back(static_cast<T>(-i)); }
+    }
+    v.push_back(static_cast<T>(1000));
+    v.push_back((std::numeric_limits<T>::max)());
+    if(std::numeric_limits<T>::is_signed) {
+        v.push_back(static_cast<T>(-1000));
+        v.push_back((std::numeric_limits<T>::min)() + 1);
+    }
+    return v;
+}
+
+template<typename T>
+bool    check_divisions (std::vector<T> const &x, T const d)
+{
+    std::size_t const n = x.size();
+    std::vector<T> out(n);
+    bool ok = true;
+
+#define HWM_CHECK_BATCH(func)                                       \
+    har::func(&x[0], &x[0] + n, d, &out[0]);                        \
+    for(std::size_t i = 0; i < n; ++i) {                            \
+        if(out[i] != har::func(x[i], d)) { ok = false; }            \
+    }
+
+    HWM_CHECK_BATCH(mod_truncated)
+    HWM_CHECK_BATCH(mod_floored)
+    HWM_CHECK_BATCH(mod_euclidean)
+    HWM_CHECK_BATCH(div_truncated)
+    HWM_CHECK_BATCH(div_floored)
+    HWM_CHECK_BATCH(div_euclidean)
+
+#undef HWM_CHECK_BATCH
+
+    return ok;
+}
+
+template<typename T>
+void    test_divisions  ()
+{
+    std::vector<T> const x = make_dividends<T>(1001);
+    std::vector<T> const d = make_divisors<T>();
+
+    for(std::size_t i = 0; i < d.size(); ++i) {
+        BOOST_CHECK(check_divisions(x, d[i]));
+    }
+
+    //every length around the vector width, to cover the tail handling.
+    for(std::size_t len = 1; len < 20; ++len) {
+        std::vector<T> const part(x.begin(), x.begin() + len);
+        BOOST_CHECK(check_divisions(part, static_cast<T>(7)));
+    }
+}
+
+//! the same bit pattern. NaNs are equal to each other regardless of the payload.
+template<typename T>
+bool    same_bits   (T const x, T const y)
+{
+    if(x != x && y != y) { return true; }
+    return std::memcmp(&x, &y, sizeof(T)) == 0;
+}
+
+template<typename T, typename U>
+bool    check_rounding  (std::vector<T> const &x)
+{
+    std::size_t const n = x.size();
+    std::vector<U> out(n);
+    bool ok = true;
+
+    har::round_simple(&x[0], &x[0] + n, &out[0]);
+    for(std::size_t i = 0; i < n; ++i) {
+        ok = ok && same_bits(out[i], static_cast<U>(har::round_simple(x[i])));
+    }
+
+    har::round_to_nearest_even(&x[0], &x[0] + n, &out[0]);
+    for(std::size_t i = 0; i < n; ++i) {
+        ok = ok && same_bits(out[i], static_cast<U>(har::round_to_nearest_even(x[i])));
+    }
+    return ok;
+}
+
+//! ties, signed zeros, the values around them, and random values whose magnitude is less than `limit'.
+template<typename T>
+std::vector<T>  make_rounding_values    (double limit, bool with_specials)
+{
+    std::vector<T> v;
+    for(int i = -40; i <= 40; ++i) {
+        T const x = static_cast<T>(i * 0.25);
+        v.push_back(x);
+        v.push_back(boost::math::float_next(x));
+        v.push_back(boost::math::float_prior(x));
+    }
+    v.push_back(static_cast<T>(-0.0));
+    v.push_back(static_cast<T>(0.49999999999999994));
+    v.push_back(static_cast<T>(-0.49999999999999994));
+    v.push_back(static_cast<T>(limit / 2 + 0.5));
+    v.push_back(static_cast<T>(-limit / 2 - 0.5));
+
+    if(with_specials) {
+        v.push_back(std::numeric_limits<T>::infinity());
+        v.push_back(-std::numeric_limits<T>::infinity());
+        v.push_back(std::numeric_limits<T>::quiet_NaN());
+        v.push_back((std::numeric_limits<T>::max)());
+        v.push_back(-(std::numeric_limits<T>::max)());
+        v.push_back(std::numeric_limits<T>::denorm_min());
+        v.push_back(static_cast<T>(4503599627370497.0));    //2^52 + 1
+        v.push_back(static_cast<T>(9007199254740992.0));    //2^53
+    }
+
+    boost::random::mt19937 gen(42);
+    boost::random::uniform_real_distribution<double> dist(-limit, limit);
+    boost::random::uniform_int_distribution<int> scale(0, 60);
+    for(std::size_t i = 0; i < 1000; ++i) {
+        double const x = dist(gen);
+        v.push_back(static_cast<T>(x));
+        v.push_back(static_cast<T>(x / static_cast<double>(static_cast<boost::uint64_t>(1) << scale(gen))));
+        v.push_back(static_cast<T>(std::floor(x) + 0.5));
+    }
+    return v;
+}
+
+template<typename T>
+void    test_rounding   ()
+{
+    std::vector<T> const all        = make_rounding_values<T>(1e30, true);
+    std::vector<T> const int32_v    = make_rounding_values<T>(2e9, false);
+    std::vector<T> const int64_v    = make_rounding_values<T>(9e18, false);
+
+    BOOST_CHECK((check_rounding<T, T>(all)));
+    BOOST_CHECK((check_rounding<T, boost::int32_t>(int32_v)));
+    BOOST_CHECK((check_rounding<T, boost::int64_t>(int32_v)));
+    BOOST_CHECK((check_rounding<T, boost::int64_t>(int64_v)));
+
+    for(std::size_t len = 1; len < 10; ++len) {
+        std::vector<T> const part(all.begin(), all.begin() + len);
+        BOOST_CHECK((check_rounding<T, T>(part)));
+    }
+}
+
+//! the bulk saturating operations give the same results as the scalar ones, for all lengths of the tail.
+template<typename T>
+bool    check_saturation    (std::vector<T> const &x, std::vector<T> const &y)
+{
+    std::size_t const n = x.size();
+    std::vector<T> add(n), sub(n), mul(n), abs(n);
+    bool ok = true;
+
+    ok = ok && har::add_sat(&x[0], &x[0] + n, &y[0], &add[0]) == &add[0] + n;
+    ok = ok && har::sub_sat(&x[0], &x[0] + n, &y[0], &sub[0]) == &sub[0] + n;
+    ok = ok && har::mul_sat(&x[0], &x[0] + n, &y[0], &mul[0]) == &mul[0] + n;
+    ok = ok && har::abs_sat(&x[0], &x[0] + n, &abs[0]) == &abs[0] + n;
+    for(std::size_t i = 0; i < n; ++i) {
+        ok = ok && add[i] == har::add_sat(x[i], y[i]);
+        ok = ok && sub[i] == har::sub_sat(x[i], y[i]);
+        ok = ok && mul[i] == har::mul_sat(x[i], y[i]);
+        ok = ok && abs[i] == har::abs_sat(x[i]);
+    }
+    return ok;
+}
+
+template<typename T>
+void    test_saturation ()
+{
+    std::vector<T> const x = make_dividends<T>(1000);
+    std::vector<T> y(x.rbegin(), x.rend());
+    //the minimum value is not in the dividends.
+    y[0] = (std::numeric_limits<T>::min)();
+
+    BOOST_CHECK(check_saturation(x, y));
+    for(std::size_t len = 1; len < 70; ++len) {
+        std::vector<T> const px(x.begin(), x.begin() + len);
+        std::vector<T> const py(y.begin(), y.begin() + len);
+        BOOST_CHECK(check_saturation(px, py));
+    }
+}
+
+void    test_all_types  ()
+{
+    test_divisions<boost::int8_t>();
+    test_divisions<boost::int16_t>();
+    test_divisions<boost::int32_t>();
+    test_divisions<boost::int64_t>();
+    test_divisions<boost::uint8_t>();
+    test_divisions<boost::uint16_t>();
+    test_divisions<boost::uint32_t>();
+    test_divisions<boost::uint64_t>();
+
+    test_rounding<float>();
+    test_rounding<double>();
+
+    test_saturation<boost::int8_t>();
+    test_saturation<boost::int16_t>();
+    test_saturation<boost::int32_t>();
+    test_saturation<boost::int64_t>();
+    test_saturation<boost::uint8_t>();
+    test_saturation<boost::uint16_t>();
+    test_saturation<boost::uint32_t>();
+    test_saturation<boost::uint64_t>();
+}
+
+}   //namespace
+
+int test_main(int, char**)
+{
+    har::simd_level const levels[] = { har::simd_none, har::simd_sse41, har::simd_avx2 };
+    for(std::size_t i = 0; i < sizeof(levels)/sizeof(levels[0]); ++i) {
+        if(levels[i] > har::detected_simd_level()) { break; }
+        har::limit_simd_level(levels[i]);
+        BOOST_CHECK(har::current_simd_level() == levels[i]);
+        test_all_types();
+    }
+    har::limit_simd_level(har::simd_avx2);
+
+    {
+        //same sign rules as the scalar functions.
+        int const   in[] = { 13, -13, 14, -14, 12, -12, 13, -13 };
+        int         out[8];
+
+        har::mod_floored(in, 4, out);
+        BOOST_CHECK(out[0] == 1 && out[1] == 3 && out[2] == 2 && out[3] == 2);
+        har::mod_floored(in, -4, out);
+        BOOST_CHECK(out[0] == -3 && out[1] == -1 && out[2] == -2 && out[3] == -2);
+        har::mod_euclidean(in, -4, out);
+        BOOST_CHECK(out[0] == 1 && out[1] == 3 && out[4] == 0 && out[5] == 0);
+        har::div_floored(in, 4, out);
+        BOOST_CHECK(out[0] == 3 && out[1] == -4 && out[4] == 3 && out[5] == -3);
+        har::div_euclidean(in, -4, out);
+        BOOST_CHECK(out[0] == -3 && out[1] == 4 && out[4] == -3 && out[5] == 3);
+        har::div_truncated(in, -4, out);
+        BOOST_CHECK(out[0] == -3 && out[1] == 3);
+    }
+
+    {
+        //in place.
+        int v[] = { -7, -3, 0, 3, 7 };
+        int * const end = har::mod_euclidean(v, v + 5, 3, v);
+        BOOST_CHECK(end == v + 5);
+        BOOST_CHECK(v[0] == 2 && v[1] == 0 && v[2] == 0 && v[3] == 0 && v[4] == 1);
+    }
+
+    {
+        double const    in[] = { 0.5, 1.5, 2.5, 3.5, 4.49, 4.5, 4.51, -0.5 };
+        double          out[8];
+        int             iout[8];
+
+        har::round_to_nearest_even(in, out);
+        BOOST_CHECK(out[0] == 0 && out[1] == 2 && out[2] == 2 && out[3] == 4);
+        BOOST_CHECK(out[4] == 4 && out[5] == 4 && out[6] == 5);
+        har::round_simple(in, iout);
+        BOOST_CHECK(iout[0] == 1 && iout[1] == 2 && iout[2] == 3 && iout[3] == 4);
+        BOOST_CHECK(iout[4] == 4 && iout[5] == 5 && iout[6] == 5 && iout[7] == 0);
+    }
+
+    {
+        boost::int16_t const    a[] = { 32000, -32000, 200, -32768, 1, 2, 3, 4 };
+        boost::int16_t const    b[] = { 1000, -1000, 200, -1, 1, 2, 3, 4 };
+        boost::int16_t          out[8];
+
+        har::add_sat(a, b, out);
+        BOOST_CHECK(out[0] == 32767 && out[1] == -32768 && out[2] == 400 && out[3] == -32768);
+        har::mul_sat(a, b, out);
+        BOOST_CHECK(out[0] == 32767 && out[1] == 32767 && out[2] == 32767 && out[3] == 32767);
+        har::abs_sat(a, out);
+        BOOST_CHECK(out[1] == 32000 && out[3] == 32767);
+    }
+
+    return 0;
+}
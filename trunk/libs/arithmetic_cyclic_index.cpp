@@ -0,0 +1,192 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <limits>
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <boost/test/minimal.hpp>
+#include "../hwm/arithmetic/cyclic_index.hpp"
+
+namespace har = hwm::arithmetic;
+
+namespace {
+
+//! holds the exact positions.
+#if defined(BOOST_HAS_INT128)
+typedef boost::int128_type      wide_type;
+typedef boost::uint128_type     unsigned_wide_type;
+#else
+typedef boost::intmax_t         wide_type;
+typedef boost::uintmax_t        unsigned_wide_type;
+#endif
+
+wide_type   floor_div   (wide_type const x, wide_type const y)
+{
+    wide_type const q = x / y;
+    return (x % y != 0 && ((x < 0) != (y < 0))) ? q - 1 : q;
+}
+
+wide_type   mod_floored_reference   (wide_type const x, wide_type const n)
+{
+    return x - floor_div(x, n) * n;
+}
+
+wide_type   magnitude   (wide_type const x) { return (x < 0) ? -x : x; }
+
+boost::random::mt19937 gen(42);
+
+template<typename T>
+T       random_value    (T const lo = (std::numeric_limits<T>::min)(), T const hi = (std::numeric_limits<T>::max)())
+{
+    boost::random::uniform_int_distribution<T> dist(lo, hi);
+    return dist(gen);
+}
+
+//! a small value, or a value of the full range.
+template<typename T>
+T       random_operand  ()
+{
+    bool const small = random_value<int>(0, 1) == 0;
+    return small
+        ?   random_value<T>(static_cast<T>(std::numeric_limits<T>::is_signed ? -20 : 0), 20)
+        :   random_value<T>();
+}
+
+//! the values of the index equal mod_floored and mod_euclidean of the exact position,
+//! and the carries equal the differences of the floored quotients.
+template<typename T>
+bool    check_walk  (T const n, T const start, T const step)
+{
+    if(n == 0) { return true; }
+
+    har::cyclic_index<T> c(n, start, step);
+    wide_type const m = magnitude(n);
+    //the position is kept reduced, so that it never overflows.
+    wide_type pos = start;
+    bool ok = c.modulus() == n && c.step() == step;
+
+    for(int i = 0; i < 200; ++i) {
+        wide_type next = pos;
+        wide_type carry = 0;
+        T result = 0;
+        switch(random_value<int>(0, 4)) {
+        case 0: result = c.increment(); next = pos + step; carry = floor_div(next, m) - floor_div(pos, m); break;
+        case 1: result = c.decrement(); next = pos - step; carry = floor_div(pos, m) - floor_div(next, m); break;
+        case 2: ++c; next = pos + step; break;
+        case 3: {
+            T const k = random_operand<T>();
+            c.advance(k);
+            //the product of the reduced values, which fits in the unsigned wide type.
+            unsigned_wide_type const d =
+                static_cast<unsigned_wide_type>(mod_floored_reference(k, m)) *
+                static_cast<unsigned_wide_type>(mod_floored_reference(step, m)) %
+                static_cast<unsigned_wide_type>(m);
+            next = pos + static_cast<wide_type>(d);
+            break;
+        }
+        default: {
+            T const p = random_operand<T>();
+            c.seek(p);
+            next = p;
+            break;
+        }
+        }
+        ok = ok && result == static_cast<T>(carry);
+        pos = mod_floored_reference(next, m);
+        ok = ok && c.value() == static_cast<T>(mod_floored_reference(pos, n));
+        ok = ok && c.euclidean_value() == static_cast<T>(pos);
+    }
+    return ok;
+}
+
+template<typename T>
+void    test_type   ()
+{
+    T const boundaries[] = {
+        (std::numeric_limits<T>::min)(),
+        static_cast<T>((std::numeric_limits<T>::min)() + 1),
+        static_cast<T>(-1),
+        1, 2, 7,
+        static_cast<T>((std::numeric_limits<T>::max)() - 1),
+        (std::numeric_limits<T>::max)(),
+    };
+    std::size_t const count = sizeof(boundaries) / sizeof(boundaries[0]);
+    for(std::size_t i = 0; i < count; ++i) {
+        for(std::size_t j = 0; j < count; ++j) {
+            BOOST_CHECK(check_walk<T>(boundaries[i], 0, boundaries[j]));
+            BOOST_CHECK(check_walk<T>(boundaries[i], boundaries[j], static_cast<T>(boundaries[j] / 2)));
+        }
+    }
+    for(int i = 0; i < 300; ++i) {
+        BOOST_CHECK(check_walk<T>(random_operand<T>(), random_operand<T>(), random_operand<T>()));
+    }
+}
+
+//! a flattened two dimensional walk over a w * h torus.
+//! the column wraps around |w|, and the carries move the row.
+bool    check_two_dimensions    (int const w, int const h, int const start, int const step)
+{
+    wide_type const m = magnitude(w);
+    har::cyclic_index<int> col(w, start, step);
+    har::cyclic_index<int> row(h, static_cast<int>(floor_div(start, m)), 1);
+    wide_type pos = start;
+    bool ok = true;
+    for(int i = 0; i < 1000; ++i) {
+        ok = ok && col.value() == static_cast<int>(mod_floored_reference(pos, w));
+        ok = ok && row.value() == static_cast<int>(mod_floored_reference(floor_div(pos, m), h));
+        row.advance(col.increment());
+        pos += step;
+    }
+    return ok;
+}
+
+}   //namespace
+
+int test_main(int, char**)
+{
+    {
+        //a ring buffer walked backward, and the negative modulus.
+        har::cyclic_index<int> c(5, 2, -3);
+        int const floored[] = { 2, 4, 1, 3, 0, 2 };
+        for(int i = 0; i < 6; ++i, ++c) { BOOST_CHECK(c.value() == floored[i]); }
+
+        har::cyclic_index<int> d(-5, 2, 3);
+        for(int i = 0; i < 20; ++i, ++d) {
+            BOOST_CHECK(d.value() == har::mod_floored(2 + 3 * i, -5));
+            BOOST_CHECK(d.euclidean_value() == har::mod_euclidean(2 + 3 * i, -5));
+        }
+    }
+
+    {
+        //the steps larger than the modulus carry more than once.
+        har::cyclic_index<int> c(4, 1, 9);
+        BOOST_CHECK(c.increment() == 2 && c.value() == 2);
+        BOOST_CHECK(c.decrement() == 2 && c.value() == 1);
+        BOOST_CHECK((c += 3).value() == 0);
+        BOOST_CHECK(c.seek(-1).value() == 3);
+        BOOST_CHECK(c == har::cyclic_index<int>(4, 7));
+        BOOST_CHECK(c != har::cyclic_index<int>(4, 6));
+    }
+
+    BOOST_CHECK(check_two_dimensions(7, 5, 0, 1));
+    BOOST_CHECK(check_two_dimensions(7, 5, -3, 3));
+    BOOST_CHECK(check_two_dimensions(7, 5, 11, -9));
+    BOOST_CHECK(check_two_dimensions(-7, 5, 11, 16));
+
+    test_type<boost::int8_t>();
+    test_type<boost::int16_t>();
+    test_type<boost::uint8_t>();
+    test_type<boost::uint16_t>();
+#if defined(BOOST_HAS_INT128)
+    test_type<boost::int32_t>();
+    test_type<boost::int64_t>();
+    test_type<boost::uint32_t>();
+    test_type<boost::uint64_t>();
+#endif
+
+    return 0;
+}
@@ -0,0 +1,191 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <limits>
+#include <boost/cstdint.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <boost/test/minimal.hpp>
+#include "../hwm/arithmetic/divisor.hpp"
+
+namespace har = hwm::arithmetic;
+
+namespace {
+
+//! straightforward definitions by the builtin operators.
+template<typename T>
+struct reference
+{
+    T q_tr, r_tr, q_fl, r_fl, q_eu, r_eu;
+
+    reference(T const n, T const d)
+    {
+        q_tr = n / d;
+        r_tr = n % d;
+
+        q_fl = q_tr;
+        r_fl = r_tr;
+        if(r_tr != 0 && ((r_tr < 0) != (d < 0))) {
+            q_fl = q_fl - 1;
+            r_fl = r_fl + d;
+        }
+
+        q_eu = q_tr;
+        r_eu = r_tr;
+        if(r_tr < 0) {
+            if(d > 0)   { q_eu = q_eu - 1; r_eu = r_eu + d; }
+            else        { q_eu = q_eu + 1; r_eu = r_eu - d; }
+        }
+    }
+};
+
+template<typename T>
+bool    equals_reference    (T const n, har::divisor<T> const &d)
+{
+    reference<T> const ref(n, d.value());
+    return
+        d.div_truncated(n)  == ref.q_tr &&
+        d.mod_truncated(n)  == ref.r_tr &&
+        d.div_floored(n)    == ref.q_fl &&
+        d.mod_floored(n)    == ref.r_fl &&
+        d.div_euclidean(n)  == ref.q_eu &&
+        d.mod_euclidean(n)  == ref.r_eu;
+}
+
+template<typename T>
+bool    equals_free_functions   (T const n, har::divisor<T> const &d)
+{
+    T const v = d.value();
+    return
+        har::div_truncated(n, d)    == har::div_truncated(n, v) &&
+        har::mod_truncated(n, d)    == har::mod_truncated(n, v) &&
+        har::div_floored(n, d)      == har::div_floored(n, v) &&
+        har::mod_floored(n, d)      == har::mod_floored(n, v) &&
+        har::div_euclidean(n, d)    == har::div_euclidean(n, v) &&
+        har::mod_euclidean(n, d)    == har::mod_euclidean(n, v);
+}
+
+//! the result of `min / -1' is not representable.
+template<typename T>
+bool    is_overflow (T const n, T const d)
+{
+    return
+        std::numeric_limits<T>::is_signed &&
+        n == (std::numeric_limits<T>::min)() &&
+        d == static_cast<T>(-1);
+}
+
+template<typename T>
+void    test_exhaustive ()
+{
+    int const lo = (std::numeric_limits<T>::min)();
+    int const hi = (std::numeric_limits<T>::max)();
+
+    for(int d = lo; d <= hi; ++d) {
+        if(d == 0) { continue; }
+        har::divisor<T> const div(static_cast<T>(d));
+        bool ok = true;
+        for(int n = lo; n <= hi; ++n) {
+            if(is_overflow(static_cast<T>(n), static_cast<T>(d))) { continue; }
+            ok = ok && equals_reference(static_cast<T>(n), div);
+            if(n != lo || !std::numeric_limits<T>::is_signed) {
+                ok = ok && equals_free_functions(static_cast<T>(n), div);
+            }
+        }
+        BOOST_CHECK(ok);
+    }
+}
+
+template<typename T>
+void    test_random (std::size_t divisor_count, std::size_t dividend_count)
+{
+    boost::random::mt19937 gen(42);
+    boost::random::uniform_int_distribution<T> dist(
+        (std::numeric_limits<T>::min)(), (std::numeric_limits<T>::max)() );
+    boost::random::uniform_int_distribution<int> bits(0, std::numeric_limits<T>::digits - 1);
+
+    for(std::size_t i = 0; i < divisor_count; ++i) {
+        //divisors of every magnitude.
+        T d = static_cast<T>(dist(gen) >> bits(gen));
+        if(d == 0) { d = 1; }
+        har::divisor<T> const div(d);
+
+        bool ok = true;
+        for(std::size_t j = 0; j < dividend_count; ++j) {
+            T const n = dist(gen);
+            if(is_overflow(n, d)) { continue; }
+            ok = ok && equals_reference(n, div);
+        }
+        BOOST_CHECK(ok);
+    }
+}
+
+template<typename T>
+void    test_boundaries ()
+{
+    T const values[] = {
+        (std::numeric_limits<T>::min)(),
+        static_cast<T>((std::numeric_limits<T>::min)() + 1),
+        static_cast<T>((std::numeric_limits<T>::min)() / 2),
+        static_cast<T>(-3), static_cast<T>(-2), static_cast<T>(-1),
+        static_cast<T>(0), static_cast<T>(1), static_cast<T>(2), static_cast<T>(3),
+        static_cast<T>((std::numeric_limits<T>::max)() / 2),
+        static_cast<T>((std::numeric_limits<T>::max)() - 1),
+        (std::numeric_limits<T>::max)()
+    };
+    std::size_t const count = sizeof(values) / sizeof(values[0]);
+
+    bool ok = true;
+    for(std::size_t i = 0; i < count; ++i) {
+        if(values[i] == 0) { continue; }
+        har::divisor<T> const div(values[i]);
+        for(std::size_t j = 0; j < count; ++j) {
+            if(is_overflow(values[j], values[i])) { continue; }
+            ok = ok && equals_reference(values[j], div);
+        }
+    }
+    BOOST_CHECK(ok);
+}
+
+}   //namespace
+
+int test_main(int, char**)
+{
+    test_exhaustive<boost::int8_t>();
+    test_exhaustive<boost::uint8_t>();
+
+    test_random<boost::int16_t>(2000, 2000);
+    test_random<boost::uint16_t>(2000, 2000);
+    test_random<boost::int32_t>(2000, 2000);
+    test_random<boost::uint32_t>(2000, 2000);
+    test_random<boost::int64_t>(2000, 2000);
+    test_random<boost::uint64_t>(2000, 2000);
+
+    test_boundaries<boost::int16_t>();
+    test_boundaries<boost::uint16_t>();
+    test_boundaries<boost::int32_t>();
+    test_boundaries<boost::uint32_t>();
+    test_boundaries<boost::int64_t>();
+    test_boundaries<boost::uint64_t>();
+
+    {
+        har::divisor<int> const four(4);
+        BOOST_CHECK(four.value() == 4);
+        BOOST_CHECK(har::div_floored(-13, four)     == -4);
+        BOOST_CHECK(har::mod_floored(-13, four)     == 3);
+        BOOST_CHECK(har::div_euclidean(-13, four)   == -4);
+        BOOST_CHECK(har::mod_euclidean(-13, four)   == 3);
+
+        har::divisor<int> const minus_four(-4);
+        BOOST_CHECK(har::div_truncated(13, minus_four)  == -3);
+        BOOST_CHECK(har::mod_truncated(13, minus_four)  == 1);
+        BOOST_CHECK(har::div_floored(13, minus_four)    == -4);
+        BOOST_CHECK(har::mod_floored(13, minus_four)    == -3);
+        BOOST_CHECK(har::div_euclidean(-13, minus_four) == 4);
+        BOOST_CHECK(har::mod_euclidean(-13, minus_four) == 3);
+    }
+
+    return 0;
+}
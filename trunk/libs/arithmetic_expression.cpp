@@ -0,0 +1,168 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+#include <boost/test/minimal.hpp>
+#include "../hwm/arithmetic/expression.hpp"
+
+namespace har = hwm::arithmetic;
+namespace hae = har::expression;
+
+namespace {
+
+//! equal, or both NaN.
+template<typename T>
+bool    same_value  (T const x, T const y)
+{
+    return x == y || (x != x && y != y);
+}
+
+//! the evaluation over an array equals the value of the expression for each element,
+//! for the lengths around the blocks.
+template<typename T, typename U, typename E>
+bool    check_evaluate  (std::vector<T> const &x, hae::expression_base<E> const &e)
+{
+    std::size_t const lengths[] = { 0, 1, 7, 255, 256, 257, 511, 1000, x.size() };
+    bool ok = true;
+    for(std::size_t k = 0; k < sizeof(lengths) / sizeof(lengths[0]); ++k) {
+        std::size_t const n = lengths[k];
+        std::vector<U> out(n + 1);
+        out[n] = 42;
+        T const * const first = x.empty() ? 0 : &x[0];
+        ok = ok && hae::evaluate(first, first + n, e, &out[0]) == &out[0] + n;
+        ok = ok && out[n] == 42;
+        for(std::size_t i = 0; i < n; ++i) {
+            ok = ok && same_value(out[i], static_cast<U>(e.derived()(x[i])));
+        }
+    }
+    return ok;
+}
+
+template<typename T>
+std::vector<T>  make_integral   (T const lo, T const hi)
+{
+    boost::random::mt19937 gen(42);
+    boost::random::uniform_int_distribution<T> dist(lo, hi);
+    std::vector<T> v(3000);
+    for(std::size_t i = 0; i < v.size(); ++i) { v[i] = dist(gen); }
+    return v;
+}
+
+template<typename T>
+std::vector<T>  make_floating   ()
+{
+    boost::random::mt19937 gen(42);
+    boost::random::uniform_real_distribution<double> dist(-100000.0, 100000.0);
+    std::vector<T> v(3000);
+    for(std::size_t i = 0; i < v.size(); ++i) {
+        //ties of rounding, too.
+        v[i] = static_cast<T>((i % 4 == 0) ? static_cast<int>(dist(gen)) + 0.5 : dist(gen));
+    }
+    return v;
+}
+
+template<typename T>
+void    test_integral   ()
+{
+    std::vector<T> const x = make_integral<T>(-40000, 40000);
+    har::divisor<T> const d(7);
+
+    BOOST_CHECK((check_evaluate<T, T>(x, hae::element)));
+    BOOST_CHECK((check_evaluate<T, T>(x, hae::element * 3 + 1)));
+    BOOST_CHECK((check_evaluate<T, T>(x, 5 - hae::element)));
+    BOOST_CHECK((check_evaluate<T, T>(x, -hae::element / 3)));
+    BOOST_CHECK((check_evaluate<T, T>(x, hae::abs(hae::element) + hae::element * hae::element)));
+    BOOST_CHECK((check_evaluate<T, T>(x, hae::mod_truncated(hae::element, -7))));
+    BOOST_CHECK((check_evaluate<T, T>(x, hae::mod_floored(hae::element, -7))));
+    BOOST_CHECK((check_evaluate<T, T>(x, hae::mod_euclidean(hae::element * 2 + 1, -7))));
+    BOOST_CHECK((check_evaluate<T, T>(x, hae::div_truncated(hae::element, 1000))));
+    BOOST_CHECK((check_evaluate<T, T>(x, hae::div_floored(hae::element, d))));
+    BOOST_CHECK((check_evaluate<T, T>(x, hae::div_euclidean(hae::element, -3))));
+    BOOST_CHECK((check_evaluate<T, T>(x, hae::mod_floored(hae::div_floored(hae::element, 10), d))));
+    BOOST_CHECK((check_evaluate<T, double>(x, hae::cast<double>(hae::element) * 0.5)));
+}
+
+template<typename T>
+void    test_floating   ()
+{
+    std::vector<T> const x = make_floating<T>();
+
+    BOOST_CHECK((check_evaluate<T, T>(x, hae::round_simple(hae::element))));
+    BOOST_CHECK((check_evaluate<T, T>(x, hae::round_to_nearest_even(hae::element * T(0.5)))));
+    BOOST_CHECK((check_evaluate<T, T>(x, hae::abs(hae::element - T(10)) / T(3))));
+    BOOST_CHECK((check_evaluate<T, T>(x, hae::mod_truncated(hae::element, T(-7.5)))));
+    BOOST_CHECK((check_evaluate<T, T>(x, hae::mod_floored(hae::element, T(-7.5)))));
+    BOOST_CHECK((check_evaluate<T, T>(x, hae::mod_euclidean(hae::element, T(-7.5)))));
+    BOOST_CHECK((check_evaluate<T, T>(x, hae::div_truncated(hae::element, T(3)))));
+    BOOST_CHECK((check_evaluate<T, T>(x, hae::div_floored(hae::element, T(-3)))));
+    BOOST_CHECK((check_evaluate<T, T>(x, hae::div_euclidean(hae::element, T(-3)))));
+    BOOST_CHECK((check_evaluate<T, boost::int32_t>(x, hae::cast<boost::int32_t>(hae::round_simple(hae::element)))));
+    BOOST_CHECK((check_evaluate<T, boost::int32_t>(x, hae::cast<boost::int32_t>(hae::round_to_nearest_even(hae::element)))));
+    BOOST_CHECK((check_evaluate<T, boost::int64_t>(x, hae::cast<boost::int64_t>(hae::round_to_nearest_even(hae::element)) * 3)));
+
+    //the example of expression.hpp gives the same results as the calls of the bulk functions one after another.
+    std::size_t const n = x.size();
+    std::vector<T> scaled(n);
+    std::vector<int> staged(n), fused(n);
+    for(std::size_t i = 0; i < n; ++i) { scaled[i] = x[i] * T(0.25); }
+    har::round_to_nearest_even(&scaled[0], &scaled[0] + n, &staged[0]);
+    for(std::size_t i = 0; i < n; ++i) { staged[i] += 100; }
+    har::mod_euclidean(&staged[0], &staged[0] + n, -60, &staged[0]);
+    hae::evaluate(&x[0], &x[0] + n,
+        hae::mod_euclidean(hae::cast<int>(hae::round_to_nearest_even(hae::element * T(0.25))) + 100, -60),
+        &fused[0] );
+    BOOST_CHECK(staged == fused);
+}
+
+void    test_all_types  ()
+{
+    test_integral<boost::int32_t>();
+    test_integral<boost::int64_t>();
+    test_floating<float>();
+    test_floating<double>();
+    test_floating<long double>();
+}
+
+}   //namespace
+
+int test_main(int, char**)
+{
+    har::simd_level const levels[] = { har::simd_none, har::simd_sse41, har::simd_avx2 };
+    for(std::size_t i = 0; i < sizeof(levels)/sizeof(levels[0]); ++i) {
+        if(levels[i] > har::detected_simd_level()) { break; }
+        har::limit_simd_level(levels[i]);
+        BOOST_CHECK(har::current_simd_level() == levels[i]);
+        test_all_types();
+    }
+    har::limit_simd_level(har::simd_avx2);
+
+    {
+        //in place.
+        std::vector<int> v = make_integral<int>(-1000, 1000);
+        std::vector<int> expected(v.size());
+        for(std::size_t i = 0; i < v.size(); ++i) { expected[i] = har::mod_floored(v[i] * 3 - 1, 10); }
+        hae::evaluate(&v[0], &v[0] + v.size(), hae::mod_floored(hae::element * 3 - 1, 10), &v[0]);
+        BOOST_CHECK(v == expected);
+    }
+
+    {
+        //arrays.
+        double const    in[] = { -2.5, -1.5, -0.5, 0.5, 1.5, 2.5 };
+        int             expected[6], out[6];
+        har::round_to_nearest_even(in, expected);
+        BOOST_CHECK(hae::evaluate(in, hae::cast<int>(hae::round_to_nearest_even(hae::element)), out) == out + 6);
+        BOOST_CHECK(std::equal(out, out + 6, expected));
+        har::round_simple(in, expected);
+        hae::evaluate(in, hae::cast<int>(hae::round_simple(hae::element)), out);
+        BOOST_CHECK(std::equal(out, out + 6, expected));
+    }
+
+    return 0;
+}
@@ -0,0 +1,172 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <boost/test/minimal.hpp>
+#include "../hwm/arithmetic.hpp"
+
+namespace har = hwm::arithmetic;
+
+#if defined(BOOST_HAS_INT128)
+
+namespace {
+
+typedef boost::int128_type  int128;
+typedef boost::uint128_type uint128;
+
+int128 const int128_max = static_cast<int128>(~static_cast<uint128>(0) >> 1);
+int128 const int128_min = -int128_max - 1;
+
+boost::random::mt19937_64 gen(42);
+
+//! a random value of a random width, so that both of the 64-bit halves are covered.
+uint128 random_bits ()
+{
+    boost::random::uniform_int_distribution<int> width(0, 128);
+    uint128 const x = (static_cast<uint128>(gen()) << 64) | gen();
+    int const w = width(gen);
+    return (w == 0) ? 0 : x >> (128 - w);
+}
+
+//! reference implementation by the builtin operators, which call the library routines.
+//! the quotient is adjusted with branches by the definition of each division.
+bool    equals_reference    (int128 const n, int128 const d)
+{
+    int128 const q_tr = n / d;
+    int128 const r_tr = n % d;
+
+    int128 q_fl = q_tr, r_fl = r_tr;
+    if(r_tr != 0 && ((r_tr < 0) != (d < 0))) { q_fl -= 1; r_fl += d; }
+
+    int128 q_eu = q_tr, r_eu = r_tr;
+    if(r_tr < 0) {
+        if(d > 0)   { q_eu -= 1; r_eu += d; }
+        else        { q_eu += 1; r_eu -= d; }
+    }
+
+    return
+        har::div_truncated(n, d)    == q_tr &&
+        har::mod_truncated(n, d)    == r_tr &&
+        har::div_floored(n, d)      == q_fl &&
+        har::mod_floored(n, d)      == r_fl &&
+        har::div_euclidean(n, d)    == q_eu &&
+        har::mod_euclidean(n, d)    == r_eu;
+}
+
+bool    equals_reference    (uint128 const n, uint128 const d)
+{
+    return
+        har::div_truncated(n, d)    == n / d &&
+        har::mod_truncated(n, d)    == n % d &&
+        har::div_floored(n, d)      == n / d &&
+        har::mod_floored(n, d)      == n % d &&
+        har::div_euclidean(n, d)    == n / d &&
+        har::mod_euclidean(n, d)    == n % d;
+}
+
+void    test_boundaries ()
+{
+    uint128 const one = 1;
+    uint128 const unsigned_values[] = {
+        0, 1, 2, 3, 7, 10,
+        (one << 63) - 1, one << 63, (one << 64) - 1, one << 64, (one << 64) + 1,
+        (one << 64) * 3 + 5, (one << 127) - 1, one << 127, ~one, ~static_cast<uint128>(0),
+    };
+    std::size_t const count = sizeof(unsigned_values) / sizeof(unsigned_values[0]);
+
+    for(std::size_t i = 0; i < count; ++i) {
+        for(std::size_t j = 0; j < count; ++j) {
+            uint128 const n = unsigned_values[i];
+            uint128 const d = unsigned_values[j];
+            if(d != 0) {
+                BOOST_CHECK(equals_reference(n, d));
+            }
+            int128 const signed_values[] = {
+                static_cast<int128>(n), -static_cast<int128>(n >> 1), static_cast<int128>(n >> 1) };
+            int128 const signed_divisors[] = {
+                static_cast<int128>(d), -static_cast<int128>(d >> 1), static_cast<int128>(d >> 1) };
+            for(std::size_t k = 0; k < 3; ++k) {
+                for(std::size_t l = 0; l < 3; ++l) {
+                    int128 const x = signed_values[k];
+                    int128 const y = signed_divisors[l];
+                    if(y == 0 || (x == int128_min && y == -1)) { continue; }
+                    BOOST_CHECK(equals_reference(x, y));
+                }
+            }
+        }
+    }
+
+    //the moduli by -1 are 0, and the quotients of min / -1 wrap around to min.
+    BOOST_CHECK(har::mod_truncated(int128_min, int128(-1)) == 0);
+    BOOST_CHECK(har::mod_floored(int128_min, int128(-1)) == 0);
+    BOOST_CHECK(har::mod_euclidean(int128_min, int128(-1)) == 0);
+    BOOST_CHECK(har::div_truncated(int128_min, int128(-1)) == int128_min);
+    BOOST_CHECK(har::mod_euclidean(int128(-1), int128_min) == int128_max);
+    BOOST_CHECK(har::div_floored(int128(-1), int128_min) == 0);
+    BOOST_CHECK(har::div_euclidean(int128(-1), int128_min) == 1);
+}
+
+void    test_random (std::size_t count)
+{
+    for(std::size_t i = 0; i < count; ++i) {
+        uint128 const n = random_bits();
+        uint128 const d = random_bits();
+        if(d == 0) { continue; }
+        BOOST_CHECK(equals_reference(n, d));
+
+        int128 const x = static_cast<int128>(n);
+        int128 const y = static_cast<int128>(d);
+        if(x == int128_min && y == -1) { continue; }
+        BOOST_CHECK(equals_reference(x, y));
+    }
+}
+
+void    test_abs_sign   ()
+{
+    int128 const big = static_cast<int128>(1) << 100;
+    BOOST_CHECK(har::abs(-big) == big);
+    BOOST_CHECK(har::abs(int128_max) == int128_max);
+    BOOST_CHECK(har::abs(-int128_max) == int128_max);
+    BOOST_CHECK(har::abs(~static_cast<uint128>(0)) == ~static_cast<uint128>(0));
+    BOOST_CHECK(har::sign(-big) == -1);
+    BOOST_CHECK(har::sign(int128(0)) == 0);
+    BOOST_CHECK(har::sign(big) == 1);
+    BOOST_CHECK(har::sign(~static_cast<uint128>(0)) == 1);
+    BOOST_CHECK(har::odd(int128_min + 1) && har::even(int128_min));
+    BOOST_CHECK(har::odd(~static_cast<uint128>(0)) && har::even(static_cast<uint128>(1) << 127));
+}
+
+}   //namespace
+
+int test_main(int, char**)
+{
+    {
+        //nanoseconds since the epoch, split into seconds and the sub-second part.
+        int128 const ns = -(static_cast<int128>(1700000000) * 1000000000 + 250);
+        int128 const second = 1000000000;
+        BOOST_CHECK(har::div_floored(ns, second) == -1700000001);
+        BOOST_CHECK(har::mod_floored(ns, second) == second - 250);
+        BOOST_CHECK(har::div_truncated(ns, second) == -1700000000);
+        BOOST_CHECK(har::mod_truncated(ns, second) == -250);
+    }
+
+    test_boundaries();
+    test_random(200000);
+    test_abs_sign();
+
+    return 0;
+}
+
+#else
+
+int test_main(int, char**)
+{
+    return 0;
+}
+
+#endif
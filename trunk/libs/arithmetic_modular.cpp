@@ -0,0 +1,177 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <limits>
+#include <vector>
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <boost/test/minimal.hpp>
+#include "../hwm/arithmetic/modular.hpp"
+
+namespace har = hwm::arithmetic;
+
+namespace {
+
+//! a type wide enough to hold the exact sum and product.
+template<typename T> struct wide;
+template<> struct wide<boost::int8_t>   { typedef boost::int64_t  type; };
+template<> struct wide<boost::int16_t>  { typedef boost::int64_t  type; };
+template<> struct wide<boost::int32_t>  { typedef boost::int64_t  type; };
+template<> struct wide<boost::uint8_t>  { typedef boost::uint64_t type; };
+template<> struct wide<boost::uint16_t> { typedef boost::uint64_t type; };
+template<> struct wide<boost::uint32_t> { typedef boost::uint64_t type; };
+#if defined(BOOST_HAS_INT128)
+template<> struct wide<boost::int64_t>  { typedef boost::int128_type  type; };
+template<> struct wide<boost::uint64_t> { typedef boost::uint128_type type; };
+#endif
+
+//! the exact value reduced by mod_euclidean.
+template<typename T>
+struct reference
+{
+    typedef typename wide<T>::type W;
+
+    static T    reduce  (W const x, T const m)
+    {
+        W d = static_cast<W>(m);
+        if(d < 0) { d = static_cast<W>(0) - d; }
+        W r = x % d;
+        if(r < 0) { r = r + d; }
+        return static_cast<T>(r);
+    }
+
+    static T    add (T const x, T const y, T const m) { return reduce(static_cast<W>(x) + static_cast<W>(y), m); }
+    static T    mul (T const x, T const y, T const m) { return reduce(static_cast<W>(x) * static_cast<W>(y), m); }
+
+    static T    pow (T const x, boost::uintmax_t e, T const m)
+    {
+        T base  = reduce(x, m);
+        T acc   = reduce(1, m);
+        for( ; e != 0; e >>= 1) {
+            if(e & 1) { acc = mul(acc, base, m); }
+            base = mul(base, base, m);
+        }
+        return acc;
+    }
+};
+
+template<typename T>
+bool    check_values    (har::modular_context<T> const &ctx, std::vector<T> const &x)
+{
+    typedef reference<T> ref;
+    T const m = ctx.modulus();
+    bool ok = true;
+
+    std::vector<T> out(x.size());
+    T * const end = ctx.reduce(&x[0], &x[0] + x.size(), &out[0]);
+    ok = ok && (end == &out[0] + x.size());
+
+    for(std::size_t i = 0; i < x.size(); ++i) {
+        T const y = x[(i * 7 + 3) % x.size()];
+        T const expected = har::mod_euclidean(x[i], m);
+
+        ok = ok && ctx.reduce(x[i]) == expected;
+        ok = ok && out[i] == expected;
+        ok = ok && ctx.add_mod(x[i], y) == ref::add(x[i], y, m);
+        ok = ok && ctx.mul_mod(x[i], y) == ref::mul(x[i], y, m);
+        ok = ok && ctx.pow_mod(x[i], i) == ref::pow(x[i], i, m);
+    }
+    return ok;
+}
+
+//! boundaries, small values and random values.
+template<typename T>
+std::vector<T>  make_values     (boost::random::mt19937 &gen, std::size_t random_count)
+{
+    T const lo = (std::numeric_limits<T>::min)();
+    T const hi = (std::numeric_limits<T>::max)();
+
+    std::vector<T> v;
+    v.push_back(lo);
+    v.push_back(static_cast<T>(lo + 1));
+    v.push_back(hi);
+    v.push_back(static_cast<T>(hi - 1));
+    for(int i = -5; i <= 5; ++i) {
+        if(i < 0 && !std::numeric_limits<T>::is_signed) { continue; }
+        v.push_back(static_cast<T>(i));
+    }
+
+    boost::random::uniform_int_distribution<T> dist(lo, hi);
+    for(std::size_t i = 0; i < random_count; ++i) {
+        v.push_back(dist(gen));
+    }
+    return v;
+}
+
+template<typename T>
+void    test_modular    (std::size_t modulus_count)
+{
+    boost::random::mt19937 gen(42);
+    std::vector<T> const x = make_values<T>(gen, 200);
+
+    //both odd and even moduli of every magnitude, and the boundaries.
+    std::vector<T> moduli = make_values<T>(gen, modulus_count);
+    boost::random::uniform_int_distribution<int> bits(0, std::numeric_limits<T>::digits - 1);
+    for(std::size_t i = 0; i < modulus_count; ++i) {
+        moduli.push_back(static_cast<T>(moduli[i] >> bits(gen)));
+    }
+    moduli.push_back(static_cast<T>(static_cast<T>(1) << (std::numeric_limits<T>::digits - 1)));
+
+    for(std::size_t i = 0; i < moduli.size(); ++i) {
+        if(moduli[i] == 0) { continue; }
+        har::modular_context<T> const ctx(moduli[i]);
+        BOOST_CHECK(check_values(ctx, x));
+    }
+}
+
+}   //namespace
+
+int test_main(int, char**)
+{
+    test_modular<boost::int8_t>(100);
+    test_modular<boost::uint8_t>(100);
+    test_modular<boost::int16_t>(100);
+    test_modular<boost::uint16_t>(100);
+    test_modular<boost::int32_t>(200);
+    test_modular<boost::uint32_t>(200);
+#if defined(BOOST_HAS_INT128)
+    test_modular<boost::int64_t>(200);
+    test_modular<boost::uint64_t>(200);
+#endif
+
+    {
+        har::modular_context<int> const seven(7);
+        BOOST_CHECK(seven.modulus() == 7);
+        BOOST_CHECK(seven.reduce(-1) == 6);
+        BOOST_CHECK(seven.add_mod(5, 4) == 2);
+        BOOST_CHECK(seven.mul_mod(-3, 5) == 6);
+        BOOST_CHECK(seven.pow_mod(3, 6) == 1);
+        BOOST_CHECK(seven.pow_mod(-2, 3) == 6);
+
+        int const   in[] = { -8, -7, -1, 0, 1, 13 };
+        int         out[6];
+        seven.reduce(in, out);
+        BOOST_CHECK(out[0] == 6 && out[1] == 0 && out[2] == 6 && out[3] == 0 && out[4] == 1 && out[5] == 6);
+
+        har::modular_context<int> const minus_seven(-7);
+        BOOST_CHECK(minus_seven.mul_mod(-3, 5) == 6);
+
+        har::modular_context<int> const one(1);
+        BOOST_CHECK(one.pow_mod(5, 0) == 0);
+    }
+
+    {
+        //2^61 - 1 is a Mersenne prime. a^(p-1) == 1 by Fermat's little theorem.
+        boost::uint64_t const p = (static_cast<boost::uint64_t>(1) << 61) - 1;
+        har::modular_context<boost::uint64_t> const ctx(p);
+        BOOST_CHECK(ctx.pow_mod(3, p - 1) == 1);
+        BOOST_CHECK(ctx.mul_mod(p - 1, p - 1) == 1);
+        BOOST_CHECK(ctx.mul_mod(~static_cast<boost::uint64_t>(0), ~static_cast<boost::uint64_t>(0)) == 49);
+    }
+
+    return 0;
+}
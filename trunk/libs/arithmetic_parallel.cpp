@@ -0,0 +1,146 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+#include <boost/test/minimal.hpp>
+#include "../hwm/arithmetic/parallel.hpp"
+
+namespace har = hwm::arithmetic;
+namespace hap = har::parallel;
+
+namespace {
+
+template<typename T>
+std::vector<T>  make_input  (std::size_t n)
+{
+    boost::random::mt19937 gen(42);
+    boost::random::uniform_int_distribution<T> dist(
+        static_cast<T>((std::numeric_limits<T>::min)() + (std::numeric_limits<T>::is_signed ? 1 : 0)),
+        (std::numeric_limits<T>::max)() );
+    std::vector<T> v(n);
+    for(std::size_t i = 0; i < n; ++i) { v[i] = dist(gen); }
+    return v;
+}
+
+//! the parallel functions give the same results as the bulk functions.
+template<typename T>
+bool    check_divisions (std::vector<T> const &x, T const d, hwm::thread_pool &pool)
+{
+    std::size_t const n = x.size();
+    har::divisor<T> const dd(d);
+    //one more element, to see that nothing is written past the end.
+    std::vector<T> expected(n + 1), actual(n + 1);
+    T const * const first = x.empty() ? 0 : &x[0];
+    T * const e = &expected[0];
+    bool ok = true;
+
+#define HWM_CHECK_PARALLEL(name)                                                        \
+    har::name(first, first + n, d, e);                                                  \
+    actual[n] = 42;                                                                     \
+    ok = ok && hap::name(first, first + n, d, &actual[0], pool) == &actual[0] + n;      \
+    ok = ok && actual[n] == 42;                                                         \
+    ok = ok && std::equal(e, e + n, actual.begin());            \
+    ok = ok && hap::name(first, first + n, dd, &actual[0], pool) == &actual[0] + n;     \
+    ok = ok && std::equal(e, e + n, actual.begin());
+
+    HWM_CHECK_PARALLEL(mod_truncated)
+    HWM_CHECK_PARALLEL(mod_floored)
+    HWM_CHECK_PARALLEL(mod_euclidean)
+    HWM_CHECK_PARALLEL(div_truncated)
+    HWM_CHECK_PARALLEL(div_floored)
+    HWM_CHECK_PARALLEL(div_euclidean)
+
+#undef HWM_CHECK_PARALLEL
+    return ok;
+}
+
+template<typename T>
+void    test_divisions  (hwm::thread_pool &pool)
+{
+    std::size_t const chunk = hap::detail::chunk_length<T, T>();
+    std::size_t const lengths[] = { 0, 1, chunk - 1, chunk, chunk + 1, 3 * chunk + 5, 20 * chunk };
+    for(std::size_t i = 0; i < sizeof(lengths)/sizeof(lengths[0]); ++i) {
+        std::vector<T> const x = make_input<T>(lengths[i]);
+        BOOST_CHECK(check_divisions(x, static_cast<T>(7), pool));
+        BOOST_CHECK(check_divisions(x, static_cast<T>(std::numeric_limits<T>::is_signed ? -1000 : 1000), pool));
+    }
+}
+
+bool    check_rounding  (std::size_t n, hwm::thread_pool &pool)
+{
+    boost::random::mt19937 gen(42);
+    boost::random::uniform_real_distribution<double> dist(-1e9, 1e9);
+    std::vector<double> x(n);
+    for(std::size_t i = 0; i < n; ++i) { x[i] = dist(gen) / 8; }
+
+    std::vector<boost::int32_t> expected(n), actual(n);
+    std::vector<double> expected_d(n), actual_d(n);
+    bool ok = true;
+
+    har::round_simple(&x[0], &x[0] + n, &expected[0]);
+    ok = ok && hap::round_simple(&x[0], &x[0] + n, &actual[0], pool) == &actual[0] + n;
+    ok = ok && expected == actual;
+    har::round_to_nearest_even(&x[0], &x[0] + n, &expected_d[0]);
+    ok = ok && hap::round_to_nearest_even(&x[0], &x[0] + n, &actual_d[0], pool) == &actual_d[0] + n;
+    ok = ok && std::memcmp(&expected_d[0], &actual_d[0], n * sizeof(double)) == 0;
+    return ok;
+}
+
+//! the parallel evaluation gives the same results as the evaluation on one thread.
+bool    check_expression    (std::size_t n, hwm::thread_pool &pool)
+{
+    namespace hae = har::expression;
+    boost::random::mt19937 gen(42);
+    boost::random::uniform_real_distribution<float> dist(-1e6f, 1e6f);
+    std::vector<float> x(n + 1);
+    for(std::size_t i = 0; i < n; ++i) { x[i] = dist(gen); }
+
+    std::vector<int> expected(n + 1), actual(n + 1);
+    actual[n] = 42;
+    bool ok = true;
+    hae::evaluate(&x[0], &x[0] + n,
+        hae::mod_euclidean(hae::cast<int>(hae::round_to_nearest_even(hae::element * 0.5f)) + 7, 60),
+        &expected[0] );
+    ok = ok && hap::evaluate(&x[0], &x[0] + n,
+        hae::mod_euclidean(hae::cast<int>(hae::round_to_nearest_even(hae::element * 0.5f)) + 7, 60),
+        &actual[0], pool ) == &actual[0] + n;
+    ok = ok && actual[n] == 42;
+    ok = ok && std::equal(&expected[0], &expected[0] + n, &actual[0]);
+    return ok;
+}
+
+}   //namespace
+
+int test_main(int, char**)
+{
+    std::size_t const sizes[] = { 1, 3, 8 };
+    for(std::size_t s = 0; s < sizeof(sizes)/sizeof(sizes[0]); ++s) {
+        hwm::thread_pool pool(sizes[s]);
+        test_divisions<boost::int8_t>(pool);
+        test_divisions<boost::int32_t>(pool);
+        test_divisions<boost::uint32_t>(pool);
+        test_divisions<boost::int64_t>(pool);
+        BOOST_CHECK(check_rounding(1000, pool));
+        BOOST_CHECK(check_rounding(200000, pool));
+        BOOST_CHECK(check_expression(1000, pool));
+        BOOST_CHECK(check_expression(200000, pool));
+
+        //in place.
+        std::vector<int> v = make_input<int>(100000);
+        std::vector<int> expected(v.size());
+        har::mod_euclidean(&v[0], &v[0] + v.size(), 10, &expected[0]);
+        hap::mod_euclidean(&v[0], &v[0] + v.size(), 10, &v[0], pool);
+        BOOST_CHECK(v == expected);
+    }
+
+    return 0;
+}
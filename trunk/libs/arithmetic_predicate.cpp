@@ -0,0 +1,202 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <limits>
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+#include <boost/test/minimal.hpp>
+#include <boost/type_traits/integral_constant.hpp>
+#include <boost/type_traits/is_integral.hpp>
+#include "../hwm/arithmetic/predicate.hpp"
+
+namespace har = hwm::arithmetic;
+
+namespace {
+
+boost::random::mt19937 gen(42);
+
+template<typename T>
+std::vector<T>  make_input  (std::size_t n, boost::true_type)
+{
+    T const boundaries[] = {
+        (std::numeric_limits<T>::min)(), static_cast<T>((std::numeric_limits<T>::min)() + 1),
+        static_cast<T>(-1), 0, 1, 2,
+        static_cast<T>((std::numeric_limits<T>::max)() - 1), (std::numeric_limits<T>::max)(),
+    };
+    boost::random::uniform_int_distribution<T> dist((std::numeric_limits<T>::min)(), (std::numeric_limits<T>::max)());
+    std::vector<T> v(n);
+    for(std::size_t i = 0; i < n; ++i) {
+        v[i] = (i % 5 == 0) ? boundaries[(i / 5) % (sizeof(boundaries) / sizeof(boundaries[0]))] : dist(gen);
+    }
+    return v;
+}
+
+template<typename T>
+std::vector<T>  make_input  (std::size_t n, boost::false_type)
+{
+    T const boundaries[] = {
+        -std::numeric_limits<T>::infinity(), std::numeric_limits<T>::infinity(),
+        std::numeric_limits<T>::quiet_NaN(), -std::numeric_limits<T>::quiet_NaN(),
+        static_cast<T>(0), -static_cast<T>(0),
+        std::numeric_limits<T>::denorm_min(), -std::numeric_limits<T>::denorm_min(),
+    };
+    boost::random::uniform_real_distribution<double> dist(-1000.0, 1000.0);
+    std::vector<T> v(n);
+    for(std::size_t i = 0; i < n; ++i) {
+        v[i] = (i % 5 == 0) ? boundaries[(i / 5) % (sizeof(boundaries) / sizeof(boundaries[0]))] : static_cast<T>(dist(gen));
+    }
+    return v;
+}
+
+//! the bits of the mask equal the scalar predicate, and the bits past the end are zero.
+template<typename T, typename Pred>
+bool    equals_mask (std::vector<T> const &x, std::vector<boost::uint64_t> const &mask, Pred pred)
+{
+    bool ok = mask.size() == har::bitmask_size(x.size()) + 1;
+    for(std::size_t i = 0; i < (mask.size() - 1) * 64; ++i) {
+        bool const bit = ((mask[i / 64] >> (i % 64)) & 1) != 0;
+        ok = ok && bit == (i < x.size() && pred(x[i]));
+    }
+    return ok;
+}
+
+template<typename T> bool   is_odd      (T const &x) { return har::odd(x); }
+template<typename T> bool   is_even     (T const &x) { return har::even(x); }
+template<typename T> bool   is_negative (T const &x) { return har::sign(x) < 0; }
+template<typename T> bool   is_positive (T const &x) { return har::sign(x) > 0; }
+
+template<typename T>
+bool    check_selection (std::vector<T> const &x, std::vector<boost::uint64_t> const &mask)
+{
+    std::vector<T> expected;
+    std::vector<std::size_t> expected_indices;
+    for(std::size_t i = 0; i < x.size(); ++i) {
+        if(is_negative(x[i])) { expected.push_back(x[i]); expected_indices.push_back(i); }
+    }
+
+    std::vector<T> selected(x.size() + 1);
+    std::vector<std::size_t> indices(x.size() + 1);
+    T const * const first = x.empty() ? 0 : &x[0];
+    bool ok = har::select(first, first + x.size(), &mask[0], &selected[0]) == &selected[0] + expected.size();
+    ok = ok && har::select_indices(&mask[0], &mask[0] + mask.size(), &indices[0]) == &indices[0] + expected.size();
+    ok = ok && har::count_bits(&mask[0], &mask[0] + mask.size()) == expected.size();
+    ok = ok && har::count_negative(first, first + x.size()) == expected.size();
+    for(std::size_t i = 0; i < expected.size(); ++i) {
+        ok = ok && indices[i] == expected_indices[i];
+        ok = ok && x[indices[i]] == x[indices[i]] && selected[i] == expected[i];
+    }
+    return ok;
+}
+
+template<typename T>
+bool    check_sign_abs  (std::vector<T> const &x)
+{
+    std::vector<int> s(x.size() + 1, 42);
+    std::vector<T> a(x.size() + 1);
+    T const * const first = x.empty() ? 0 : &x[0];
+    bool ok = har::sign(first, first + x.size(), &s[0]) == &s[0] + x.size();
+    ok = ok && har::abs(first, first + x.size(), &a[0]) == &a[0] + x.size();
+    ok = ok && s[x.size()] == 42;
+    for(std::size_t i = 0; i < x.size(); ++i) {
+        ok = ok && s[i] == har::sign(x[i]);
+        //abs(min) wraps around to min.
+        if(std::numeric_limits<T>::is_integer && x[i] == (std::numeric_limits<T>::min)()) {
+            ok = ok && a[i] == x[i];
+            continue;
+        }
+        T const expected = har::abs(x[i]);
+        ok = ok && (a[i] == expected || (a[i] != a[i] && expected != expected));
+    }
+    return ok;
+}
+
+template<typename T>
+void    test_type   ()
+{
+    typedef boost::integral_constant<bool, boost::is_integral<T>::value> is_integral_type;
+    std::size_t const lengths[] = { 0, 1, 7, 31, 63, 64, 65, 127, 128, 1000 };
+    for(std::size_t k = 0; k < sizeof(lengths) / sizeof(lengths[0]); ++k) {
+        std::vector<T> const x = make_input<T>(lengths[k], is_integral_type());
+        T const * const first = x.empty() ? 0 : &x[0];
+        //one more word, to see that nothing is written past the end.
+        std::vector<boost::uint64_t> mask(har::bitmask_size(x.size()) + 1);
+        boost::uint64_t * const end = &mask[0] + har::bitmask_size(x.size());
+
+        BOOST_CHECK(har::negative_mask(first, first + x.size(), &mask[0]) == end);
+        BOOST_CHECK(equals_mask(x, mask, is_negative<T>));
+        BOOST_CHECK(check_selection(x, mask));
+        BOOST_CHECK(har::positive_mask(first, first + x.size(), &mask[0]) == end);
+        BOOST_CHECK(equals_mask(x, mask, is_positive<T>));
+        BOOST_CHECK(har::count_positive(first, first + x.size()) == har::count_bits(&mask[0], end));
+        BOOST_CHECK(check_sign_abs(x));
+    }
+}
+
+template<typename T>
+void    test_integral   ()
+{
+    test_type<T>();
+    std::size_t const lengths[] = { 0, 1, 63, 64, 65, 1000, 5000 };
+    for(std::size_t k = 0; k < sizeof(lengths) / sizeof(lengths[0]); ++k) {
+        std::vector<T> const x = make_input<T>(lengths[k], boost::true_type());
+        T const * const first = x.empty() ? 0 : &x[0];
+        std::vector<boost::uint64_t> mask(har::bitmask_size(x.size()) + 1);
+        boost::uint64_t * const end = &mask[0] + har::bitmask_size(x.size());
+
+        BOOST_CHECK(har::odd_mask(first, first + x.size(), &mask[0]) == end);
+        BOOST_CHECK(equals_mask(x, mask, is_odd<T>));
+        BOOST_CHECK(har::count_odd(first, first + x.size()) == har::count_bits(&mask[0], end));
+        BOOST_CHECK(har::even_mask(first, first + x.size(), &mask[0]) == end);
+        BOOST_CHECK(equals_mask(x, mask, is_even<T>));
+        BOOST_CHECK(har::count_even(first, first + x.size()) == har::count_bits(&mask[0], end));
+    }
+}
+
+void    test_all_types  ()
+{
+    test_integral<boost::int8_t>();
+    test_integral<boost::int16_t>();
+    test_integral<boost::int32_t>();
+    test_integral<boost::int64_t>();
+    test_integral<boost::uint8_t>();
+    test_integral<boost::uint16_t>();
+    test_integral<boost::uint32_t>();
+    test_integral<boost::uint64_t>();
+    test_type<float>();
+    test_type<double>();
+    test_type<long double>();
+}
+
+}   //namespace
+
+int test_main(int, char**)
+{
+    har::simd_level const levels[] = { har::simd_none, har::simd_sse41, har::simd_avx2 };
+    for(std::size_t i = 0; i < sizeof(levels)/sizeof(levels[0]); ++i) {
+        if(levels[i] > har::detected_simd_level()) { break; }
+        har::limit_simd_level(levels[i]);
+        BOOST_CHECK(har::current_simd_level() == levels[i]);
+        test_all_types();
+    }
+    har::limit_simd_level(har::simd_avx2);
+
+    {
+        int const           in[] = { 3, -1, 0, -7, 8, -2, 5 };
+        boost::uint64_t     mask[1];
+        int                 out[7];
+        har::negative_mask(in, in + 7, mask);
+        BOOST_CHECK(mask[0] == 0x2A);
+        BOOST_CHECK(har::select(in, in + 7, mask, out) == out + 3);
+        BOOST_CHECK(out[0] == -1 && out[1] == -7 && out[2] == -2);
+        har::odd_mask(in, in + 7, mask);
+        BOOST_CHECK(mask[0] == 0x4B);
+        BOOST_CHECK(har::count_even(in, in + 7) == 3);
+    }
+
+    return 0;
+}
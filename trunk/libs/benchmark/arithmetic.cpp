@@ -0,0 +1,281 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+//! the functions of arithmetic.hpp and their bulk forms, compared with
+//! the built-in operators and the C library.
+//! each integer width, float and double, with random and sorted inputs.
+//! the names are "function/type/order/form", e.g. "mod_floored/int32/random/scalar".
+//! run with --format=csv or --format=json to keep the results. (see benchmark.hpp)
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+#include "../../hwm/arithmetic.hpp"
+#include "../../hwm/arithmetic/batch.hpp"
+#include "./benchmark.hpp"
+
+namespace har = hwm::arithmetic;
+
+namespace {
+
+std::size_t const element_count = 1 << 14;
+
+template<typename T> char const *   type_name   ();
+template<> char const * type_name<boost::int8_t>    () { return "int8"; }
+template<> char const * type_name<boost::int16_t>   () { return "int16"; }
+template<> char const * type_name<boost::int32_t>   () { return "int32"; }
+template<> char const * type_name<boost::int64_t>   () { return "int64"; }
+template<> char const * type_name<boost::uint8_t>   () { return "uint8"; }
+template<> char const * type_name<boost::uint16_t>  () { return "uint16"; }
+template<> char const * type_name<boost::uint32_t>  () { return "uint32"; }
+template<> char const * type_name<boost::uint64_t>  () { return "uint64"; }
+template<> char const * type_name<float>            () { return "float"; }
+template<> char const * type_name<double>           () { return "double"; }
+
+//! values in [-10^6, 10^6] clamped to the range of T.
+//! the minimum of a signed type is excluded, so that abs and negation do not overflow.
+template<typename T>
+std::vector<T>  make_integral   (bool sorted, unsigned int seed)
+{
+    boost::intmax_t const lo = (std::max)(
+        static_cast<boost::intmax_t>((std::numeric_limits<T>::min)()) + (std::numeric_limits<T>::is_signed ? 1 : 0),
+        static_cast<boost::intmax_t>(std::numeric_limits<T>::is_signed ? -1000000 : 0) );
+    boost::intmax_t const hi = (std::min)(
+        static_cast<boost::uintmax_t>((std::numeric_limits<T>::max)()), static_cast<boost::uintmax_t>(1000000) );
+
+    boost::random::mt19937 gen(seed);
+    boost::random::uniform_int_distribution<boost::intmax_t> dist(lo, hi);
+    std::vector<T> v(element_count);
+    for(std::size_t i = 0; i < v.size(); ++i) { v[i] = static_cast<T>(dist(gen)); }
+    if(sorted) { std::sort(v.begin(), v.end()); }
+    return v;
+}
+
+template<typename T>
+std::vector<T>  make_floating   (bool sorted, unsigned int seed)
+{
+    boost::random::mt19937 gen(seed);
+    boost::random::uniform_real_distribution<double> dist(-1000000.0, 1000000.0);
+    std::vector<T> v(element_count);
+    for(std::size_t i = 0; i < v.size(); ++i) { v[i] = static_cast<T>(dist(gen)); }
+    if(sorted) { std::sort(v.begin(), v.end()); }
+    return v;
+}
+
+//! bool results are stored as char, to avoid std::vector<bool>.
+template<typename T>
+struct storage
+{
+    typedef typename std::conditional<std::is_same<T, bool>::value, char, T>::type type;
+};
+
+template<typename T, typename F>
+void    scalar_unary    (std::string const &name, std::vector<T> const &in, F f)
+{
+    typedef typename storage<decltype(f(in[0]))>::type U;
+    std::vector<U> out(in.size());
+    bench::run(name + "/scalar", [&] {
+        for(std::size_t i = 0; i < in.size(); ++i) { out[i] = f(in[i]); }
+        bench::do_not_optimize(out[0]);
+    }, in.size());
+}
+
+template<typename T, typename F>
+void    scalar_binary   (std::string const &name, std::vector<T> const &x, std::vector<T> const &y, F f)
+{
+    typedef typename storage<decltype(f(x[0], y[0]))>::type U;
+    std::vector<U> out(x.size());
+    bench::run(name + "/scalar", [&] {
+        for(std::size_t i = 0; i < x.size(); ++i) { out[i] = f(x[i], y[i]); }
+        bench::do_not_optimize(out[0]);
+    }, x.size());
+}
+
+//! `f(first, last, out)' applied to the whole input.
+template<typename T, typename U, typename F>
+void    bulk    (std::string const &name, std::vector<T> const &in, F f)
+{
+    std::vector<U> out(in.size());
+    bench::run(name + "/bulk", [&] {
+        f(&in[0], &in[0] + in.size(), &out[0]);
+        bench::do_not_optimize(out[0]);
+    }, in.size());
+}
+
+template<typename T>
+void    bulk_binary (std::string const &name, std::vector<T> const &x, std::vector<T> const &y,
+                     T * (*f)(T const *, T const *, T const *, T *) )
+{
+    std::vector<T> out(x.size());
+    bench::run(name + "/bulk", [&] {
+        f(&x[0], &x[0] + x.size(), &y[0], &out[0]);
+        bench::do_not_optimize(out[0]);
+    }, x.size());
+}
+
+//! std::div has overloads for int, long and long long.
+template<typename T>
+void    bench_std_div   (std::string const &suffix, std::vector<T> const &in, T const d,
+                         typename std::enable_if<std::is_signed<T>::value && (sizeof(T) >= sizeof(int))>::type* = 0)
+{
+    scalar_unary("std_div_rem" + suffix, in, [d](T x) { return std::div(x, d).rem; });
+}
+
+template<typename T>
+void    bench_std_div   (std::string const &, std::vector<T> const &, T const,
+                         typename std::enable_if<!(std::is_signed<T>::value && (sizeof(T) >= sizeof(int)))>::type* = 0)
+{}
+
+//! std::abs has overloads for int, long and long long.
+template<typename T>
+void    bench_std_abs   (std::string const &suffix, std::vector<T> const &in,
+                         typename std::enable_if<std::is_signed<T>::value && (sizeof(T) >= sizeof(int))>::type* = 0)
+{
+    scalar_unary("std_abs" + suffix, in, [](T x) { return static_cast<T>(std::abs(x)); });
+}
+
+template<typename T>
+void    bench_std_abs   (std::string const &, std::vector<T> const &,
+                         typename std::enable_if<!(std::is_signed<T>::value && (sizeof(T) >= sizeof(int)))>::type* = 0)
+{}
+
+template<typename T>
+void    bench_integral  (bool sorted)
+{
+    std::string const suffix = std::string("/") + type_name<T>() + (sorted ? "/sorted" : "/random");
+    std::vector<T> const x = make_integral<T>(sorted, 42);
+    std::vector<T> const y = make_integral<T>(false, 43);
+    T const d = bench::opaque(static_cast<T>(7));
+    har::divisor<T> const dd(d);
+
+    //division by a runtime divisor.
+    scalar_unary("operator_mod" + suffix,   x, [d](T v) { return static_cast<T>(v % d); });
+    scalar_unary("operator_div" + suffix,   x, [d](T v) { return static_cast<T>(v / d); });
+    bench_std_div(suffix, x, d);
+    scalar_unary("mod_truncated" + suffix,  x, [d](T v) { return har::mod_truncated(v, d); });
+    scalar_unary("mod_floored" + suffix,    x, [d](T v) { return har::mod_floored(v, d); });
+    scalar_unary("mod_euclidean" + suffix,  x, [d](T v) { return har::mod_euclidean(v, d); });
+    scalar_unary("div_truncated" + suffix,  x, [d](T v) { return har::div_truncated(v, d); });
+    scalar_unary("div_floored" + suffix,    x, [d](T v) { return har::div_floored(v, d); });
+    scalar_unary("div_euclidean" + suffix,  x, [d](T v) { return har::div_euclidean(v, d); });
+
+    //by a precomputed divisor, and by a compile-time constant.
+    scalar_unary("mod_floored(divisor)" + suffix,   x, [&dd](T v) { return har::mod_floored(v, dd); });
+    scalar_unary("div_floored(divisor)" + suffix,   x, [&dd](T v) { return har::div_floored(v, dd); });
+    scalar_unary("mod_floored<7>" + suffix,         x, [](T v) { return har::mod_floored<7>(v); });
+    scalar_unary("div_floored<7>" + suffix,         x, [](T v) { return har::div_floored<7>(v); });
+
+    bulk<T, T>("mod_truncated" + suffix,    x, [d](T const *f, T const *l, T *o) { har::mod_truncated(f, l, d, o); });
+    bulk<T, T>("mod_floored" + suffix,      x, [d](T const *f, T const *l, T *o) { har::mod_floored(f, l, d, o); });
+    bulk<T, T>("mod_euclidean" + suffix,    x, [d](T const *f, T const *l, T *o) { har::mod_euclidean(f, l, d, o); });
+    bulk<T, T>("div_truncated" + suffix,    x, [d](T const *f, T const *l, T *o) { har::div_truncated(f, l, d, o); });
+    bulk<T, T>("div_floored" + suffix,      x, [d](T const *f, T const *l, T *o) { har::div_floored(f, l, d, o); });
+    bulk<T, T>("div_euclidean" + suffix,    x, [d](T const *f, T const *l, T *o) { har::div_euclidean(f, l, d, o); });
+    bulk<T, T>("mod_floored(divisor)" + suffix, x, [&dd](T const *f, T const *l, T *o) { har::mod_floored(f, l, dd, o); });
+
+    //sign and parity.
+    scalar_unary("hand_sign" + suffix,      x, [](T v) { return static_cast<int>((v > 0) - (v < 0)); });
+    scalar_unary("sign" + suffix,           x, [](T v) { return har::sign(v); });
+    scalar_unary("odd" + suffix,            x, [](T v) { return har::odd(v); });
+    scalar_unary("even" + suffix,           x, [](T v) { return har::even(v); });
+    bench_std_abs(suffix, x);
+    scalar_unary("abs" + suffix,            x, [](T v) { return har::abs(v); });
+
+    //saturating and checked operations.
+    scalar_binary("operator_add" + suffix,  x, y, [](T a, T b) { return static_cast<T>(a + b); });
+    scalar_binary("add_sat" + suffix,       x, y, [](T a, T b) { return har::add_sat(a, b); });
+    scalar_binary("sub_sat" + suffix,       x, y, [](T a, T b) { return har::sub_sat(a, b); });
+    scalar_binary("mul_sat" + suffix,       x, y, [](T a, T b) { return har::mul_sat(a, b); });
+    scalar_unary("abs_sat" + suffix,        x, [](T v) { return har::abs_sat(v); });
+    scalar_unary("div_sat" + suffix,        x, [d](T v) { return har::div_sat(v, d); });
+    scalar_binary("checked_add" + suffix,   x, y, [](T a, T b) { T r = 0; har::checked_add(a, b, r); return r; });
+    scalar_binary("checked_mul" + suffix,   x, y, [](T a, T b) { T r = 0; har::checked_mul(a, b, r); return r; });
+
+    bulk_binary<T>("add_sat" + suffix, x, y, &har::add_sat<T>);
+    bulk_binary<T>("sub_sat" + suffix, x, y, &har::sub_sat<T>);
+    bulk_binary<T>("mul_sat" + suffix, x, y, &har::mul_sat<T>);
+    bulk<T, T>("abs_sat" + suffix, x, [](T const *f, T const *l, T *o) { har::abs_sat(f, l, o); });
+}
+
+template<typename T>
+void    bench_floating  (bool sorted)
+{
+    std::string const suffix = std::string("/") + type_name<T>() + (sorted ? "/sorted" : "/random");
+    std::vector<T> const x = make_floating<T>(sorted, 42);
+    T const d = bench::opaque(static_cast<T>(7.5));
+
+    //rounding.
+    scalar_unary("floor_plus_half" + suffix,        x, [](T v) { return static_cast<T>(std::floor(v + static_cast<T>(0.5))); });
+    scalar_unary("std_round" + suffix,              x, [](T v) { return static_cast<T>(std::round(v)); });
+    scalar_unary("std_nearbyint" + suffix,          x, [](T v) { return static_cast<T>(std::nearbyint(v)); });
+    scalar_unary("std_lrint" + suffix,              x, [](T v) { return std::lrint(v); });
+    scalar_unary("round_simple" + suffix,           x, [](T v) { return har::round_simple(v); });
+    scalar_unary("round_to_nearest_even" + suffix,  x, [](T v) { return har::round_to_nearest_even(v); });
+
+    bulk<T, T>("round_simple" + suffix,             x, [](T const *f, T const *l, T *o) { har::round_simple(f, l, o); });
+    bulk<T, T>("round_to_nearest_even" + suffix,    x, [](T const *f, T const *l, T *o) { har::round_to_nearest_even(f, l, o); });
+    bulk<T, boost::int32_t>("round_simple/to_int32" + suffix, x,
+        [](T const *f, T const *l, boost::int32_t *o) { har::round_simple(f, l, o); });
+    bulk<T, boost::int32_t>("round_to_nearest_even/to_int32" + suffix, x,
+        [](T const *f, T const *l, boost::int32_t *o) { har::round_to_nearest_even(f, l, o); });
+    bulk<T, boost::int64_t>("round_to_nearest_even/to_int64" + suffix, x,
+        [](T const *f, T const *l, boost::int64_t *o) { har::round_to_nearest_even(f, l, o); });
+
+    //modulus and division.
+    scalar_unary("std_fmod" + suffix,           x, [d](T v) { return static_cast<T>(std::fmod(v, d)); });
+    scalar_unary("fmod_truncated" + suffix,     x, [d](T v) { return static_cast<T>(har::fmod_truncated(v, d)); });
+    scalar_unary("fmod_floored" + suffix,       x, [d](T v) { return static_cast<T>(har::fmod_floored(v, d)); });
+    scalar_unary("fmod_euclidean" + suffix,     x, [d](T v) { return static_cast<T>(har::fmod_euclidean(v, d)); });
+    scalar_unary("fdiv_truncated" + suffix,     x, [d](T v) { return static_cast<T>(har::fdiv_truncated(v, d)); });
+    scalar_unary("fdiv_floored" + suffix,       x, [d](T v) { return static_cast<T>(har::fdiv_floored(v, d)); });
+    scalar_unary("fdiv_euclidean" + suffix,     x, [d](T v) { return static_cast<T>(har::fdiv_euclidean(v, d)); });
+
+    //sign.
+    scalar_unary("std_fabs" + suffix,   x, [](T v) { return static_cast<T>(std::fabs(v)); });
+    scalar_unary("abs" + suffix,        x, [](T v) { return har::abs(v); });
+    scalar_unary("sign" + suffix,       x, [](T v) { return har::sign(v); });
+}
+
+template<typename T>
+void    bench_integral_orders   ()
+{
+    bench_integral<T>(false);
+    bench_integral<T>(true);
+}
+
+template<typename T>
+void    bench_floating_orders   ()
+{
+    bench_floating<T>(false);
+    bench_floating<T>(true);
+}
+
+}   //namespace
+
+int main(int argc, char **argv)
+{
+    if(!bench::init(argc, argv)) { return 1; }
+
+    bench::print_header();
+    bench_integral_orders<boost::int8_t>();
+    bench_integral_orders<boost::int16_t>();
+    bench_integral_orders<boost::int32_t>();
+    bench_integral_orders<boost::int64_t>();
+    bench_integral_orders<boost::uint8_t>();
+    bench_integral_orders<boost::uint16_t>();
+    bench_integral_orders<boost::uint32_t>();
+    bench_integral_orders<boost::uint64_t>();
+    bench_floating_orders<float>();
+    bench_floating_orders<double>();
+    bench::print_footer();
+    return 0;
+}
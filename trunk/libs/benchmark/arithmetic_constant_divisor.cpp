@@ -0,0 +1,104 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+//! compares the division by a compile-time constant, e.g. mod_floored<8>(x),
+//! with the same function taking the divisor at runtime.
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include "../../hwm/arithmetic.hpp"
+#include "./benchmark.hpp"
+
+namespace har = hwm::arithmetic;
+
+namespace {
+
+std::size_t const element_count = 1 << 16;
+
+template<typename T>
+std::vector<T>  make_input  ()
+{
+    boost::random::mt19937 gen(42);
+    boost::random::uniform_int_distribution<T> dist(-1000000, 1000000);
+    std::vector<T> v(element_count);
+    for(std::size_t i = 0; i < v.size(); ++i) { v[i] = dist(gen); }
+    return v;
+}
+
+#define HWM_BENCH_CONSTANT_DIVISION(func)                                               \
+    template<boost::intmax_t N, typename T>                                             \
+    void    bench_ ## func  (std::vector<T> const &in, char const *type_name)           \
+    {                                                                                   \
+        std::string const name =                                                        \
+            std::string(#func) + "<" + std::to_string(N) + ">/" + type_name;            \
+        if(!bench::selected(name)) { return; }                                          \
+                                                                                        \
+        std::vector<T> out(in.size());                                                  \
+        T const d = bench::opaque(static_cast<T>(N));                                   \
+                                                                                        \
+        double const runtime = bench::measure([&] {                                     \
+            for(std::size_t i = 0; i < in.size(); ++i) { out[i] = har::func(in[i], d); }\
+            bench::do_not_optimize(out[0]);                                             \
+        }, in.size());                                                                  \
+        double const constant = bench::measure([&] {                                    \
+            for(std::size_t i = 0; i < in.size(); ++i) { out[i] = har::func<N>(in[i]); }\
+            bench::do_not_optimize(out[0]);                                             \
+        }, in.size());                                                                  \
+                                                                                        \
+        bench::print_result(name + "/runtime", runtime);                               \
+        bench::print_result(name + "/constant", constant);                             \
+        if(bench::options().format == bench::text_format) {                             \
+            std::printf("%-48s %12.2fx%s\n", "  speedup", runtime / constant,           \
+                (constant < runtime) ? "" : "  (constant form is not faster)");         \
+        }                                                                               \
+    }
+
+HWM_BENCH_CONSTANT_DIVISION(mod_truncated)
+HWM_BENCH_CONSTANT_DIVISION(mod_floored)
+HWM_BENCH_CONSTANT_DIVISION(mod_euclidean)
+HWM_BENCH_CONSTANT_DIVISION(div_truncated)
+HWM_BENCH_CONSTANT_DIVISION(div_floored)
+HWM_BENCH_CONSTANT_DIVISION(div_euclidean)
+
+#undef HWM_BENCH_CONSTANT_DIVISION
+
+template<boost::intmax_t N, typename T>
+void    bench_all   (std::vector<T> const &in, char const *type_name)
+{
+    bench_mod_truncated<N>(in, type_name);
+    bench_mod_floored<N>(in, type_name);
+    bench_mod_euclidean<N>(in, type_name);
+    bench_div_truncated<N>(in, type_name);
+    bench_div_floored<N>(in, type_name);
+    bench_div_euclidean<N>(in, type_name);
+}
+
+template<typename T>
+void    bench_type  (char const *type_name)
+{
+    std::vector<T> const in = make_input<T>();
+    bench_all<8>(in, type_name);
+    bench_all<64>(in, type_name);
+    bench_all<7>(in, type_name);
+    bench_all<1000>(in, type_name);
+    bench_all<-4>(in, type_name);
+}
+
+}   //namespace
+
+int main(int argc, char **argv)
+{
+    if(!bench::init(argc, argv)) { return 1; }
+
+    bench::print_header();
+    bench_type<boost::int32_t>("int32");
+    bench_type<boost::int64_t>("int64");
+    bench::print_footer();
+    return 0;
+}
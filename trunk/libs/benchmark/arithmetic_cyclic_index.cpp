@@ -0,0 +1,77 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+//! a wrap-around walk over a ring buffer by a stride,
+//! by mod_floored for each element, by a precomputed divisor, and by cyclic_index.
+
+#include <sstream>
+#include <vector>
+#include <boost/cstdint.hpp>
+#include "../../hwm/arithmetic/cyclic_index.hpp"
+#include "../../hwm/arithmetic/divisor.hpp"
+#include "./benchmark.hpp"
+
+namespace har = hwm::arithmetic;
+
+namespace {
+
+std::size_t const walk_length = 1 << 16;
+
+template<typename T>
+void    run_all (char const *type, T const n, T const step)
+{
+    std::vector<T> buffer(static_cast<std::size_t>(n < 0 ? -n : n));
+    for(std::size_t i = 0; i < buffer.size(); ++i) { buffer[i] = static_cast<T>(i); }
+    T const * const base = &buffer[0] + ((n < 0) ? buffer.size() - 1 : 0);
+    T const m = bench::opaque(n);
+    T const s = bench::opaque(step);
+
+    std::ostringstream prefix;
+    prefix << type << "/n=" << n << "/step=" << step << "/";
+
+    bench::run(prefix.str() + "mod_floored", [&] {
+        T sum = 0;
+        T i = 0;
+        for(std::size_t k = 0; k < walk_length; ++k, i = static_cast<T>(i + s)) {
+            sum = static_cast<T>(sum + base[har::mod_floored(i, m)]);
+        }
+        bench::do_not_optimize(sum);
+    }, walk_length);
+
+    har::divisor<T> const d(m);
+    bench::run(prefix.str() + "divisor", [&] {
+        T sum = 0;
+        T i = 0;
+        for(std::size_t k = 0; k < walk_length; ++k, i = static_cast<T>(i + s)) {
+            sum = static_cast<T>(sum + base[har::mod_floored(i, d)]);
+        }
+        bench::do_not_optimize(sum);
+    }, walk_length);
+
+    bench::run(prefix.str() + "cyclic_index", [&] {
+        T sum = 0;
+        har::cyclic_index<T> c(m, 0, s);
+        for(std::size_t k = 0; k < walk_length; ++k, ++c) {
+            sum = static_cast<T>(sum + base[c.value()]);
+        }
+        bench::do_not_optimize(sum);
+    }, walk_length);
+}
+
+}   //namespace
+
+int main(int argc, char **argv)
+{
+    if(!bench::init(argc, argv)) { return 1; }
+
+    bench::print_header();
+    run_all<boost::int32_t>("int32", 1000, 7);
+    run_all<boost::int32_t>("int32", 1000, -13);
+    run_all<boost::int32_t>("int32", -1000, 7);
+    run_all<boost::int64_t>("int64", 1000003, 4099);
+    run_all<boost::uint32_t>("uint32", 4096, 3);
+    bench::print_footer();
+    return 0;
+}
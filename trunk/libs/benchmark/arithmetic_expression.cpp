@@ -0,0 +1,81 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+//! a chain of arithmetic functions over an array:
+//!     staged  one bulk call per step, through temporary arrays.
+//!     fused   one pass by expression::evaluate.
+//!     scalar  one loop of the scalar functions.
+//! for an array that fits in the cache and for one that does not.
+
+#include <sstream>
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+#include "../../hwm/arithmetic/batch.hpp"
+#include "../../hwm/arithmetic/expression.hpp"
+#include "./benchmark.hpp"
+
+namespace har = hwm::arithmetic;
+namespace hae = har::expression;
+
+namespace {
+
+std::string     name_of (char const *form, std::size_t n)
+{
+    std::ostringstream ss;
+    ss << "mod_euclidean(round(x*s)+o,n)/" << form << "/n=" << n;
+    return ss.str();
+}
+
+void    run_all (std::size_t n)
+{
+    boost::random::mt19937 gen(42);
+    boost::random::uniform_real_distribution<float> dist(-1e6f, 1e6f);
+    std::vector<float> in(n);
+    for(std::size_t i = 0; i < n; ++i) { in[i] = dist(gen); }
+    std::vector<float> scaled(n);
+    std::vector<boost::int32_t> rounded(n), out(n);
+
+    float const scale = bench::opaque(0.37f);
+    boost::int32_t const offset = bench::opaque(12345);
+    har::divisor<boost::int32_t> const d(bench::opaque(360));
+
+    bench::run(name_of("staged", n), [&] {
+        for(std::size_t i = 0; i < n; ++i) { scaled[i] = in[i] * scale; }
+        har::round_to_nearest_even(&scaled[0], &scaled[0] + n, &rounded[0]);
+        for(std::size_t i = 0; i < n; ++i) { rounded[i] += offset; }
+        har::mod_euclidean(&rounded[0], &rounded[0] + n, d, &out[0]);
+        bench::do_not_optimize(out[0]);
+    }, n);
+
+    bench::run(name_of("fused", n), [&] {
+        hae::evaluate(&in[0], &in[0] + n,
+            hae::mod_euclidean(hae::cast<boost::int32_t>(hae::round_to_nearest_even(hae::element * scale)) + offset, d),
+            &out[0] );
+        bench::do_not_optimize(out[0]);
+    }, n);
+
+    bench::run(name_of("scalar", n), [&] {
+        for(std::size_t i = 0; i < n; ++i) {
+            boost::int32_t const r = static_cast<boost::int32_t>(har::round_to_nearest_even(in[i] * scale));
+            out[i] = har::mod_euclidean(static_cast<boost::int32_t>(r + offset), d);
+        }
+        bench::do_not_optimize(out[0]);
+    }, n);
+}
+
+}   //namespace
+
+int main(int argc, char **argv)
+{
+    if(!bench::init(argc, argv)) { return 1; }
+
+    bench::print_header();
+    run_all(4096);
+    run_all(1 << 24);
+    bench::print_footer();
+    return 0;
+}
@@ -0,0 +1,156 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+//! 128-bit division by the builtin operators (the library routines of the compiler),
+//! by hwm::arithmetic, and by a generic shift-subtract long division.
+
+#include <string>
+#include <vector>
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include "../../hwm/arithmetic.hpp"
+#include "./benchmark.hpp"
+
+namespace har = hwm::arithmetic;
+
+#if defined(BOOST_HAS_INT128)
+
+namespace {
+
+typedef boost::int128_type  int128;
+typedef boost::uint128_type uint128;
+
+std::size_t const array_size = 1 << 12;
+
+//! the fallback for a compiler without a wide division, one bit at a time.
+uint128 long_division   (uint128 const x, uint128 const y, uint128 &rem)
+{
+    uint128 q = 0;
+    uint128 r = 0;
+    for(int i = 127; i >= 0; --i) {
+        bool const carry = (r >> 127) != 0;
+        r = (r << 1) | ((x >> i) & 1);
+        q <<= 1;
+        if(carry || r >= y) {
+            r -= y;
+            q |= 1;
+        }
+    }
+    rem = r;
+    return q;
+}
+
+//! floored division on the long division of the magnitudes.
+int128  long_div_floored    (int128 const x, int128 const y)
+{
+    uint128 const xm = (x < 0) ? 0 - static_cast<uint128>(x) : static_cast<uint128>(x);
+    uint128 const ym = (y < 0) ? 0 - static_cast<uint128>(y) : static_cast<uint128>(y);
+    uint128 r;
+    int128 q = static_cast<int128>(long_division(xm, ym, r));
+    if((x < 0) != (y < 0)) {
+        q = -q;
+        if(r != 0) { q -= 1; }
+    }
+    return q;
+}
+
+//! floored division on the builtin operators.
+int128  builtin_div_floored (int128 const x, int128 const y)
+{
+    int128 const q = x / y;
+    int128 const r = x % y;
+    return (r != 0 && ((r < 0) != (y < 0))) ? q - 1 : q;
+}
+
+//! dividends of `dividend_bits' bits and divisors of `divisor_bits' bits, with random signs.
+void    make_operands   (int const dividend_bits, int const divisor_bits, std::vector<int128> &x, std::vector<int128> &y)
+{
+    boost::random::mt19937_64 gen(42);
+    x.resize(array_size);
+    y.resize(array_size);
+    for(std::size_t i = 0; i < array_size; ++i) {
+        uint128 const a = ((static_cast<uint128>(gen()) << 64) | gen()) >> (128 - dividend_bits);
+        uint128 const b = ((static_cast<uint128>(gen()) << 64) | gen()) >> (128 - divisor_bits);
+        x[i] = (gen() & 1) ? -static_cast<int128>(a) : static_cast<int128>(a);
+        y[i] = (gen() & 1) ? -static_cast<int128>(b | 1) : static_cast<int128>(b | 1);
+    }
+}
+
+void    run_all (std::string const &name, int const dividend_bits, int const divisor_bits)
+{
+    std::vector<int128> x, y;
+    make_operands(dividend_bits, divisor_bits, x, y);
+    std::vector<uint128> ux(x.begin(), x.end()), uy(y.size());
+    for(std::size_t i = 0; i < y.size(); ++i) { uy[i] = (y[i] < 0) ? 0 - static_cast<uint128>(y[i]) : static_cast<uint128>(y[i]); }
+
+    bench::run(name + "/uint128/builtin", [&] {
+        uint128 sum = 0;
+        uint128 const *p = bench::opaque(&ux[0]);
+        for(std::size_t i = 0; i < array_size; ++i) { sum += p[i] / uy[i]; }
+        bench::do_not_optimize(sum);
+    }, array_size);
+
+    bench::run(name + "/uint128/hwm", [&] {
+        uint128 sum = 0;
+        uint128 const *p = bench::opaque(&ux[0]);
+        for(std::size_t i = 0; i < array_size; ++i) { sum += har::div_truncated(p[i], uy[i]); }
+        bench::do_not_optimize(sum);
+    }, array_size);
+
+    bench::run(name + "/uint128/long_division", [&] {
+        uint128 sum = 0;
+        uint128 r;
+        uint128 const *p = bench::opaque(&ux[0]);
+        for(std::size_t i = 0; i < array_size; ++i) { sum += long_division(p[i], uy[i], r); }
+        bench::do_not_optimize(sum);
+    }, array_size);
+
+    bench::run(name + "/int128_floored/builtin", [&] {
+        int128 sum = 0;
+        int128 const *p = bench::opaque(&x[0]);
+        for(std::size_t i = 0; i < array_size; ++i) { sum += builtin_div_floored(p[i], y[i]); }
+        bench::do_not_optimize(sum);
+    }, array_size);
+
+    bench::run(name + "/int128_floored/hwm", [&] {
+        int128 sum = 0;
+        int128 const *p = bench::opaque(&x[0]);
+        for(std::size_t i = 0; i < array_size; ++i) { sum += har::div_floored(p[i], y[i]); }
+        bench::do_not_optimize(sum);
+    }, array_size);
+
+    bench::run(name + "/int128_floored/long_division", [&] {
+        int128 sum = 0;
+        int128 const *p = bench::opaque(&x[0]);
+        for(std::size_t i = 0; i < array_size; ++i) { sum += long_div_floored(p[i], y[i]); }
+        bench::do_not_optimize(sum);
+    }, array_size);
+}
+
+}   //namespace
+
+int main(int argc, char **argv)
+{
+    if(!bench::init(argc, argv)) { return 1; }
+
+    bench::print_header();
+    //e.g. nanoseconds divided into seconds. the upper half of the dividend is less than the divisor.
+    run_all("90by32", 90, 32);
+    //the quotient is wider than 64 bits.
+    run_all("127by40", 127, 40);
+    run_all("127by100", 127, 100);
+    bench::print_footer();
+    return 0;
+}
+
+#else
+
+int main()
+{
+    return 0;
+}
+
+#endif
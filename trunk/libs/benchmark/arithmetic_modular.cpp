@@ -0,0 +1,123 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+//! compares modular_context with mod_euclidean applied at every step.
+//! the multiply-accumulate loop is what a polynomial hash does.
+
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include "../../hwm/arithmetic/modular.hpp"
+#include "./benchmark.hpp"
+
+namespace har = hwm::arithmetic;
+
+namespace {
+
+std::size_t const element_count = 1 << 14;
+
+template<typename T>
+std::vector<T>  make_input  (T const lo, T const hi)
+{
+    boost::random::mt19937 gen(42);
+    boost::random::uniform_int_distribution<T> dist(lo, hi);
+    std::vector<T> v(element_count);
+    for(std::size_t i = 0; i < v.size(); ++i) { v[i] = dist(gen); }
+    return v;
+}
+
+//! 32-bit: the product is computed in 64 bits and reduced.
+void    bench_32    ()
+{
+    typedef boost::uint32_t T;
+    T const m = bench::opaque(static_cast<T>(4294967291u));   //the largest 32-bit prime
+    std::vector<T> const in = make_input<T>(0, m - 1);
+    har::modular_context<T> const ctx(m);
+
+    bench::run("hash/uint32/mod_euclidean", [&] {
+        boost::uint64_t h = 0;
+        for(std::size_t i = 0; i < in.size(); ++i) {
+            boost::uint64_t const p = har::mod_euclidean(h * 31, static_cast<boost::uint64_t>(m));
+            h = har::mod_euclidean(p + in[i], static_cast<boost::uint64_t>(m));
+        }
+        bench::do_not_optimize(h);
+    }, in.size());
+    bench::run("hash/uint32/modular_context", [&] {
+        T h = 0;
+        for(std::size_t i = 0; i < in.size(); ++i) {
+            h = ctx.add_mod(ctx.mul_mod(h, 31), in[i]);
+        }
+        bench::do_not_optimize(h);
+    }, in.size());
+}
+
+//! 64-bit: the product needs 128 bits.
+void    bench_64    (boost::uint64_t const modulus, char const *name)
+{
+    typedef boost::uint64_t T;
+    T const m = bench::opaque(modulus);
+    std::vector<T> const in = make_input<T>(0, m - 1);
+    har::modular_context<T> const ctx(m);
+
+    std::string const prefix = std::string(name);
+    bench::run(prefix + "/mul_mod/divq", [&] {
+        T h = 1;
+        for(std::size_t i = 0; i < in.size(); ++i) {
+            T rem;
+            har::detail::wide_multiply<8>::divide(
+                har::detail::mulhi(h, in[i]), static_cast<T>(h * in[i]), m, rem );
+            h = rem + 1;
+        }
+        bench::do_not_optimize(h);
+    }, in.size());
+    bench::run(prefix + "/mul_mod/modular_context", [&] {
+        T h = 1;
+        for(std::size_t i = 0; i < in.size(); ++i) {
+            h = ctx.mul_mod(h, in[i]) + 1;
+        }
+        bench::do_not_optimize(h);
+    }, in.size());
+    bench::run(prefix + "/pow_mod", [&] {
+        T h = 0;
+        for(std::size_t i = 0; i < 64; ++i) {
+            h ^= ctx.pow_mod(in[i], m - 2);
+        }
+        bench::do_not_optimize(h);
+    }, 64);
+}
+
+void    bench_reduce    ()
+{
+    typedef boost::int32_t T;
+    std::vector<T> const in = make_input<T>(-1000000000, 1000000000);
+    std::vector<T> out(in.size());
+    T const m = bench::opaque(static_cast<T>(1000003));
+    har::modular_context<T> const ctx(m);
+
+    bench::run("reduce/int32/mod_euclidean", [&] {
+        for(std::size_t i = 0; i < in.size(); ++i) { out[i] = har::mod_euclidean(in[i], m); }
+        bench::do_not_optimize(out[0]);
+    }, in.size());
+    bench::run("reduce/int32/modular_context", [&] {
+        ctx.reduce(&in[0], &in[0] + in.size(), &out[0]);
+        bench::do_not_optimize(out[0]);
+    }, in.size());
+}
+
+}   //namespace
+
+int main(int argc, char **argv)
+{
+    if(!bench::init(argc, argv)) { return 1; }
+
+    bench::print_header();
+    bench_32();
+    bench_64((static_cast<boost::uint64_t>(1) << 61) - 1, "uint64/odd");
+    bench_64(static_cast<boost::uint64_t>(1000000000000000000ull), "uint64/even");
+    bench_reduce();
+    bench::print_footer();
+    return 0;
+}
@@ -0,0 +1,72 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+//! throughput of the parallel bulk operations over arrays much larger than the cache,
+//! as the number of threads grows.
+//! link boost_thread and boost_system.
+
+#include <sstream>
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include "../../hwm/arithmetic/parallel.hpp"
+#include "./benchmark.hpp"
+
+namespace har = hwm::arithmetic;
+namespace hap = har::parallel;
+
+namespace {
+
+std::size_t const element_count = 1 << 24;
+
+std::string     name_of (char const *op, std::size_t threads)
+{
+    std::ostringstream ss;
+    ss << op << "/threads=" << threads;
+    return ss.str();
+}
+
+}   //namespace
+
+int main(int argc, char **argv)
+{
+    if(!bench::init(argc, argv)) { return 1; }
+
+    boost::random::mt19937 gen(42);
+    boost::random::uniform_int_distribution<boost::int32_t> dist(-1000000000, 1000000000);
+    std::vector<boost::int32_t> in(element_count);
+    for(std::size_t i = 0; i < in.size(); ++i) { in[i] = dist(gen); }
+    std::vector<boost::int32_t> out(in.size());
+    std::vector<double> din(in.begin(), in.end());
+    std::vector<double> dout(din.size());
+
+    boost::int32_t const m = bench::opaque(1000003);
+    har::divisor<boost::int32_t> const d(m);
+
+    std::size_t const hardware = hwm::thread_pool::default_thread_count();
+    std::size_t const max_threads = (hardware < 8) ? 8 : hardware;
+
+    bench::print_header();
+    bench::run("mod_floored/bulk", [&] {
+        har::mod_floored(&in[0], &in[0] + in.size(), d, &out[0]);
+        bench::do_not_optimize(out[0]);
+    }, in.size());
+
+    for(std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+        hwm::thread_pool pool(threads);
+        bench::run(name_of("mod_floored/parallel", threads), [&] {
+            hap::mod_floored(&in[0], &in[0] + in.size(), d, &out[0], pool);
+            bench::do_not_optimize(out[0]);
+        }, in.size());
+        bench::run(name_of("round_to_nearest_even/parallel", threads), [&] {
+            hap::round_to_nearest_even(&din[0], &din[0] + din.size(), &dout[0], pool);
+            bench::do_not_optimize(dout[0]);
+        }, din.size());
+    }
+
+    bench::print_footer();
+    return 0;
+}
@@ -0,0 +1,103 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+//! the selection and the count of the negative elements, and the bulk sign and abs,
+//! by a branch for each element and by the packed bitmasks.
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <boost/cstdint.hpp>
+#include "../../hwm/arithmetic/predicate.hpp"
+#include "./benchmark.hpp"
+
+namespace har = hwm::arithmetic;
+
+namespace {
+
+std::size_t const array_size = 1 << 14;
+
+//! the signs are random, so that the branches are not predictable.
+template<typename T>
+std::vector<T>  make_input  ()
+{
+    std::srand(42);
+    std::vector<T> v(array_size);
+    for(std::size_t i = 0; i < v.size(); ++i) {
+        v[i] = static_cast<T>(std::rand() % 201 - 100);
+    }
+    return v;
+}
+
+template<typename T>
+void    run_all (std::string const &type)
+{
+    std::vector<T> const x = make_input<T>();
+    T const * const first = &x[0];
+    T const * const last = first + x.size();
+    std::vector<T> selected(x.size());
+    std::vector<int> signs(x.size());
+    std::vector<T> magnitudes(x.size());
+    std::vector<boost::uint64_t> mask(har::bitmask_size(x.size()));
+
+    bench::run(type + "/select_negative/branch", [&] {
+        T *out = &selected[0];
+        for(T const *p = bench::opaque(first); p != last; ++p) {
+            if(har::sign(*p) < 0) { *out++ = *p; }
+        }
+        bench::do_not_optimize(out);
+    }, x.size());
+
+    bench::run(type + "/select_negative/bitmask", [&] {
+        har::negative_mask(bench::opaque(first), last, &mask[0]);
+        bench::do_not_optimize(har::select(first, last, &mask[0], &selected[0]));
+    }, x.size());
+
+    bench::run(type + "/count_negative/branch", [&] {
+        std::size_t count = 0;
+        for(T const *p = bench::opaque(first); p != last; ++p) {
+            if(har::sign(*p) < 0) { ++count; }
+        }
+        bench::do_not_optimize(count);
+    }, x.size());
+
+    bench::run(type + "/count_negative/bitmask", [&] {
+        bench::do_not_optimize(har::count_negative(bench::opaque(first), last));
+    }, x.size());
+
+    bench::run(type + "/sign/scalar", [&] {
+        T const *p = bench::opaque(first);
+        for(std::size_t i = 0; i < x.size(); ++i) { signs[i] = har::sign(p[i]); }
+        bench::do_not_optimize(signs[0]);
+    }, x.size());
+
+    bench::run(type + "/sign/bulk", [&] {
+        bench::do_not_optimize(har::sign(bench::opaque(first), last, &signs[0]));
+    }, x.size());
+
+    bench::run(type + "/abs/scalar", [&] {
+        T const *p = bench::opaque(first);
+        for(std::size_t i = 0; i < x.size(); ++i) { magnitudes[i] = har::abs(p[i]); }
+        bench::do_not_optimize(magnitudes[0]);
+    }, x.size());
+
+    bench::run(type + "/abs/bulk", [&] {
+        bench::do_not_optimize(har::abs(bench::opaque(first), last, &magnitudes[0]));
+    }, x.size());
+}
+
+}   //namespace
+
+int main(int argc, char **argv)
+{
+    if(!bench::init(argc, argv)) { return 1; }
+
+    bench::print_header();
+    run_all<boost::int8_t>("int8");
+    run_all<boost::int32_t>("int32");
+    run_all<float>("float");
+    bench::print_footer();
+    return 0;
+}
@@ -0,0 +1,81 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+//! mixing 16-bit samples with clamping written by hand, compared with
+//! the scalar add_sat and the bulk add_sat / mul_sat.
+
+#include <algorithm>
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include "../../hwm/arithmetic/batch.hpp"
+#include "./benchmark.hpp"
+
+namespace har = hwm::arithmetic;
+
+namespace {
+
+std::size_t const element_count = 1 << 14;
+
+std::vector<boost::int16_t> make_input  (unsigned int seed)
+{
+    boost::random::mt19937 gen(seed);
+    boost::random::uniform_int_distribution<boost::int16_t> dist(-32768, 32767);
+    std::vector<boost::int16_t> v(element_count);
+    for(std::size_t i = 0; i < v.size(); ++i) { v[i] = dist(gen); }
+    return v;
+}
+
+}   //namespace
+
+int main(int argc, char **argv)
+{
+    if(!bench::init(argc, argv)) { return 1; }
+
+    std::vector<boost::int16_t> const a = make_input(42);
+    std::vector<boost::int16_t> const b = make_input(43);
+    std::vector<boost::int16_t> out(a.size());
+
+    bench::print_header();
+    bench::run("add/int16/clamp", [&] {
+        for(std::size_t i = 0; i < a.size(); ++i) {
+            int const s = a[i] + b[i];
+            out[i] = static_cast<boost::int16_t>((std::min)((std::max)(s, -32768), 32767));
+        }
+        bench::do_not_optimize(out[0]);
+    }, a.size());
+    bench::run("add/int16/add_sat", [&] {
+        for(std::size_t i = 0; i < a.size(); ++i) { out[i] = har::add_sat(a[i], b[i]); }
+        bench::do_not_optimize(out[0]);
+    }, a.size());
+    bench::run("add/int16/bulk", [&] {
+        har::add_sat(&a[0], &a[0] + a.size(), &b[0], &out[0]);
+        bench::do_not_optimize(out[0]);
+    }, a.size());
+
+    bench::run("mul/int16/mul_sat", [&] {
+        for(std::size_t i = 0; i < a.size(); ++i) { out[i] = har::mul_sat(a[i], b[i]); }
+        bench::do_not_optimize(out[0]);
+    }, a.size());
+    bench::run("mul/int16/bulk", [&] {
+        har::mul_sat(&a[0], &a[0] + a.size(), &b[0], &out[0]);
+        bench::do_not_optimize(out[0]);
+    }, a.size());
+
+    std::vector<boost::int32_t> const c(a.begin(), a.end());
+    std::vector<boost::int32_t> c_out(c.size());
+    bench::run("abs/int32/abs_sat", [&] {
+        for(std::size_t i = 0; i < c.size(); ++i) { c_out[i] = har::abs_sat(c[i]); }
+        bench::do_not_optimize(c_out[0]);
+    }, c.size());
+    bench::run("abs/int32/bulk", [&] {
+        har::abs_sat(&c[0], &c[0] + c.size(), &c_out[0]);
+        bench::do_not_optimize(c_out[0]);
+    }, c.size());
+
+    bench::print_footer();
+    return 0;
+}
@@ -0,0 +1,173 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef HWM_LIBS_BENCHMARK_HPP
+#define HWM_LIBS_BENCHMARK_HPP
+
+//! small helpers shared by the benchmarks.
+//! the benchmarks need C++11.
+//! the results are written to stdout as a text table, CSV or JSON.
+//! each benchmark accepts these options. (see init)
+//!     --format=text|csv|json
+//!     --filter=substring      run only the benchmarks whose names contain substring.
+//!     --min-time=seconds      measure each benchmark for at least this long. (default: 0.2)
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace bench {
+
+enum output_format
+{
+    text_format,
+    csv_format,
+    json_format
+};
+
+struct options_type
+{
+    options_type() : format(text_format), min_seconds(0.2), result_count(0) {}
+
+    output_format   format;
+    std::string     filter;
+    double          min_seconds;
+    std::size_t     result_count;
+};
+
+inline options_type &options()
+{
+    static options_type o;
+    return o;
+}
+
+//! read the options from the command line. returns false on an unknown option.
+inline bool init(int argc, char **argv)
+{
+    options_type &o = options();
+    for(int i = 1; i < argc; ++i) {
+        char const *arg = argv[i];
+        if(std::strcmp(arg, "--format=text") == 0)          { o.format = text_format; }
+        else if(std::strcmp(arg, "--format=csv") == 0)      { o.format = csv_format; }
+        else if(std::strcmp(arg, "--format=json") == 0)     { o.format = json_format; }
+        else if(std::strncmp(arg, "--filter=", 9) == 0)     { o.filter = arg + 9; }
+        else if(std::strncmp(arg, "--min-time=", 11) == 0)  { o.min_seconds = std::atof(arg + 11); }
+        else {
+            std::fprintf(stderr,
+                "unknown option: %s\n"
+                "usage: %s [--format=text|csv|json] [--filter=substring] [--min-time=seconds]\n",
+                arg, argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+//! whether the benchmark of the name is selected by --filter.
+inline bool selected(std::string const &name)
+{
+    return name.find(options().filter) != std::string::npos;
+}
+
+//! keep the compiler from optimizing away a value.
+template<typename T>
+inline void do_not_optimize(T const &value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile char sink;
+    sink = *reinterpret_cast<char const volatile *>(&value);
+#endif
+}
+
+//! hide a value from the optimizer, so that it is treated as a runtime value.
+template<typename T>
+inline T    opaque(T value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : "+r"(value));
+#else
+    static volatile T holder;
+    holder = value;
+    value = holder;
+#endif
+    return value;
+}
+
+//! run `f' repeatedly for at least `min_seconds', and return nanoseconds per operation.
+//! `f' performs `ops_per_call' operations each time it is called.
+template<typename F>
+double  measure (F f, std::size_t ops_per_call, double min_seconds = options().min_seconds)
+{
+    typedef std::chrono::steady_clock clock;
+
+    f();    //warm up
+
+    std::size_t calls = 0;
+    clock::time_point const start = clock::now();
+    clock::duration elapsed;
+    do {
+        f();
+        ++calls;
+        elapsed = clock::now() - start;
+    } while(elapsed < std::chrono::duration<double>(min_seconds));
+
+    double const ns = std::chrono::duration<double, std::nano>(elapsed).count();
+    return ns / (static_cast<double>(calls) * static_cast<double>(ops_per_call));
+}
+
+inline void print_header()
+{
+    switch(options().format) {
+    case text_format:   std::printf("%-48s %12s %16s\n", "benchmark", "ns/op", "elements/s"); break;
+    case csv_format:    std::printf("benchmark,ns_per_op,elements_per_second\n"); break;
+    case json_format:   std::printf("[\n"); break;
+    }
+}
+
+//! the names must not contain quotes, commas or backslashes, so that they need no escaping.
+inline void print_result(std::string const &name, double ns_per_op)
+{
+    double const per_second = 1e9 / ns_per_op;
+    switch(options().format) {
+    case text_format:
+        std::printf("%-48s %12.3f %16.4g\n", name.c_str(), ns_per_op, per_second);
+        break;
+    case csv_format:
+        std::printf("%s,%.6g,%.6g\n", name.c_str(), ns_per_op, per_second);
+        break;
+    case json_format:
+        std::printf("%s  {\"benchmark\": \"%s\", \"ns_per_op\": %.6g, \"elements_per_second\": %.6g}",
+            options().result_count == 0 ? "" : ",\n", name.c_str(), ns_per_op, per_second);
+        break;
+    }
+    ++options().result_count;
+    std::fflush(stdout);
+}
+
+//! close the output. needed to make the JSON output complete.
+inline void print_footer()
+{
+    if(options().format == json_format) {
+        std::printf("%s]\n", options().result_count == 0 ? "" : "\n");
+    }
+}
+
+//! measure and print `f' if it is selected by --filter.
+template<typename F>
+void    run (std::string const &name, F f, std::size_t ops_per_call)
+{
+    if(selected(name)) {
+        print_result(name, measure(f, ops_per_call));
+    }
+}
+
+}   //namespace bench
+
+#endif  //HWM_LIBS_BENCHMARK_HPP
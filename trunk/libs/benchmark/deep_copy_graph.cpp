@@ -0,0 +1,126 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+//! cloning graphs of deep_copy_ptrs sharing their pointees with deep_copy_policy::cow,
+//! by deep_copy_ptr(rhs, r), which clones every path, and by deep_copy_graph_context.
+//! a chain of 17 diamonds, which has 2^17 paths, and 2^20 leaves shared by two parents,
+//! against a tree of the same size, which shares nothing.
+//! link boost_thread and boost_system.
+
+#include <vector>
+#include "../../hwm/deep_copy_graph.hpp"
+#include "./benchmark.hpp"
+
+namespace {
+
+int const chain_depth = 16;
+std::size_t const leaf_count = 1 << 20;
+
+struct node
+{
+    typedef hwm::deep_copy_ptr<node, hwm::deep_copy_policy::cow> ptr;
+
+    explicit node   (int v) : value(v) {}
+    node            (node const &rhs) : value(rhs.value), children(rhs.children) {}
+    node            (node const &rhs, hwm::deep_copy_memory_resource *r)
+        :   value(rhs.value)
+        ,   children(rhs.children.size())
+    {
+        for(std::size_t i = 0; i < rhs.children.size(); ++i) {
+            hwm::graph_clone(rhs.children[i], r).swap(children[i]);
+        }
+    }
+
+    int                 value;
+    std::vector<ptr>    children;
+};
+
+typedef node::ptr ptr;
+
+}   //namespace
+
+namespace hwm {
+template<>
+struct deep_copy_uses_resource<node> : boost::true_type {};
+}   //namespace hwm
+
+namespace {
+
+ptr     make_chain  (int depth)
+{
+    ptr p(new node(depth));
+    if(depth > 0) {
+        ptr const next(make_chain(depth - 1));
+        p->children.push_back(next);
+        p->children.push_back(next);
+    }
+    return p;
+}
+
+//! a root of two parents, which have the same leaves if `shared', or the leaves of their own.
+ptr     make_wide   (bool shared)
+{
+    ptr root(new node(0));
+    ptr left(new node(1));
+    ptr right(new node(2));
+    for(std::size_t i = 0; i < leaf_count; ++i) {
+        ptr const leaf(new node(static_cast<int>(i)));
+        left->children.push_back(leaf);
+        right->children.push_back(shared ? leaf : ptr(new node(static_cast<int>(i))));
+    }
+    root->children.push_back(left);
+    root->children.push_back(right);
+    return root;
+}
+
+}   //namespace
+
+int main(int argc, char **argv)
+{
+    if(!bench::init(argc, argv)) { return 1; }
+
+    hwm::deep_copy_memory_resource * const global_new = hwm::detail::deep_copy_new_delete_resource::instance();
+    ptr const chain(make_chain(chain_depth));
+    ptr const shared(make_wide(true));
+    ptr const unshared(make_wide(false));
+
+    bench::print_header();
+    bench::run("chain/every_path", [&] {
+        ptr const copy(chain, global_new);
+        bench::do_not_optimize(copy->value);
+    }, 1);
+
+    bench::run("chain/graph_context", [&] {
+        hwm::deep_copy_graph_context ctx;
+        ptr const copy(ctx.clone(chain));
+        bench::do_not_optimize(copy->value);
+    }, 1);
+
+    //per leaf. the tree clones twice as many leaves, without the lookup.
+    bench::run("wide/tree/every_path", [&] {
+        ptr const copy(unshared, global_new);
+        bench::do_not_optimize(copy->value);
+    }, leaf_count);
+
+    bench::run("wide/shared/every_path", [&] {
+        ptr const copy(shared, global_new);
+        bench::do_not_optimize(copy->value);
+    }, leaf_count);
+
+    bench::run("wide/shared/graph_context", [&] {
+        hwm::deep_copy_graph_context ctx;
+        ptr const copy(ctx.clone(shared));
+        bench::do_not_optimize(copy->value);
+    }, leaf_count);
+
+    bench::run("wide/shared/graph_context/reserved", [&] {
+        hwm::deep_copy_graph_context ctx;
+        ctx.reserve(leaf_count);
+        ptr const copy(ctx.clone(shared));
+        bench::do_not_optimize(copy->value);
+    }, leaf_count);
+    bench::print_footer();
+    return 0;
+}
@@ -0,0 +1,155 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+//! cloning a vector of 262144 deep_copy_ptrs and a tree of 37449 nodes,
+//! by the copy constructor, and by parallel_clone with the global new and with a pool for each thread.
+//! requires C++17 for std::pmr. link boost_thread and boost_system.
+
+#define HWM_DEEP_COPY_PTR_STD_PMR
+
+#include <memory>
+#include <memory_resource>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../../hwm/deep_copy_parallel.hpp"
+#include "./benchmark.hpp"
+
+namespace {
+
+std::size_t const element_count = 262144;
+int const fan_out = 8;
+int const depth = 5;    //1 + 8 + ... + 32768 nodes.
+
+struct shape
+{
+    virtual ~shape() {}
+    virtual double  area    () const = 0;
+};
+
+struct polygon
+    :   shape
+{
+    explicit polygon(double s) : sides_(4, s) {}
+    double  area    () const { return sides_[0] * sides_[1]; }
+
+    std::vector<double> sides_;
+};
+
+struct node
+{
+    explicit node   (int v) : value(v) {}
+    node            (node const &rhs) : value(rhs.value), children(rhs.children) {}
+    node            (node const &rhs, hwm::deep_copy_memory_resource *r)
+        :   value(rhs.value)
+        ,   children(rhs.children.size())
+    {
+        hwm::parallel_clone(rhs.children.begin(), rhs.children.end(), children.begin(), r);
+    }
+
+    int                                     value;
+    std::vector<hwm::deep_copy_ptr<node> >  children;
+};
+
+}   //namespace
+
+namespace hwm {
+template<>
+struct deep_copy_uses_resource<node> : boost::true_type {};
+}   //namespace hwm
+
+namespace {
+
+typedef hwm::deep_copy_ptr<shape>   element;
+
+hwm::deep_copy_ptr<node>    make_tree   (int level)
+{
+    hwm::deep_copy_ptr<node> t(new node(level));
+    if(level < depth) {
+        for(int i = 0; i < fan_out; ++i) { t->children.push_back(make_tree(level + 1)); }
+    }
+    return t;
+}
+
+std::string     name_of (char const *name, char const *resource, std::size_t threads)
+{
+    std::ostringstream ss;
+    ss << name << "/" << resource << "/threads=" << threads;
+    return ss.str();
+}
+
+//! a pool for each thread of `pool', kept across the runs as a long running snapshot path would.
+struct thread_resources
+{
+    explicit thread_resources   (std::size_t threads)
+    {
+        for(std::size_t i = 0; i < threads; ++i) {
+            pools.push_back(std::make_unique<std::pmr::unsynchronized_pool_resource>());
+            ptrs.push_back(pools.back().get());
+        }
+    }
+
+    std::vector<std::unique_ptr<std::pmr::unsynchronized_pool_resource> >   pools;
+    std::vector<hwm::deep_copy_memory_resource *>                           ptrs;
+};
+
+void    run_threads (std::vector<element> const &src, hwm::deep_copy_ptr<node> const &root, std::size_t threads)
+{
+    hwm::thread_pool pool(threads);
+    thread_resources resources(threads);
+    hwm::deep_copy_parallel_context global(pool);
+    hwm::deep_copy_parallel_context local(pool, &resources.ptrs[0]);
+
+    hwm::deep_copy_parallel_context *contexts[] = { &global, &local };
+    char const *names[] = { "global_new", "thread_pool" };
+    for(int c = 0; c < 2; ++c) {
+        hwm::deep_copy_parallel_context &ctx = *contexts[c];
+        bench::run(name_of("vector/parallel_clone", names[c], threads), [&] {
+            std::vector<element> copy(src.size());
+            hwm::parallel_clone(ctx, src.begin(), src.end(), copy.begin());
+            bench::do_not_optimize(copy.back()->area());
+        }, src.size());
+
+        bench::run(name_of("tree/parallel_clone", names[c], threads), [&] {
+            hwm::deep_copy_ptr<node> copy;
+            hwm::parallel_clone(ctx, &root, &root + 1, &copy);
+            bench::do_not_optimize(copy->value);
+        }, 1);
+    }
+}
+
+}   //namespace
+
+int main(int argc, char **argv)
+{
+    if(!bench::init(argc, argv)) { return 1; }
+
+    std::vector<element> src;
+    src.reserve(element_count);
+    for(std::size_t i = 0; i < element_count; ++i) {
+        src.push_back(hwm::make_deep_copy<shape, polygon>(static_cast<double>((i * 7919) % 1000)));
+    }
+    hwm::deep_copy_ptr<node> const root(make_tree(0));
+
+    std::size_t const hardware = hwm::thread_pool::default_thread_count();
+    std::size_t const max_threads = (hardware < 8) ? 8 : hardware;
+
+    bench::print_header();
+    bench::run("vector/copy_constructor", [&] {
+        std::vector<element> copy(src);
+        bench::do_not_optimize(copy.back()->area());
+    }, src.size());
+
+    bench::run("tree/copy_constructor", [&] {
+        hwm::deep_copy_ptr<node> copy(root);
+        bench::do_not_optimize(copy->value);
+    }, 1);
+
+    for(std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+        run_threads(src, root, threads);
+    }
+    bench::print_footer();
+    return 0;
+}
@@ -0,0 +1,200 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+//! growing and sorting a vector of deep_copy_ptr,
+//! with the move operations, and with the copies only as before they were added.
+//! and constructing, copying and traversing a vector of deep_copy_ptr,
+//! made from new (two allocations) and by make_deep_copy (one allocation).
+//! and dereferencing the pointees without a virtual call, in a loop which reads them by the member.
+//! and passing a large tree by value through the layers, which only read it,
+//! cloned on every copy and shared by copy-on-write.
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+#include "../../hwm/deep_copy_ptr.hpp"
+#include "./benchmark.hpp"
+
+namespace {
+
+std::size_t const element_count = 1000000;
+
+struct shape
+{
+    virtual ~shape() {}
+    virtual double  area    () const = 0;
+};
+
+struct rectangle
+    :   shape
+{
+    rectangle(double w, double h) : w_(w), h_(h) {}
+    double  area    () const { return w_ * h_; }
+
+    double  w_, h_;
+};
+
+//! deep_copy_ptr without the move operations.
+//! the user-declared copy operations suppress the implicit moves, so the containers clone it.
+struct copy_only
+{
+    template<typename Y>
+    explicit copy_only  (Y *p) : ptr(p) {}
+    copy_only           (copy_only const &rhs) : ptr(rhs.ptr) {}
+    copy_only & operator=(copy_only const &rhs) { ptr = rhs.ptr; return *this; }
+
+    hwm::deep_copy_ptr<shape>   ptr;
+};
+
+typedef hwm::deep_copy_ptr<shape>   movable;
+
+shape const &   pointee (copy_only const &x)    { return *x.ptr; }
+shape const &   pointee (movable const &x)      { return *x; }
+
+template<typename E>
+E       make_element    (std::size_t i)
+{
+    return E(new rectangle(static_cast<double>((i * 7919) % 1000), 1.0));
+}
+
+template<typename E>
+void    run_all (std::string const &name)
+{
+    bench::run("push_back/" + name, [&] {
+        std::vector<E> v;
+        for(std::size_t i = 0; i < element_count; ++i) { v.push_back(make_element<E>(i)); }
+        bench::do_not_optimize(v.back());
+    }, element_count);
+
+    std::vector<E> v;
+    v.reserve(element_count);
+    for(std::size_t i = 0; i < element_count; ++i) { v.push_back(make_element<E>(i)); }
+    std::mt19937 gen(42);
+    bench::run("shuffle+sort/" + name, [&] {
+        std::shuffle(v.begin(), v.end(), gen);
+        std::sort(v.begin(), v.end(), [](E const &x, E const &y) { return pointee(x).area() < pointee(y).area(); });
+        bench::do_not_optimize(v.front());
+    }, element_count);
+}
+
+void    run_allocation  ()
+{
+    std::vector<movable> from_new, from_make;
+    bench::run("construct/new", [&] {
+        from_new.clear();
+        from_new.reserve(element_count);
+        for(std::size_t i = 0; i < element_count; ++i) { from_new.push_back(make_element<movable>(i)); }
+        bench::do_not_optimize(from_new.back());
+    }, element_count);
+
+    bench::run("construct/make_deep_copy", [&] {
+        from_make.clear();
+        from_make.reserve(element_count);
+        for(std::size_t i = 0; i < element_count; ++i) {
+            from_make.push_back(hwm::make_deep_copy<shape, rectangle>(static_cast<double>((i * 7919) % 1000), 1.0));
+        }
+        bench::do_not_optimize(from_make.back());
+    }, element_count);
+
+    bench::run("copy/new", [&] {
+        std::vector<movable> v(from_new);
+        bench::do_not_optimize(v.back());
+    }, element_count);
+
+    bench::run("copy/make_deep_copy", [&] {
+        std::vector<movable> v(from_make);
+        bench::do_not_optimize(v.back());
+    }, element_count);
+
+    bench::run("traverse/new", [&] {
+        double sum = 0;
+        for(std::size_t i = 0; i < element_count; ++i) { sum += from_new[i]->area(); }
+        bench::do_not_optimize(sum);
+    }, element_count);
+
+    bench::run("traverse/make_deep_copy", [&] {
+        double sum = 0;
+        for(std::size_t i = 0; i < element_count; ++i) { sum += from_make[i]->area(); }
+        bench::do_not_optimize(sum);
+    }, element_count);
+}
+
+void    run_dereference ()
+{
+    std::vector<hwm::deep_copy_ptr<rectangle> > v;
+    v.reserve(element_count);
+    for(std::size_t i = 0; i < element_count; ++i) {
+        v.push_back(hwm::make_deep_copy<rectangle, rectangle>(static_cast<double>((i * 7919) % 1000), 1.0));
+    }
+    bench::run("dereference/member", [&] {
+        double sum = 0;
+        for(std::size_t i = 0; i < element_count; ++i) { sum += v[i]->w_; }
+        bench::do_not_optimize(sum);
+    }, element_count);
+
+    //the pointer of the same deep_copy_ptr, loaded in the inner loop.
+    hwm::deep_copy_ptr<rectangle> const &one = *bench::opaque(&v[0]);
+    std::size_t const repeat = 64;
+    bench::run("dereference/same_pointer", [&] {
+        double sum = 0;
+        for(std::size_t i = 0; i < element_count / repeat; ++i) {
+            for(std::size_t j = 0; j < repeat; ++j) { sum += one->w_ * static_cast<double>(j); }
+        }
+        bench::do_not_optimize(sum);
+    }, element_count);
+}
+
+//! a configuration tree of `node_count' nodes. deep_copy_ptr clones all of them.
+struct config
+{
+    explicit config (std::size_t node_count)
+    {
+        for(std::size_t i = 0; i < node_count; ++i) { entries.push_back(std::string("key.") + std::to_string(i)); }
+    }
+    std::vector<std::string>    entries;
+};
+
+std::size_t const layer_count = 8;
+
+//! each layer takes the tree by value, reads it and passes it on.
+template<typename P>
+std::size_t pass_down   (P p, std::size_t layer)
+{
+    P const &r = p;
+    std::size_t const n = r->entries[layer].size();
+    return (layer + 1 < layer_count) ? n + pass_down(p, layer + 1) : n;
+}
+
+template<typename P>
+void    run_sharing (std::string const &name, std::size_t node_count)
+{
+    P const tree(new config(node_count));
+    std::size_t const calls = 100;
+    bench::run("pass_by_value/" + std::to_string(node_count) + "/" + name, [&] {
+        std::size_t sum = 0;
+        for(std::size_t i = 0; i < calls; ++i) { sum += pass_down(*bench::opaque(&tree), 0); }
+        bench::do_not_optimize(sum);
+    }, calls * layer_count);
+}
+
+}   //namespace
+
+int main(int argc, char **argv)
+{
+    if(!bench::init(argc, argv)) { return 1; }
+
+    bench::print_header();
+    run_all<copy_only>("copy_only");
+    run_all<movable>("move");
+    run_allocation();
+    run_dereference();
+    run_sharing<hwm::deep_copy_ptr<config> >("clone", 16);
+    run_sharing<hwm::deep_copy_ptr<config, hwm::deep_copy_policy::cow> >("cow", 16);
+    run_sharing<hwm::deep_copy_ptr<config> >("clone", 4096);
+    run_sharing<hwm::deep_copy_ptr<config, hwm::deep_copy_policy::cow> >("cow", 4096);
+    bench::print_footer();
+    return 0;
+}
@@ -0,0 +1,102 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+//! comparing and looking up large trees, which differ only in one leaf near the end,
+//! by the deep comparison, and with the hash cached by deep_copy_ptr.
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include <boost/functional/hash.hpp>
+#include "../../hwm/deep_copy_ptr.hpp"
+#include "./benchmark.hpp"
+
+namespace {
+
+template<bool Cached>
+struct tree;
+
+}   //namespace
+
+namespace hwm {
+template<>
+struct deep_copy_cached_hash< tree<true> > : boost::true_type {};
+}   //namespace hwm
+
+namespace {
+
+std::size_t const tree_count = 128;
+std::size_t const fan_out = 16;
+int const depth = 3;    //1 + 16 + 256 + 4096 nodes.
+
+template<bool Cached>
+struct tree
+{
+    explicit tree   (int v) : value(v) {}
+    bool    operator==  (tree const &rhs) const { return value == rhs.value && children == rhs.children; }
+
+    int                                 value;
+    std::vector<hwm::deep_copy_ptr<tree> > children;
+};
+
+template<bool Cached>
+std::size_t hash_value(tree<Cached> const &t)
+{
+    std::size_t seed = boost::hash<int>()(t.value);
+    boost::hash_combine(seed, boost::hash_range(t.children.begin(), t.children.end()));
+    return seed;
+}
+
+//! the last leaf is `id', and all the other nodes are the same.
+template<bool Cached>
+hwm::deep_copy_ptr<tree<Cached> >   make_tree   (int level, int id, bool last)
+{
+    hwm::deep_copy_ptr<tree<Cached> > t(new tree<Cached>((level == depth && last) ? id : level));
+    if(level < depth) {
+        for(std::size_t i = 0; i < fan_out; ++i) {
+            t->children.push_back(make_tree<Cached>(level + 1, id, last && i + 1 == fan_out));
+        }
+    }
+    return t;
+}
+
+template<bool Cached>
+void    run_all (std::string const &name)
+{
+    typedef hwm::deep_copy_ptr<tree<Cached> > ptr;
+    std::vector<ptr> trees;
+    for(std::size_t i = 0; i < tree_count; ++i) { trees.push_back(make_tree<Cached>(0, static_cast<int>(i), true)); }
+
+    bench::run("compare_all_pairs/" + name, [&] {
+        std::size_t equal = 0;
+        std::vector<ptr> const &t = *bench::opaque(&trees);
+        for(std::size_t i = 0; i < t.size(); ++i) {
+            for(std::size_t j = i + 1; j < t.size(); ++j) { equal += (t[i] == t[j]); }
+        }
+        bench::do_not_optimize(equal);
+    }, tree_count * (tree_count - 1) / 2);
+
+    //the set holds the first half. the lookup is of every tree, and half are found, by the deep comparison.
+    std::unordered_set<ptr> const set(trees.begin(), trees.begin() + tree_count / 2);
+    bench::run("lookup/" + name, [&] {
+        std::size_t found = 0;
+        std::vector<ptr> const &t = *bench::opaque(&trees);
+        for(std::size_t i = 0; i < t.size(); ++i) { found += set.count(t[i]); }
+        bench::do_not_optimize(found);
+    }, tree_count);
+}
+
+}   //namespace
+
+int main(int argc, char **argv)
+{
+    if(!bench::init(argc, argv)) { return 1; }
+
+    bench::print_header();
+    run_all<false>("deep");
+    run_all<true>("cached_hash");
+    bench::print_footer();
+    return 0;
+}
@@ -0,0 +1,124 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+//! cloning snapshots of deep_copy_ptrs on several threads at once,
+//! with the global new, into a pool shared by the threads, into a pool for each thread,
+//! and into a monotonic arena for each snapshot, which is freed at once.
+//! requires C++17 for std::pmr. link boost_thread and boost_system.
+
+#define HWM_DEEP_COPY_PTR_STD_PMR
+
+#include <memory_resource>
+#include <sstream>
+#include <vector>
+#include "../../hwm/deep_copy_ptr.hpp"
+#include "../../hwm/thread_pool.hpp"
+#include "./benchmark.hpp"
+
+namespace {
+
+std::size_t const snapshot_size = 4096;
+std::size_t const snapshots_per_thread = 16;
+
+struct shape
+{
+    virtual ~shape() {}
+    virtual double  area    () const = 0;
+};
+
+struct rectangle
+    :   shape
+{
+    rectangle(double w, double h) : w_(w), h_(h) {}
+    double  area    () const { return w_ * h_; }
+
+    double  w_, h_;
+};
+
+typedef hwm::deep_copy_ptr<shape>   element;
+
+std::string     name_of (char const *resource, std::size_t threads)
+{
+    std::ostringstream ss;
+    ss << "snapshot/" << resource << "/threads=" << threads;
+    return ss.str();
+}
+
+//! clone `src' into `r', and read the clone before it is destroyed.
+double  take_snapshot   (std::vector<element> const &src, hwm::deep_copy_memory_resource *r)
+{
+    std::vector<element> snapshot(src.size());
+    for(std::size_t i = 0; i < src.size(); ++i) { element(src[i], r).swap(snapshot[i]); }
+    return snapshot.back()->area();
+}
+
+//! selects the resource for each snapshot.
+struct global_new
+{
+    double  operator()  (std::vector<element> const &src) const { return take_snapshot(src, 0); }
+};
+
+struct shared_pool
+{
+    explicit shared_pool    (std::pmr::synchronized_pool_resource &pool) : pool_(&pool) {}
+    double  operator()  (std::vector<element> const &src) const { return take_snapshot(src, pool_); }
+    std::pmr::synchronized_pool_resource *pool_;
+};
+
+struct thread_pool_resource
+{
+    double  operator()  (std::vector<element> const &src) const
+    {
+        thread_local std::pmr::unsynchronized_pool_resource pool;
+        return take_snapshot(src, &pool);
+    }
+};
+
+struct monotonic_arena
+{
+    double  operator()  (std::vector<element> const &src) const
+    {
+        std::pmr::monotonic_buffer_resource arena(src.size() * 64);
+        return take_snapshot(src, &arena);
+    }
+};
+
+template<typename Resource>
+void    run_threads (char const *name, std::vector<element> const &src, std::size_t threads, Resource resource)
+{
+    hwm::thread_pool pool(threads);
+    std::size_t const jobs = threads * snapshots_per_thread;
+    std::vector<double> sums(jobs);
+    bench::run(name_of(name, threads), [&] {
+        pool.for_each_index(jobs, [&](std::size_t i) { sums[i] = resource(src); });
+        bench::do_not_optimize(sums[0]);
+    }, jobs * src.size());
+}
+
+}   //namespace
+
+int main(int argc, char **argv)
+{
+    if(!bench::init(argc, argv)) { return 1; }
+
+    std::vector<element> src;
+    for(std::size_t i = 0; i < snapshot_size; ++i) {
+        src.push_back(hwm::make_deep_copy<shape, rectangle>(static_cast<double>((i * 7919) % 1000), 1.0));
+    }
+
+    std::size_t const hardware = hwm::thread_pool::default_thread_count();
+    std::size_t const max_threads = (hardware < 8) ? 8 : hardware;
+
+    bench::print_header();
+    for(std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+        std::pmr::synchronized_pool_resource pool;
+        run_threads("global_new", src, threads, global_new());
+        run_threads("shared_pool", src, threads, shared_pool(pool));
+        run_threads("thread_pool", src, threads, thread_pool_resource());
+        run_threads("monotonic_arena", src, threads, monotonic_arena());
+    }
+    bench::print_footer();
+    return 0;
+}
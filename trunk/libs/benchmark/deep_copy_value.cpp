@@ -0,0 +1,85 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+//! constructing, copying and traversing a vector of small polymorphic values,
+//! held by deep_copy_ptr (one allocation each) and by deep_copy_value (inline).
+
+#include <string>
+#include <vector>
+#include "../../hwm/deep_copy_ptr.hpp"
+#include "../../hwm/deep_copy_value.hpp"
+#include "./benchmark.hpp"
+
+namespace {
+
+std::size_t const element_count = 1000000;
+
+struct shape
+{
+    virtual ~shape() {}
+    virtual double  area    () const = 0;
+};
+
+struct rectangle
+    :   shape
+{
+    rectangle(double w, double h) : w_(w), h_(h) {}
+    double  area    () const { return w_ * h_; }
+
+    double  w_, h_;
+};
+
+double  width_of    (std::size_t i) { return static_cast<double>((i * 7919) % 1000); }
+
+template<typename E>
+E       make_element    (std::size_t i);
+
+template<>
+hwm::deep_copy_ptr<shape>   make_element    (std::size_t i)
+{
+    return hwm::make_deep_copy<shape, rectangle>(width_of(i), 1.0);
+}
+
+template<>
+hwm::deep_copy_value<shape> make_element    (std::size_t i)
+{
+    return hwm::deep_copy_value<shape>(hwm::in_place_type<rectangle>(), width_of(i), 1.0);
+}
+
+template<typename E>
+void    run_all (std::string const &name)
+{
+    std::vector<E> v;
+    bench::run("construct/" + name, [&] {
+        v.clear();
+        v.reserve(element_count);
+        for(std::size_t i = 0; i < element_count; ++i) { v.push_back(make_element<E>(i)); }
+        bench::do_not_optimize(v.back());
+    }, element_count);
+
+    bench::run("copy/" + name, [&] {
+        std::vector<E> copy(v);
+        bench::do_not_optimize(copy.back());
+    }, element_count);
+
+    bench::run("traverse/" + name, [&] {
+        double sum = 0;
+        for(std::size_t i = 0; i < element_count; ++i) { sum += v[i]->area(); }
+        bench::do_not_optimize(sum);
+    }, element_count);
+}
+
+}   //namespace
+
+int main(int argc, char **argv)
+{
+    if(!bench::init(argc, argv)) { return 1; }
+
+    bench::print_header();
+    run_all<hwm::deep_copy_ptr<shape> >("deep_copy_ptr");
+    run_all<hwm::deep_copy_value<shape> >("deep_copy_value");
+    bench::print_footer();
+    return 0;
+}
@@ -0,0 +1,73 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+//! scaling fixed-point samples through double and round_to_nearest_even,
+//! compared with the same operation in hwm::fixed, and the bulk conversions.
+
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include "../../hwm/fixed.hpp"
+#include "./benchmark.hpp"
+
+namespace har = hwm::arithmetic;
+
+namespace {
+
+typedef hwm::fixed<8, 8, boost::int16_t, hwm::fixed_policy::round_to_nearest_even> sample;
+
+std::size_t const element_count = 1 << 14;
+
+}   //namespace
+
+int main(int argc, char **argv)
+{
+    if(!bench::init(argc, argv)) { return 1; }
+
+    boost::random::mt19937 gen(42);
+    boost::random::uniform_int_distribution<boost::int16_t> dist(-8000, 8000);
+    std::vector<sample> in(element_count);
+    for(std::size_t i = 0; i < in.size(); ++i) { in[i] = sample::from_raw(dist(gen)); }
+    std::vector<sample> out(in.size());
+    std::vector<float> floats(in.size());
+
+    sample const gain = bench::opaque(sample(0.75));
+    double const gain_d = bench::opaque(0.75);
+
+    bench::print_header();
+    bench::run("scale/double+round_to_nearest_even", [&] {
+        for(std::size_t i = 0; i < in.size(); ++i) {
+            double const x = in[i].to_double() * gain_d;
+            out[i] = sample::from_raw(static_cast<boost::int16_t>(har::round_to_nearest_even(x * 256.0)));
+        }
+        bench::do_not_optimize(out[0]);
+    }, in.size());
+    bench::run("scale/fixed", [&] {
+        for(std::size_t i = 0; i < in.size(); ++i) { out[i] = in[i] * gain; }
+        bench::do_not_optimize(out[0]);
+    }, in.size());
+
+    bench::run("to_floating/scalar", [&] {
+        for(std::size_t i = 0; i < in.size(); ++i) { floats[i] = in[i].to_float(); }
+        bench::do_not_optimize(floats[0]);
+    }, in.size());
+    bench::run("to_floating/bulk", [&] {
+        hwm::to_floating(&in[0], &in[0] + in.size(), &floats[0]);
+        bench::do_not_optimize(floats[0]);
+    }, in.size());
+
+    bench::run("to_fixed/scalar", [&] {
+        for(std::size_t i = 0; i < in.size(); ++i) { out[i] = sample(floats[i]); }
+        bench::do_not_optimize(out[0]);
+    }, in.size());
+    bench::run("to_fixed/bulk", [&] {
+        hwm::to_fixed(&floats[0], &floats[0] + floats.size(), &out[0]);
+        bench::do_not_optimize(out[0]);
+    }, in.size());
+
+    bench::print_footer();
+    return 0;
+}
@@ -0,0 +1,116 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+//! iterating and copying a million polymorphic values of three types,
+//! held by a vector of deep_copy_ptr (a heap block each, in a shuffled order)
+//! and by poly_collection (contiguous for each type), visited as the base and for each type.
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+#include "../../hwm/deep_copy_ptr.hpp"
+#include "../../hwm/poly_collection.hpp"
+#include "./benchmark.hpp"
+
+namespace {
+
+std::size_t const element_count = 1000000;
+
+struct shape
+{
+    virtual ~shape() {}
+    virtual double  area    () const = 0;
+};
+
+struct square final
+    :   shape
+{
+    explicit square(double s) : s_(s) {}
+    double  area    () const override { return s_ * s_; }
+    double  s_;
+};
+
+struct rectangle final
+    :   shape
+{
+    rectangle(double w, double h) : w_(w), h_(h) {}
+    double  area    () const override { return w_ * h_; }
+    double  w_, h_;
+};
+
+struct circle final
+    :   shape
+{
+    explicit circle(double r) : r_(r) {}
+    double  area    () const override { return 3.14159265358979 * r_ * r_; }
+    double  r_;
+};
+
+double  size_of (std::size_t i) { return static_cast<double>((i * 7919) % 1000); }
+
+}   //namespace
+
+int main(int argc, char **argv)
+{
+    if(!bench::init(argc, argv)) { return 1; }
+
+    std::mt19937 gen(42);
+    std::vector<hwm::deep_copy_ptr<shape> > ptrs;
+    hwm::poly_collection<shape> poly;
+    ptrs.reserve(element_count);
+    for(std::size_t i = 0; i < element_count; ++i) {
+        switch(gen() % 3) {
+        case 0:
+            ptrs.push_back(hwm::make_deep_copy<shape, square>(size_of(i)));
+            poly.insert(square(size_of(i)));
+            break;
+        case 1:
+            ptrs.push_back(hwm::make_deep_copy<shape, rectangle>(size_of(i), 2.0));
+            poly.insert(rectangle(size_of(i), 2.0));
+            break;
+        default:
+            ptrs.push_back(hwm::make_deep_copy<shape, circle>(size_of(i)));
+            poly.insert(circle(size_of(i)));
+            break;
+        }
+    }
+    //as after a long run, the neighbors in the vector are not neighbors in the heap.
+    std::shuffle(ptrs.begin(), ptrs.end(), gen);
+
+    bench::print_header();
+    bench::run("iterate/vector<deep_copy_ptr>", [&] {
+        double sum = 0;
+        for(std::size_t i = 0; i < ptrs.size(); ++i) { sum += ptrs[i]->area(); }
+        bench::do_not_optimize(sum);
+    }, element_count);
+
+    bench::run("iterate/poly_collection/as_base", [&] {
+        double sum = 0;
+        bench::opaque(&poly)->for_each([&](shape const &s) { sum += s.area(); });
+        bench::do_not_optimize(sum);
+    }, element_count);
+
+    bench::run("iterate/poly_collection/per_type", [&] {
+        double sum = 0;
+        hwm::poly_collection<shape> const &p = *bench::opaque(&poly);
+        p.for_each<square>([&](square const &s) { sum += s.area(); });
+        p.for_each<rectangle>([&](rectangle const &s) { sum += s.area(); });
+        p.for_each<circle>([&](circle const &s) { sum += s.area(); });
+        bench::do_not_optimize(sum);
+    }, element_count);
+
+    bench::run("copy/vector<deep_copy_ptr>", [&] {
+        std::vector<hwm::deep_copy_ptr<shape> > copy(ptrs);
+        bench::do_not_optimize(copy.back());
+    }, element_count);
+
+    bench::run("copy/poly_collection", [&] {
+        hwm::poly_collection<shape> copy(poly);
+        bench::do_not_optimize(copy);
+    }, element_count);
+    bench::print_footer();
+    return 0;
+}
@@ -0,0 +1,137 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef HWM_LIBS_DEEP_COPY_FIXTURE_HPP
+#define HWM_LIBS_DEEP_COPY_FIXTURE_HPP
+
+//! the types shared by the tests of deep_copy_ptr and the containers built on it.
+//!     shape, square           polymorphic values, which count the live ones.
+//!     counting_resource       a memory resource which counts its blocks.
+//!     node                    a tree, or a DAG with deep_copy_policy::cow, cloned into a resource.
+
+#include <cstddef>
+#include <vector>
+#include <boost/atomic.hpp>
+#include <boost/config.hpp>
+#include <boost/detail/atomic_count.hpp>
+
+#include "deep_copy_ptr.hpp"
+
+namespace fixture {
+
+//! the number of the shapes alive, to see that every value is destroyed once.
+inline int &    live_count  ()
+{
+    static int n = 0;
+    return n;
+}
+
+struct shape
+{
+    shape() { ++live_count(); }
+    shape(shape const &) throw() { ++live_count(); }
+    virtual ~shape() { --live_count(); }
+    virtual double  area    () const = 0;
+    virtual int     kind    () const = 0;
+    bool    operator==  (shape const &rhs) const { return kind() == rhs.kind() && area() == rhs.area(); }
+};
+
+//! small and nothrow movable.
+struct square
+    :   shape
+{
+    explicit square(double s = 0) : s_(s) {}
+    double  area    () const { return s_ * s_; }
+    int     kind    () const { return 1; }
+    double  s_;
+};
+
+//! counts its live blocks and all of them, and the times two threads were in it at once.
+//! allocates with the global new.
+class counting_resource
+    :   public hwm::deep_copy_memory_resource
+{
+public:
+    counting_resource   () : count_(0), total_(0), in_use_(0), overlaps_(0) {}
+    long    count       () const { return count_; }
+    long    total       () const { return total_; }
+    bool    overlapped  () const { return overlaps_ != 0; }
+
+private:
+    virtual void *  do_allocate     (std::size_t bytes, std::size_t)
+    {
+        enter();
+        ++count_;
+        ++total_;
+        void * const p = ::operator new(bytes);
+        leave();
+        return p;
+    }
+    virtual void    do_deallocate   (void *p, std::size_t, std::size_t)
+    {
+        enter();
+        --count_;
+        ::operator delete(p);
+        leave();
+    }
+    virtual bool    do_is_equal     (hwm::deep_copy_memory_resource const &rhs) const BOOST_NOEXCEPT { return this == &rhs; }
+
+    void    enter   () { if(++in_use_ != 1) { ++overlaps_; } }
+    void    leave   () { --in_use_; }
+
+    boost::detail::atomic_count count_;
+    boost::detail::atomic_count total_;
+    boost::detail::atomic_count in_use_;
+    boost::detail::atomic_count overlaps_;
+};
+
+//! clones the children one by one into the resource.
+//! swapped in, as a copy would go to the global new.
+struct serial_children
+{
+    template<class Node>
+    void    operator()  (Node const &src, Node &dst, hwm::deep_copy_memory_resource *r) const
+    {
+        for(std::size_t i = 0; i < src.children.size(); ++i) {
+            typename Node::ptr(src.children[i], r).swap(dst.children[i]);
+        }
+    }
+};
+
+//! a tree, or a DAG with deep_copy_policy::cow, which counts its copies.
+//! the clone into a resource clones the children by Clone()(src, dst, r), into the null children of dst.
+template<class Clone = serial_children, class Policy = hwm::deep_copy_policy::clone>
+struct node
+{
+    typedef hwm::deep_copy_ptr<node, Policy>    ptr;
+
+    explicit node   (int v) : value(v) {}
+    node            (node const &rhs) : value(rhs.value), children(rhs.children) { ++copies; }
+    node            (node const &rhs, hwm::deep_copy_memory_resource *r)
+        :   value(rhs.value)
+        ,   children(rhs.children.size())
+    {
+        ++copies;
+        Clone()(rhs, *this, r);
+    }
+    bool    operator==  (node const &rhs) const { return value == rhs.value && children == rhs.children; }
+
+    int                 value;
+    std::vector<ptr>    children;
+
+    static boost::atomic<int>   copies;
+};
+
+template<class Clone, class Policy>
+boost::atomic<int> node<Clone, Policy>::copies(0);
+
+}   //namespace fixture
+
+namespace hwm {
+template<class Clone, class Policy>
+struct deep_copy_uses_resource< fixture::node<Clone, Policy> > : boost::true_type {};
+}   //namespace hwm
+
+#endif  //HWM_LIBS_DEEP_COPY_FIXTURE_HPP
@@ -0,0 +1,151 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstddef>
+#include <vector>
+#include <boost/test/minimal.hpp>
+
+#include "deep_copy_graph.hpp"
+#include "deep_copy_fixture.hpp"
+
+namespace {
+
+using fixture::counting_resource;
+
+//! clones the children keeping their sharing, in the current context.
+struct graph_children
+{
+    template<class Node>
+    void    operator()  (Node const &src, Node &dst, hwm::deep_copy_memory_resource *r) const
+    {
+        for(std::size_t i = 0; i < src.children.size(); ++i) {
+            hwm::graph_clone(src.children[i], r).swap(dst.children[i]);
+        }
+    }
+};
+
+//! a node of a DAG, which counts its clones.
+typedef fixture::node<graph_children, hwm::deep_copy_policy::cow> node;
+typedef node::ptr ptr;
+
+//! a chain of diamonds. each node has two edges to the next, which is shared. 2^depth paths, depth + 1 nodes.
+ptr     make_chain  (int depth)
+{
+    ptr p(new node(depth));
+    if(depth > 0) {
+        ptr const next(make_chain(depth - 1));
+        p->children.push_back(next);
+        p->children.push_back(next);
+    }
+    return p;
+}
+
+//! follows the first edges, through the const get which does not unshare.
+ptr const & last_of (ptr const &p)
+{
+    ptr const *q = &p;
+    while(!(*q)->children.empty()) { q = &(*q)->children[0]; }
+    return *q;
+}
+
+}   //namespace
+
+int test_main(int, char **)
+{
+    {
+        ptr const src(make_chain(16));
+
+        // each shared node is cloned once, and shared in the clone as in the source.
+        node::copies = 0;
+        hwm::deep_copy_graph_context ctx;
+        ptr const dst(ctx.clone(src));
+        BOOST_CHECK(node::copies == 17);
+        BOOST_CHECK(ctx.size() == 16);
+        BOOST_CHECK(dst.get() != src.get());
+        ptr const &child = dst->children[0];
+        BOOST_CHECK(child.get() == dst->children[1].get() && child.get() != src->children[0].get());
+        BOOST_CHECK(last_of(dst)->value == 0 && last_of(dst).get() != last_of(src).get());
+        BOOST_CHECK(dst == src);
+
+        // the context holds a reference to each clone until cleared.
+        BOOST_CHECK(child.use_count() == 3);
+        ctx.clear();
+        BOOST_CHECK(child.use_count() == 2 && ctx.size() == 0);
+
+        // the clone is copy-on-write as the source.
+        ptr copy(dst);
+        copy->value = 100;
+        ptr const &ccopy = copy;
+        BOOST_CHECK(dst->value == 16 && ccopy->children[0].get() == dst->children[0].get());
+    }
+
+    {
+        // without a context, every path is cloned.
+        ptr const src(make_chain(4));
+        counting_resource r;
+        node::copies = 0;
+        ptr const dst(src, &r);
+        BOOST_CHECK(node::copies == 31 && r.count() == 31);
+        BOOST_CHECK(dst->children[0].get() != dst->children[1].get());
+        BOOST_CHECK(dst == src);
+    }
+
+    {
+        // the roots which share the nodes are cloned sharing them, into the resource.
+        ptr const shared(make_chain(3));
+        ptr a(new node(10));
+        ptr b(new node(20));
+        a->children.push_back(shared);
+        b->children.push_back(shared);
+
+        counting_resource r;
+        {
+            hwm::deep_copy_graph_context ctx(&r);
+            node::copies = 0;
+            ptr const ca(ctx.clone(static_cast<ptr const &>(a)));
+            ptr const cb(ctx.clone(static_cast<ptr const &>(b)));
+            BOOST_CHECK(node::copies == 6 && r.count() == 6);
+            BOOST_CHECK(ca->children[0].get() == cb->children[0].get());
+            BOOST_CHECK(ca == a && cb == b);
+
+            // a null pointer is cloned as null.
+            BOOST_CHECK(!ctx.clone(ptr()));
+        }
+        BOOST_CHECK(r.count() == 0);
+    }
+
+    {
+        // many shared leaves, past several rehashes of the lookup.
+        ptr root(new node(-1));
+        std::vector<ptr> leaves;
+        for(int i = 0; i < 5000; ++i) { leaves.push_back(ptr(new node(i))); }
+        ptr left(new node(-2));
+        ptr right(new node(-3));
+        left->children = leaves;
+        right->children = leaves;
+        root->children.push_back(left);
+        root->children.push_back(right);
+        leaves.clear();
+        left.reset();
+        right.reset();
+
+        node::copies = 0;
+        hwm::deep_copy_graph_context ctx;
+        ptr const dst(ctx.clone(root));
+        BOOST_CHECK(node::copies == 5003 && ctx.size() == 5000);
+        bool shared = true;
+        for(std::size_t i = 0; i < 5000; ++i) {
+            shared = shared && dst->children[0]->children[i].get() == dst->children[1]->children[i].get();
+        }
+        BOOST_CHECK(shared && dst == root);
+
+        // reserved for a large graph, the result is the same.
+        hwm::deep_copy_graph_context reserved;
+        reserved.reserve(5000);
+        BOOST_CHECK(reserved.clone(root) == dst);
+    }
+
+    return 0;
+}
@@ -0,0 +1,165 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <boost/test/minimal.hpp>
+
+#include "deep_copy_parallel.hpp"
+#include "deep_copy_fixture.hpp"
+
+namespace {
+
+using fixture::counting_resource;
+
+struct item
+{
+    explicit item   (int v) : value(v), text(v % 7, 'x') {}
+    bool    operator==  (item const &rhs) const { return value == rhs.value && text == rhs.text; }
+
+    int         value;
+    std::string text;
+};
+
+//! clones the children in parallel, into the resource of each thread. throws for a negative value.
+struct parallel_children
+{
+    template<class Node>
+    void    operator()  (Node const &src, Node &dst, hwm::deep_copy_memory_resource *r) const
+    {
+        if(src.value < 0) { throw std::runtime_error("node"); }
+        hwm::parallel_clone(src.children.begin(), src.children.end(), dst.children.begin(), r);
+    }
+};
+
+typedef fixture::node<parallel_children> node;
+
+//! throws when the value is cloned.
+struct fragile
+{
+    explicit fragile    (int v) : value(v) {}
+    fragile             (fragile const &rhs) : value(rhs.value) { if(value == 13) { throw std::runtime_error("fragile"); } }
+
+    int value;
+};
+
+//! 1 + 8 + 64 + 512 nodes.
+hwm::deep_copy_ptr<node>    make_tree   (int level, int &next)
+{
+    hwm::deep_copy_ptr<node> t(new node(next++));
+    if(level < 3) {
+        for(int i = 0; i < 8; ++i) { t->children.push_back(make_tree(level + 1, next)); }
+    }
+    return t;
+}
+
+}   //namespace
+
+int test_main(int, char **)
+{
+    hwm::thread_pool pool(4);
+
+    {
+        // a range is cloned element by element, equal to the serial copy.
+        std::vector<hwm::deep_copy_ptr<item> > src;
+        for(int i = 0; i < 1000; ++i) { src.push_back(hwm::deep_copy_ptr<item>(new item(i))); }
+        src[10].reset();
+
+        hwm::deep_copy_parallel_context ctx(pool);
+        std::vector<hwm::deep_copy_ptr<item> > dst(src.size());
+        hwm::parallel_clone(ctx, src.begin(), src.end(), dst.begin());
+        BOOST_CHECK(dst == src);
+        BOOST_CHECK(!dst[10] && dst[11].get() != src[11].get());
+        BOOST_CHECK(hwm::deep_copy_parallel_context::current() == 0);
+
+        // an empty range does nothing.
+        hwm::parallel_clone(ctx, src.begin(), src.begin(), dst.begin());
+    }
+
+    {
+        // a tree is split at each level, into the resource of each thread.
+        int next = 0;
+        hwm::deep_copy_ptr<node> const root(make_tree(0, next));
+
+        counting_resource resources[4];
+        hwm::deep_copy_memory_resource * const ptrs[4] = { &resources[0], &resources[1], &resources[2], &resources[3] };
+        {
+            hwm::deep_copy_parallel_context ctx(pool, ptrs);
+            hwm::deep_copy_ptr<node> snapshot;
+            hwm::parallel_clone(ctx, &root, &root + 1, &snapshot);
+            BOOST_CHECK(snapshot == root);
+            BOOST_CHECK(snapshot.get() != root.get());
+            BOOST_CHECK(resources[0].count() + resources[1].count() + resources[2].count() + resources[3].count() == next);
+            for(int i = 0; i < 4; ++i) { BOOST_CHECK(!resources[i].overlapped()); }
+
+            // without a current context, the children are cloned serially.
+            hwm::deep_copy_ptr<node> serial(root, &resources[0]);
+            BOOST_CHECK(serial == root);
+        }
+        for(int i = 0; i < 4; ++i) { BOOST_CHECK(resources[i].count() == 0); }
+    }
+
+    {
+        // cloned again into the same output, the old elements are not released into
+        // the resources of the other threads while they are cloning.
+        std::vector<hwm::deep_copy_ptr<item> > src;
+        for(int i = 0; i < 20000; ++i) { src.push_back(hwm::deep_copy_ptr<item>(new item(i))); }
+
+        counting_resource resources[4];
+        hwm::deep_copy_memory_resource * const ptrs[4] = { &resources[0], &resources[1], &resources[2], &resources[3] };
+        {
+            hwm::deep_copy_parallel_context ctx(pool, ptrs);
+            std::vector<hwm::deep_copy_ptr<item> > dst(src.size());
+            for(int n = 0; n < 5; ++n) { hwm::parallel_clone(ctx, src.begin(), src.end(), dst.begin()); }
+            BOOST_CHECK(dst == src);
+            BOOST_CHECK(resources[0].count() + resources[1].count() + resources[2].count() + resources[3].count() == 20000);
+            for(int i = 0; i < 4; ++i) { BOOST_CHECK(!resources[i].overlapped()); }
+        }
+        for(int i = 0; i < 4; ++i) { BOOST_CHECK(resources[i].count() == 0); }
+    }
+
+    {
+        // a node which throws in the middle of a tree. the clones of the other threads are destroyed
+        // after they have joined, not while the enclosing nodes unwind.
+        int next = 0;
+        hwm::deep_copy_ptr<node> root(make_tree(0, next));
+        root->children[5]->children[3]->value = -1;
+
+        counting_resource resources[4];
+        hwm::deep_copy_memory_resource * const ptrs[4] = { &resources[0], &resources[1], &resources[2], &resources[3] };
+        {
+            hwm::deep_copy_parallel_context ctx(pool, ptrs);
+            hwm::deep_copy_ptr<node> snapshot;
+            bool thrown = false;
+            try {
+                hwm::parallel_clone(ctx, &root, &root + 1, &snapshot);
+            } catch(std::runtime_error const &) {
+                thrown = true;
+            }
+            BOOST_CHECK(thrown && !snapshot);
+            for(int i = 0; i < 4; ++i) { BOOST_CHECK(!resources[i].overlapped() && resources[i].count() == 0); }
+        }
+    }
+
+    {
+        // the first exception is rethrown, and the context is not left current.
+        std::vector<hwm::deep_copy_ptr<fragile> > src(100);
+        for(int i = 0; i < 100; ++i) { src[i].reset(new fragile(i)); }
+        std::vector<hwm::deep_copy_ptr<fragile> > dst(src.size());
+
+        hwm::deep_copy_parallel_context ctx(pool);
+        bool thrown = false;
+        try {
+            hwm::parallel_clone(ctx, src.begin(), src.end(), dst.begin());
+        } catch(std::runtime_error const &) {
+            thrown = true;
+        }
+        BOOST_CHECK(thrown && !dst[13]);
+        BOOST_CHECK(hwm::deep_copy_parallel_context::current() == 0);
+    }
+
+    return 0;
+}
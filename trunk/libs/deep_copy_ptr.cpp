@@ -5,10 +5,20 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <boost/functional/hash.hpp>
+#if !defined(BOOST_NO_CXX11_HDR_UNORDERED_SET)
+#include <unordered_set>
+#endif
+#include <boost/config.hpp>
+#include <boost/detail/atomic_count.hpp>
+#include <boost/move/utility_core.hpp>
 #include <boost/test/minimal.hpp>
 #include <boost/current_function.hpp>
 
 #include "deep_copy_ptr.hpp"
+#include "thread_pool.hpp"
+#include "deep_copy_fixture.hpp"
 
 struct A
 {
@@ -120,6 +130,74 @@ public:
     int num_;
 };
 
+typedef hwm::deep_copy_ptr<B, hwm::deep_copy_policy::cow> cow_ptr;
+
+//! copies and reads a shared pointee on each thread. none of them may clone.
+struct cow_reader
+{
+    cow_reader  (cow_ptr const &src, std::vector<int> &result) : src_(&src), result_(&result) {}
+    void    operator()  (std::size_t i) const
+    {
+        int ok = 1;
+        for(int n = 0; n < 1000; ++n) {
+            cow_ptr const copy(*src_);
+            ok &= (copy.get() == src_->get() && copy->s == "this is C shared");
+        }
+        (*result_)[i] = ok;
+    }
+    cow_ptr const       *src_;
+    std::vector<int>    *result_;
+};
+
+using fixture::counting_resource;
+
+typedef fixture::node<> node;
+
+//! a document which counts its hashes and comparisons.
+struct document
+{
+    explicit document   (std::string const &t) : text(t) {}
+    bool    operator==  (document const &rhs) const { ++compare_count; return text == rhs.text; }
+
+    std::string                         text;
+    static boost::detail::atomic_count  hash_count;
+    static boost::detail::atomic_count  compare_count;
+};
+
+boost::detail::atomic_count document::hash_count(0);
+boost::detail::atomic_count document::compare_count(0);
+
+std::size_t hash_value(document const &d)
+{
+    ++document::hash_count;
+    return boost::hash<std::string>()(d.text);
+}
+
+namespace hwm {
+template<>
+struct deep_copy_cached_hash<document> : boost::true_type {};
+}   //namespace hwm
+
+typedef hwm::deep_copy_ptr<document, hwm::deep_copy_policy::cow> cow_doc_ptr;
+
+//! hashes and compares the same handles on each thread, which cache the hash at once.
+struct cow_doc_reader
+{
+    cow_doc_reader  (std::vector<cow_doc_ptr> const &src, std::vector<int> &result) : src_(&src), result_(&result) {}
+    void    operator()  (std::size_t i) const
+    {
+        std::vector<cow_doc_ptr> const &src = *src_;
+        int ok = 1;
+        for(std::size_t n = 0; n + 1 < src.size(); ++n) {
+            ok &= (src[n] == src[n + 1]) == (n % 2 == 0);
+            ok &= src[n].hash() == boost::hash<std::string>()(src[n]->text);
+        }
+        (*result_)[i] = ok;
+    }
+    std::vector<cow_doc_ptr> const  *src_;
+    std::vector<int>                *result_;
+};
+
 int test_main(int argc, char **argv)
 {
     {
@@ -179,5 +257,215 @@ int test_main(int argc, char **argv)
         BOOST_CHECK(static_cast<C *>(&*cp6)->num_ == static_cast<C *>(&*cp7)->num_);
     }
 
+    {
+        // movable. the pointee is moved, not cloned.
+        hwm::deep_copy_ptr<B>   cp1(new C("this is C moved as B", 1));
+        B * const               p = cp1.get();
+        hwm::deep_copy_ptr<B>   cp2(boost::move(cp1));
+        BOOST_CHECK(!cp1);
+        BOOST_CHECK(cp2.get() == p);
+
+        hwm::deep_copy_ptr<B>   cp3(new B("this is B"));
+        cp3 = boost::move(cp2);
+        BOOST_CHECK(!cp2);
+        BOOST_CHECK(cp3.get() == p);
+
+        // a null pointer is copied and compared as null.
+        hwm::deep_copy_ptr<B>   cp4(cp1);
+        BOOST_CHECK(!cp4 && cp4 == cp1 && cp4 != cp3);
+
+        cp3.reset();
+        BOOST_CHECK(!cp3);
+        cp3.reset(new C("this is C reset as B", 3));
+        BOOST_CHECK(static_cast<C *>(cp3.get())->num_ == 3);
+#if !defined(BOOST_NO_CXX11_SMART_PTR) && !defined(BOOST_NO_CXX11_RVALUE_REFERENCES)
+        std::unique_ptr<C>      up(new C("this is C from unique_ptr", 4));
+        cp3.reset(std::move(up));
+        BOOST_CHECK(!up && static_cast<C *>(cp3.get())->num_ == 4);
+        hwm::deep_copy_ptr<B>   cp5(std::unique_ptr<C>(new C("", 5)));
+        BOOST_CHECK(static_cast<C *>(cp5.get())->num_ == 5);
+#endif
+    }
+
+    {
+        // constructed in place, with the holder.
+        hwm::deep_copy_ptr<B>   cp1(hwm::in_place_type<C>(), "this is C constructed in place", 1);
+        hwm::deep_copy_ptr<B>   cp2(cp1);
+        BOOST_CHECK(cp1 == cp2 && cp1.get() != cp2.get());
+        BOOST_CHECK(static_cast<C *>(cp2.get())->num_ == 1);
+
+        hwm::deep_copy_ptr<B>   cp3 = hwm::deep_copy_ptr<B>(hwm::in_place_type<B>());
+        BOOST_CHECK(cp3 && cp3->s.empty());
+
+        hwm::deep_copy_ptr<C>   cp4 = hwm::make_deep_copy<C, C>("this is C made", 4);
+        hwm::deep_copy_ptr<B>   cp5 = hwm::make_deep_copy<B, C>("this is C made as B", 5);
+        hwm::deep_copy_ptr<B>   cp6(cp5);
+        BOOST_CHECK(cp4->num_ == 4 && cp4->s == "this is C made");
+        BOOST_CHECK(cp5 == cp6 && static_cast<C *>(cp6.get())->num_ == 5);
+#if !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES) && !defined(BOOST_NO_CXX11_FUNCTION_TEMPLATE_DEFAULT_ARGS)
+        hwm::deep_copy_ptr<C>   cp7 = hwm::make_deep_copy<C>("this is C made", 4);
+        BOOST_CHECK(cp7 == cp4);
+#endif
+    }
+
+    {
+        // copy-on-write. the copies share the pointee until it is written.
+        cow_ptr                 cp1(new C("this is C shared", 1));
+        cow_ptr                 cp2(cp1);
+        cow_ptr const           cp3(cp2);
+        cow_ptr const          &ccp1 = cp1;
+        cow_ptr const          &ccp2 = cp2;
+        BOOST_CHECK(cp1.use_count() == 3 && ccp1.get() == cp3.get());
+
+        // the const access does not clone.
+        BOOST_CHECK(ccp2->s == "this is C shared" && ccp2.get() == cp3.get());
+        BOOST_CHECK(cp1 == cp2 && cp2.use_count() == 3);
+
+        // the first non-const access clones, as the dynamic type.
+        cp2->s = "this is C written";
+        BOOST_CHECK(cp2.use_count() == 1 && cp1.use_count() == 2);
+        BOOST_CHECK(ccp1->s == "this is C shared" && cp3->s == "this is C shared");
+        BOOST_CHECK(static_cast<C const *>(ccp2.get())->num_ == 1);
+
+        // the unshared pointee is written in place.
+        B * const               p = cp2.get();
+        cp2->s = "this is C written again";
+        BOOST_CHECK(cp2.get() == p);
+
+        // assignment shares, and the moves and reset hand over one reference.
+        cow_ptr                 cp4;
+        cp4 = cp3;
+        BOOST_CHECK(cp4.use_count() == 3);
+        cow_ptr                 cp5(boost::move(cp4));
+        BOOST_CHECK(!cp4 && cp5.use_count() == 3);
+        cp5.reset();
+        BOOST_CHECK(cp3.use_count() == 2);
+
+        // converting from the clone policy clones.
+        hwm::deep_copy_ptr<B>   dp(cp3);
+        BOOST_CHECK(*dp == *cp3 && dp.get() != cp3.get() && dp.use_count() == 1);
+    }
+
+    {
+        // concurrent readers share the pointee, and leave the count as it was.
+        cow_ptr const           src(new C("this is C shared", 1));
+        hwm::thread_pool        pool(4);
+        std::vector<int>        result(64);
+        pool.for_each_index(result.size(), cow_reader(src, result));
+        bool ok = true;
+        for(std::size_t i = 0; i < result.size(); ++i) { ok = ok && result[i] == 1; }
+        BOOST_CHECK(ok);
+        BOOST_CHECK(src.use_count() == 1);
+    }
+
+    {
+        // cloned into a memory resource.
+        counting_resource       r;
+        hwm::deep_copy_ptr<B>   cp1(new C("this is C cloned into a resource", 1));
+        {
+            hwm::deep_copy_ptr<B>   cp2(cp1, &r);
+            BOOST_CHECK(r.count() == 1);
+            BOOST_CHECK(cp2 == cp1 && cp2.get() != cp1.get());
+            BOOST_CHECK(static_cast<C *>(cp2.get())->num_ == 1);
+
+            // a plain copy of the clone uses the global new again.
+            hwm::deep_copy_ptr<B>   cp3(cp2);
+            BOOST_CHECK(r.count() == 1 && cp3 == cp2);
+
+            // with deep_copy_policy::cow, the clone is not shared.
+            cow_ptr                 cp4(new C("this is C shared", 4));
+            cow_ptr                 cp5(cp4);
+            cow_ptr                 cp6(cp4, &r);
+            BOOST_CHECK(r.count() == 2 && cp4.use_count() == 2 && cp6.use_count() == 1);
+        }
+        BOOST_CHECK(r.count() == 0);
+
+        // a null pointer allocates nothing.
+        hwm::deep_copy_ptr<B>   cp7;
+        hwm::deep_copy_ptr<B>   cp8(cp7, &r);
+        BOOST_CHECK(!cp8 && r.total() == 2);
+    }
+
+    {
+        // a tree passes the resource down to its children.
+        hwm::deep_copy_ptr<node> root(new node(0));
+        for(int i = 1; i <= 3; ++i) {
+            root->children.push_back(hwm::make_deep_copy<node, node>(i));
+            for(int j = 1; j <= 2; ++j) { root->children.back()->children.push_back(hwm::make_deep_copy<node, node>(i * 10 + j)); }
+        }
+
+        counting_resource       r;
+        {
+            hwm::deep_copy_ptr<node> snapshot(root, &r);
+            BOOST_CHECK(r.count() == 10);
+            BOOST_CHECK(snapshot == root);
+        }
+        BOOST_CHECK(r.count() == 0);
+    }
+
+    {
+        // the cached hash.
+        typedef hwm::deep_copy_ptr<document> doc_ptr;
+        doc_ptr                 d1(new document("this is a document"));
+        doc_ptr                 d2(new document("this is another document"));
+        doc_ptr const           d3(new document("this is a document"));
+        doc_ptr const          &cd1 = d1;
+
+        // the different hashes are unequal without the comparison, and computed once.
+        BOOST_CHECK(d1 != d2 && d1 != d2);
+        BOOST_CHECK(document::compare_count == 0 && document::hash_count == 2);
+        BOOST_CHECK(d1 == d3 && document::compare_count == 1 && document::hash_count == 3);
+        BOOST_CHECK(cd1.hash() == boost::hash<std::string>()("this is a document"));
+        BOOST_CHECK(boost::hash<doc_ptr>()(d3) == d3.hash() && doc_ptr().hash() == 0);
+
+        // the copies take over the hash.
+        doc_ptr                 d4(d1);
+        BOOST_CHECK(d4.hash() == d1.hash() && document::hash_count == 3);
+
+        // the non-const access invalidates the hash.
+        d4->text = "this is a modified document";
+        BOOST_CHECK(d4 != d1 && document::hash_count == 4 && document::compare_count == 1);
+        d4.reset(new document("this is a document"));
+        BOOST_CHECK(d4 == d3 && document::hash_count == 5);
+
+        // the types without deep_copy_cached_hash compute the hash each time.
+        hwm::deep_copy_ptr<std::string> s1(new std::string("this is a string"));
+        BOOST_CHECK(s1.hash() == boost::hash<std::string>()("this is a string"));
+
+#if !defined(BOOST_NO_CXX11_HDR_UNORDERED_SET)
+        std::unordered_set<doc_ptr> set;
+        set.insert(d1);
+        set.insert(d2);
+        set.insert(d3);
+        BOOST_CHECK(set.size() == 2 && set.count(doc_ptr(new document("this is another document"))) == 1);
+#endif
+    }
+
+    {
+        // the handles shared by the threads cache the hash on any of them.
+        std::vector<cow_doc_ptr> src;
+        for(int i = 0; i < 200; ++i) {
+            cow_doc_ptr const d(new document(std::string(i / 2 + 1, 'd')));
+            src.push_back(d);
+        }
+        hwm::thread_pool        pool(4);
+        std::vector<int>        result(16);
+        pool.for_each_index(result.size(), cow_doc_reader(src, result));
+        bool ok = true;
+        for(std::size_t i = 0; i < result.size(); ++i) { ok = ok && result[i] == 1; }
+        BOOST_CHECK(ok);
+    }
+
+#if !defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && !defined(BOOST_NO_CXX11_NOEXCEPT)
+    {
+        // a vector relocates the elements by the moves when it grows.
+        std::vector<hwm::deep_copy_ptr<B> > v;
+        v.push_back(hwm::deep_copy_ptr<B>(new C("", 0)));
+        B * const p = v[0].get();
+        for(int i = 1; i < 100; ++i) { v.push_back(hwm::deep_copy_ptr<B>(new C("", i))); }
+        BOOST_CHECK(v[0].get() == p);
+    }
+#endif
+
     return 0;
 }
@@ -0,0 +1,134 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <string>
+#include <vector>
+#include <boost/config.hpp>
+#include <boost/move/utility_core.hpp>
+#include <boost/test/minimal.hpp>
+
+#include "deep_copy_value.hpp"
+#include "deep_copy_fixture.hpp"
+
+namespace {
+
+using fixture::live_count;
+using fixture::shape;
+
+//! small and nothrow movable. placed inline.
+using fixture::square;
+
+//! larger than the buffer. allocated on the heap.
+struct polygon
+    :   shape
+{
+    explicit polygon(double a = 0) : a_(a) { for(int i = 0; i < 16; ++i) { points_[i] = i; } }
+    double  area    () const { return a_; }
+    int     kind    () const { return 2; }
+    double  a_;
+    double  points_[16];
+};
+
+//! small, but the move constructor may throw. allocated on the heap.
+struct label
+    :   shape
+{
+    explicit label(char const *s = "") : s_(s) {}
+    label(label const &rhs) : shape(rhs), s_(rhs.s_) {}
+    double  area    () const { return static_cast<double>(s_.size()); }
+    int     kind    () const { return 3; }
+    std::string s_;
+};
+
+typedef hwm::deep_copy_value<shape> value;
+
+}   //namespace
+
+int test_main(int, char **)
+{
+    {
+        value v1(square(3));
+        value v2(hwm::in_place_type<polygon>(), 5.0);
+        value v3(hwm::in_place_type<label>(), "label");
+        BOOST_CHECK(v1.is_inline());
+        BOOST_CHECK(!v2.is_inline());
+        BOOST_CHECK(!v3.is_inline());
+        BOOST_CHECK(v1->area() == 9 && v2->area() == 5 && v3->area() == 5);
+
+        // deep copyable, as the dynamic type.
+        value c1(v1), c2(v2), c3(v3);
+        BOOST_CHECK(c1 == v1 && c2 == v2 && c3 == v3);
+        BOOST_CHECK(c1.get() != v1.get() && c2.get() != v2.get());
+        BOOST_CHECK(c1.is_inline() && !c2.is_inline());
+        BOOST_CHECK(dynamic_cast<polygon *>(c2.get()) && dynamic_cast<polygon *>(c2.get())->points_[15] == 15);
+
+        // the inline value points into the handle, and not to the original.
+        static_cast<square *>(c1.get())->s_ = 4;
+        BOOST_CHECK(c1 != v1 && v1->area() == 9 && c1->area() == 16);
+
+        // deep comparable, as T.
+        BOOST_CHECK(v2 != v3);
+        BOOST_CHECK(value() == value() && value() != v1);
+    }
+    BOOST_CHECK(live_count() == 0);
+
+    {
+        // movable. the heap object is moved as the pointer, and the inline object is moved into the new handle.
+        value v1(square(2));
+        value v2(polygon(7));
+        shape * const p2 = v2.get();
+
+        value m1(boost::move(v1));
+        value m2(boost::move(v2));
+        BOOST_CHECK(!v1 && !v2);
+        BOOST_CHECK(m1.is_inline() && m1->area() == 4);
+        BOOST_CHECK(m2.get() == p2);
+
+        v1 = boost::move(m2);
+        BOOST_CHECK(!m2 && v1.get() == p2);
+
+        // swap between the inline and the heap values.
+        swap(v1, m1);
+        BOOST_CHECK(v1.is_inline() && v1->area() == 4);
+        BOOST_CHECK(m1.get() == p2);
+
+        // assignment, including the self assignment.
+        v2 = m1;
+        BOOST_CHECK(v2 == m1 && v2.get() != m1.get());
+        v2 = v2;
+        BOOST_CHECK(v2 == m1);
+        v2 = v1;
+        BOOST_CHECK(v2 == v1 && v2.is_inline());
+
+        v2.reset();
+        BOOST_CHECK(!v2 && !v2.is_inline());
+    }
+    BOOST_CHECK(live_count() == 0);
+
+    {
+        // the size of the buffer is a parameter.
+        hwm::deep_copy_value<shape, 8> small(square(1));
+        hwm::deep_copy_value<shape, 256> large(polygon(1));
+        BOOST_CHECK(!small.is_inline());
+        BOOST_CHECK(large.is_inline());
+        hwm::deep_copy_value<shape, 256> copy(large);
+        BOOST_CHECK(copy == large && copy.is_inline());
+    }
+    BOOST_CHECK(live_count() == 0);
+
+    {
+        std::vector<value> v;
+        for(int i = 0; i < 100; ++i) {
+            if(i % 2)   { v.push_back(value(square(i))); }
+            else        { v.push_back(value(polygon(i))); }
+        }
+        std::vector<value> copy(v);
+        BOOST_CHECK(copy == v);
+        BOOST_CHECK(live_count() == 200);
+    }
+    BOOST_CHECK(live_count() == 0);
+
+    return 0;
+}
@@ -0,0 +1,238 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+#include <boost/test/minimal.hpp>
+#include "../hwm/fixed.hpp"
+
+namespace har = hwm::arithmetic;
+namespace fp = hwm::fixed_policy;
+
+namespace {
+
+typedef hwm::fixed<16, 16>                                                  q16;
+typedef hwm::fixed<16, 16, boost::int32_t, fp::round_to_nearest_even>       q16_even;
+typedef hwm::fixed<8, 8>                                                    q8;
+typedef hwm::fixed<8, 8, boost::int16_t, fp::round_to_nearest_even>         q8_even;
+typedef hwm::fixed<8, 24, boost::int32_t, fp::round_simple>                 q24;
+
+//! the product and the quotient of random raw values, compared with the wide integer arithmetic.
+template<typename Fixed>
+bool    check_arithmetic    (boost::int32_t const limit)
+{
+    typedef typename Fixed::rounding_policy R;
+    typedef typename Fixed::division_policy D;
+    int const shift = Fixed::fractional_bits;
+
+    boost::random::mt19937 gen(42);
+    boost::random::uniform_int_distribution<boost::int32_t> dist(-limit, limit);
+
+    bool ok = true;
+    for(int i = 0; i < 10000; ++i) {
+        boost::int32_t const a = dist(gen);
+        boost::int32_t const b = dist(gen);
+        Fixed const x = Fixed::from_raw(static_cast<typename Fixed::storage_type>(a));
+        Fixed const y = Fixed::from_raw(static_cast<typename Fixed::storage_type>(b));
+
+        ok = ok && (x + y).raw() == a + b;
+        ok = ok && (x - y).raw() == a - b;
+        ok = ok && (-x).raw() == -a;
+        ok = ok && ((x < y) == (a < b)) && ((x == y) == (a == b));
+
+        //the product is exact in double.
+        double const p = std::ldexp(static_cast<double>(a) * b, -shift);
+        ok = ok && (x * y).raw() == static_cast<boost::int64_t>(R::round(p));
+
+        if(b != 0) {
+            boost::int64_t const n = static_cast<boost::int64_t>(a) * (static_cast<boost::int64_t>(1) << shift);
+            boost::int64_t const q = D::divide(n, static_cast<boost::int64_t>(b));
+            //only the representable quotients.
+            if(q == static_cast<typename Fixed::storage_type>(q)) {
+                ok = ok && (x / y).raw() == q;
+            }
+        }
+    }
+    return ok;
+}
+
+//! the rounding policies follow the library's rounding functions.
+template<typename Policy>
+bool    check_rounding_policy   (bool with_negative)
+{
+    bool ok = true;
+    for(int i = -64; i <= 64; ++i) {
+        if(i < 0 && !with_negative) { continue; }
+        double const y = i * 0.125;
+        double const expected =
+            boost::is_same<Policy, fp::round_simple>::value
+            ?   har::round_simple(y)
+            :   har::round_to_nearest_even(y);
+        ok = ok && Policy::round(y) == expected;
+        ok = ok && Policy::template shift_right<3>(i) == static_cast<int>(expected);
+    }
+    return ok;
+}
+
+template<typename Fixed, typename T>
+bool    check_bulk  (std::vector<T> const &x)
+{
+    std::size_t const n = x.size();
+    std::vector<Fixed> f(n);
+    std::vector<T> back(n);
+    bool ok = true;
+
+    Fixed * const end = hwm::to_fixed(&x[0], &x[0] + n, &f[0]);
+    ok = ok && end == &f[0] + n;
+    for(std::size_t i = 0; i < n; ++i) {
+        ok = ok && f[i] == Fixed(x[i]);
+    }
+
+    T * const back_end = hwm::to_floating(&f[0], &f[0] + n, &back[0]);
+    ok = ok && back_end == &back[0] + n;
+    for(std::size_t i = 0; i < n; ++i) {
+        T const expected = boost::is_same<T, float>::value ? f[i].to_float() : static_cast<T>(f[i].to_double());
+        ok = ok && std::memcmp(&back[i], &expected, sizeof(T)) == 0;
+    }
+    return ok;
+}
+
+//! ties and the values around them, and random values in range.
+template<typename Fixed, typename T>
+std::vector<T>  make_bulk_values    ()
+{
+    double const ulp = std::ldexp(1.0, -Fixed::fractional_bits);
+    double const limit = std::ldexp(1.0, Fixed::integer_bits - 2);
+
+    std::vector<T> v;
+    for(int i = -40; i <= 40; ++i) {
+        v.push_back(static_cast<T>(i * ulp * 0.5));
+        v.push_back(static_cast<T>(i * ulp * 0.25));
+        v.push_back(static_cast<T>(i * 0.75));
+    }
+
+    boost::random::mt19937 gen(42);
+    boost::random::uniform_real_distribution<double> dist(-limit, limit);
+    for(int i = 0; i < 1000; ++i) {
+        v.push_back(static_cast<T>(dist(gen)));
+    }
+    return v;
+}
+
+template<typename Fixed>
+void    test_bulk   ()
+{
+    std::vector<float> const f = make_bulk_values<Fixed, float>();
+    std::vector<double> const d = make_bulk_values<Fixed, double>();
+
+    BOOST_CHECK((check_bulk<Fixed>(f)));
+    BOOST_CHECK((check_bulk<Fixed>(d)));
+    for(std::size_t len = 1; len < 20; ++len) {
+        std::vector<float> const part(f.begin(), f.begin() + len);
+        BOOST_CHECK((check_bulk<Fixed>(part)));
+    }
+}
+
+}   //namespace
+
+int test_main(int, char**)
+{
+    //packs densely.
+    BOOST_CHECK(sizeof(q16) == 4);
+    BOOST_CHECK(sizeof(q8) == 2);
+    BOOST_CHECK(sizeof(hwm::fixed<4, 4>) == 1);
+    BOOST_CHECK(sizeof(q16[10]) == 40);
+
+    {
+        BOOST_CHECK(q16(1).raw() == 65536);
+        BOOST_CHECK(q16(-3).raw() == -3 * 65536);
+        BOOST_CHECK(q16(1.5).raw() == 98304);
+        BOOST_CHECK(q16(1.5).to_double() == 1.5);
+        BOOST_CHECK(q16(-0.25f).to_float() == -0.25f);
+        BOOST_CHECK(q16(2) * q16(1.5) == q16(3));
+        BOOST_CHECK(q16(3) / q16(2) == q16(1.5));
+        BOOST_CHECK(q16(1) < q16(1.5));
+        BOOST_CHECK(q16(0.5) + q16(0.25) == q16(0.75));
+    }
+
+    {
+        //half of the last place.
+        double const half_ulp = 1.0 / 512;
+        BOOST_CHECK(q8(half_ulp).raw() == 1);
+        BOOST_CHECK(q8_even(half_ulp).raw() == 0);
+        BOOST_CHECK(q8(3 * half_ulp).raw() == 2);
+        BOOST_CHECK(q8_even(3 * half_ulp).raw() == 2);
+        BOOST_CHECK(q8(-half_ulp).raw() == 0);
+        BOOST_CHECK(q8(-3 * half_ulp).raw() == -1);
+        BOOST_CHECK(q8_even(-3 * half_ulp).raw() == -2);
+        BOOST_CHECK(q8(0.49999999999999994 / 256).raw() == 0);
+
+        //0.5ulp * 1 rounds to 1 ulp or 0.
+        BOOST_CHECK((q8::from_raw(1) * q8(0.5)).raw() == 1);
+        BOOST_CHECK((q8_even::from_raw(1) * q8_even(0.5)).raw() == 0);
+        BOOST_CHECK((q8_even::from_raw(3) * q8_even(0.5)).raw() == 2);
+    }
+
+    {
+        typedef hwm::fixed<16, 16, boost::int32_t, fp::round_simple, fp::truncated>    q_tr;
+        typedef hwm::fixed<16, 16, boost::int32_t, fp::round_simple, fp::floored>      q_fl;
+        typedef hwm::fixed<16, 16, boost::int32_t, fp::round_simple, fp::euclidean>    q_eu;
+
+        BOOST_CHECK(q_tr(-1.5).to_integer() == -1);
+        BOOST_CHECK(q_fl(-1.5).to_integer() == -2);
+        BOOST_CHECK(q_eu(-1.5).to_integer() == -2);
+        BOOST_CHECK(q_fl(1.5).to_integer() == 1);
+
+        //-1 / 3 in the last place.
+        BOOST_CHECK((q_tr::from_raw(-1) / q_tr(3)).raw() == 0);
+        BOOST_CHECK((q_fl::from_raw(-1) / q_fl(3)).raw() == -1);
+        BOOST_CHECK((q_eu::from_raw(-1) / q_eu(-3)).raw() == 1);
+
+        BOOST_CHECK(check_arithmetic<q_tr>(1 << 20));
+        BOOST_CHECK(check_arithmetic<q_fl>(1 << 20));
+        BOOST_CHECK(check_arithmetic<q_eu>(1 << 20));
+        BOOST_CHECK(check_arithmetic<q16_even>(1 << 20));
+        BOOST_CHECK(check_arithmetic<q8>(1 << 10));
+        BOOST_CHECK(check_arithmetic<q8_even>(1 << 10));
+    }
+
+    {
+        //between formats.
+        BOOST_CHECK(q8(q16(1.5)) == q8(1.5));
+        BOOST_CHECK(q16(q8(-1.5)) == q16(-1.5));
+        BOOST_CHECK(q8(q16::from_raw(128)).raw() == 1);
+        BOOST_CHECK(q8_even(q16_even::from_raw(128)).raw() == 0);
+        BOOST_CHECK(q8_even(q16_even::from_raw(384)).raw() == 2);
+    }
+
+    BOOST_CHECK(check_rounding_policy<fp::round_simple>(true));
+    BOOST_CHECK(check_rounding_policy<fp::round_to_nearest_even>(false));
+
+    {
+        typedef hwm::fixed<32, 32, boost::int64_t> q32;
+        BOOST_CHECK(sizeof(q32) == 8);
+        BOOST_CHECK(q32(1.5) * q32(-2) == q32(-3));
+        BOOST_CHECK(q32(1) / q32(4) == q32(0.25));
+    }
+
+    har::simd_level const levels[] = { har::simd_none, har::simd_sse41, har::simd_avx2 };
+    for(std::size_t i = 0; i < sizeof(levels)/sizeof(levels[0]); ++i) {
+        if(levels[i] > har::detected_simd_level()) { break; }
+        har::limit_simd_level(levels[i]);
+        test_bulk<q16>();
+        test_bulk<q16_even>();
+        test_bulk<q8>();
+        test_bulk<q8_even>();
+        test_bulk<q24>();
+    }
+    har::limit_simd_level(har::simd_avx2);
+
+    return 0;
+}
@@ -0,0 +1,120 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <string>
+#include <boost/config.hpp>
+#include <boost/move/utility_core.hpp>
+#include <boost/test/minimal.hpp>
+
+#include "poly_collection.hpp"
+#include "deep_copy_fixture.hpp"
+
+namespace {
+
+using fixture::live_count;
+using fixture::shape;
+using fixture::square;
+
+//! of a different size than square, to check the stride.
+struct label
+    :   shape
+{
+    explicit label(char const *s = "") : s_(s) {}
+    double  area    () const { return static_cast<double>(s_.size()); }
+    int     kind    () const { return 2; }
+    std::string s_;
+};
+
+struct sum_area
+{
+    sum_area    () : sum(0) {}
+    void    operator()  (shape const &s) { sum += s.area(); }
+    double  sum;
+};
+
+struct grow
+{
+    void    operator()  (square &s) const { s.s_ += 1; }
+};
+
+typedef hwm::poly_collection<shape> collection;
+
+}   //namespace
+
+int test_main(int, char **)
+{
+    {
+        collection c;
+        BOOST_CHECK(c.empty() && c.size<square>() == 0);
+        BOOST_CHECK(c.begin<square>() == c.end<square>());
+
+        // the elements are grouped by the type, in the order of insertion.
+        c.insert(square(1));
+        c.insert(label("ab"));
+        c.insert(square(2));
+        c.insert(label("cde"));
+        c.insert(square(3));
+        BOOST_CHECK(c.size() == 5 && c.size<square>() == 3 && c.size<label>() == 2);
+        BOOST_CHECK(c.end<square>() - c.begin<square>() == 3);
+        BOOST_CHECK(c.begin<square>()[1].s_ == 2 && c.begin<label>()[1].s_ == "cde");
+
+        // visited as Base, across the segments of the different strides.
+        BOOST_CHECK(c.for_each(sum_area()).sum == 1 + 4 + 9 + 2 + 3);
+
+        // visited as Y.
+        c.for_each<square>(grow());
+        BOOST_CHECK(c.for_each<square>(sum_area()).sum == 4 + 9 + 16);
+        collection const &cc = c;
+        BOOST_CHECK(cc.for_each<label>(sum_area()).sum == 5);
+
+        // deep copyable, and deep comparable.
+        collection copy(c);
+        BOOST_CHECK(copy == c);
+        BOOST_CHECK(copy.begin<square>() != c.begin<square>());
+        copy.begin<square>()[0].s_ = 10;
+        BOOST_CHECK(copy != c && c.begin<square>()[0].s_ == 2);
+        BOOST_CHECK(live_count() == 10);
+
+        // the order of the types of the insertion does not matter.
+        collection other;
+        other.insert(label("ab"));
+        other.insert(label("cde"));
+        other.insert(square(2));
+        other.insert(square(3));
+        BOOST_CHECK(other != c);
+        other.insert(square(4));
+        BOOST_CHECK(other == c);
+
+        // an empty segment compares as no segment.
+        collection empty;
+        empty.reserve<square>(10);
+        BOOST_CHECK(empty == collection());
+
+        copy = other;
+        BOOST_CHECK(copy == c);
+        swap(copy, empty);
+        BOOST_CHECK(copy.empty() && empty == c);
+
+        c.clear();
+        BOOST_CHECK(c.empty() && c == collection());
+        c.insert(square(5));
+        BOOST_CHECK(c.size() == 1 && c.begin<square>()->s_ == 5);
+    }
+    BOOST_CHECK(live_count() == 0);
+
+#if !defined(BOOST_NO_CXX11_RVALUE_REFERENCES)
+    {
+        // movable. the segments are moved, not copied.
+        collection c;
+        c.insert(square(1));
+        square const *p = c.begin<square>();
+        collection m(boost::move(c));
+        BOOST_CHECK(m.begin<square>() == p && c.empty());
+    }
+    BOOST_CHECK(live_count() == 0);
+#endif
+
+    return 0;
+}
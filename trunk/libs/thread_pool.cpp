@@ -0,0 +1,107 @@
+//          Copyright hotwatermorning 2011.
+//  Distributed under the Boost Software License, Version 1.0.
+//      (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <stdexcept>
+#include <vector>
+#include <boost/test/minimal.hpp>
+#include "../hwm/thread_pool.hpp"
+
+namespace {
+
+struct mark
+{
+    explicit mark   (std::vector<int> &v) : v_(&v) {}
+    void    operator()  (std::size_t i) const { v_->at(i) += 1; }
+    std::vector<int> *v_;
+};
+
+struct throw_at
+{
+    explicit throw_at   (std::size_t n) : n_(n) {}
+    void    operator()  (std::size_t i) const { if(i == n_) { throw std::runtime_error("throw_at"); } }
+    std::size_t n_;
+};
+
+//! a loop inside a loop on the same pool.
+struct nested
+{
+    nested  (hwm::thread_pool &pool, std::vector<int> &v) : pool_(&pool), v_(&v) {}
+    void    operator()  (std::size_t i) const
+    {
+        std::vector<int> inner(16);
+        pool_->for_each_index(inner.size(), mark(inner));
+        int sum = 0;
+        for(std::size_t j = 0; j < inner.size(); ++j) { sum += inner[j]; }
+        (*v_)[i] = sum;
+    }
+    hwm::thread_pool    *pool_;
+    std::vector<int>    *v_;
+};
+
+//! records the index of the thread that runs each index.
+struct record_thread
+{
+    record_thread   (hwm::thread_pool &pool, std::vector<int> &v) : pool_(&pool), v_(&v) {}
+    void    operator()  (std::size_t i) const { (*v_)[i] = static_cast<int>(pool_->thread_index()); }
+    hwm::thread_pool    *pool_;
+    std::vector<int>    *v_;
+};
+
+bool    all_equal   (std::vector<int> const &v, int value)
+{
+    for(std::size_t i = 0; i < v.size(); ++i) {
+        if(v[i] != value) { return false; }
+    }
+    return true;
+}
+
+}   //namespace
+
+int test_main(int, char**)
+{
+    BOOST_CHECK(hwm::thread_pool::default_thread_count() >= 1);
+
+    std::size_t const sizes[] = { 1, 2, 4, 9 };
+    for(std::size_t s = 0; s < sizeof(sizes)/sizeof(sizes[0]); ++s) {
+        hwm::thread_pool pool(sizes[s]);
+        BOOST_CHECK(pool.size() == sizes[s]);
+
+        //each index exactly once.
+        for(std::size_t n = 0; n < 100; n += 7) {
+            std::vector<int> v(n);
+            pool.for_each_index(n, mark(v));
+            BOOST_CHECK(all_equal(v, 1));
+        }
+
+        bool thrown = false;
+        try {
+            pool.for_each_index(100, throw_at(42));
+        } catch(std::exception &) {
+            thrown = true;
+        }
+        BOOST_CHECK(thrown);
+
+        //still usable after an exception.
+        std::vector<int> v(1000);
+        pool.for_each_index(v.size(), mark(v));
+        BOOST_CHECK(all_equal(v, 1));
+
+        std::vector<int> outer(64);
+        pool.for_each_index(outer.size(), nested(pool, outer));
+        BOOST_CHECK(all_equal(outer, 16));
+
+        //the calling thread is 0, and the workers are in [1, size()).
+        BOOST_CHECK(pool.thread_index() == 0);
+        std::vector<int> threads(1000, -1);
+        pool.for_each_index(threads.size(), record_thread(pool, threads));
+        bool in_range = true;
+        for(std::size_t i = 0; i < threads.size(); ++i) {
+            in_range = in_range && threads[i] >= 0 && static_cast<std::size_t>(threads[i]) < pool.size();
+        }
+        BOOST_CHECK(in_range);
+    }
+
+    return 0;
+}